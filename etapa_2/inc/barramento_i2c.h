@@ -0,0 +1,134 @@
+/**
+ * barramento_i2c.h - Escalonador de transações dos barramentos I2C
+ *
+ * Cada controlador (i2c0, i2c1) tem um dono só: a tarefa do barramento. Os
+ * dispositivos se registram com endereço, pinos e classe de prioridade e
+ * recebem uma fila de pedidos própria. A tarefa sempre atende primeiro a
+ * classe mais prioritária (sensores de chão, depois controle, display por
+ * último); dentro da classe, na ordem de registro. Um pedido em andamento
+ * nunca é interrompido, então a espera de um sensor é no máximo o pedido
+ * que já está no barramento.
+ *
+ * Um pedido é atômico: uma lista de segmentos (escritas e leituras com
+ * repeated start entre eles e STOP no fim) ou uma função que roda com o
+ * barramento já selecionado (leituras dependentes, como contador + rajada
+ * de FIFO, ou o DMA do display). Dispositivos em pinos diferentes do mesmo
+ * controlador (OLED e TCS34725 no i2c1 do BitDogLab) são resolvidos aqui: a
+ * tarefa muda a função dos pinos quando o dispositivo da vez muda.
+ *
+ * Conclusão:
+ * - barramento_envia(): não bloqueia; 'concluido' roda na tarefa do
+ *   barramento (tem de ser curto e não pode esperar outro pedido);
+ * - barramento_executa(): bloqueia só a tarefa que chamou, até o fim. Antes
+ *   do escalonador iniciar, roda direto (inicialização dos dispositivos).
+ *   Um pedido síncrono por vez em cada dispositivo (cada um tem um cliente).
+ *
+ * Erro (timeout, NACK com a linha presa): a tarefa solta o barramento com
+ * até 9 pulsos de SCL e um STOP manual, reinicia o controlador e conta a
+ * recuperação; o pedido termina com o erro, o seguinte já pega o barramento
+ * limpo.
+ */
+#ifndef BARRAMENTO_I2C_H
+#define BARRAMENTO_I2C_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "hardware/i2c.h"
+
+#define BARRAMENTO_MAX_DISPOSITIVOS 4      // por barramento
+#define BARRAMENTO_MAX_SEGMENTOS    4
+
+typedef enum {
+    BARRAMENTO_CLASSE_SENSOR   = 0,   // cor no chão: decide o movimento
+    BARRAMENTO_CLASSE_CONTROLE = 1,   // giroscópio
+    BARRAMENTO_CLASSE_DISPLAY  = 2,
+    BARRAMENTO_N_CLASSES
+} BarramentoClasse;
+
+typedef struct BarramentoPedido BarramentoPedido;
+typedef struct BarramentoDispositivo BarramentoDispositivo;
+
+typedef struct {
+    uint8_t *dados;
+    uint16_t n;
+    bool leitura;
+} BarramentoSegmento;
+
+// Roda na tarefa do barramento com os pinos do dispositivo selecionados;
+// devolve >= 0 (ok) ou um PICO_ERROR_*
+typedef int (*BarramentoFuncao)(i2c_inst_t *i2c, uint8_t endereco, BarramentoPedido *p);
+
+struct BarramentoPedido {
+    BarramentoSegmento seg[BARRAMENTO_MAX_SEGMENTOS];
+    uint8_t n_seg;
+    BarramentoFuncao funcao;               // no lugar dos segmentos, se não for NULL
+    void *contexto;
+    void (*concluido)(BarramentoPedido *p);
+    int resultado;                         // bytes transferidos ou PICO_ERROR_*
+
+    // Preenchidos pelo escalonador
+    BarramentoDispositivo *disp;
+    bool sincrono;
+    uint32_t enviado_us;
+};
+
+typedef struct {
+    uint32_t pedidos;
+    uint32_t falhas;
+    uint32_t recusados;                    // fila do dispositivo cheia
+    uint32_t espera_max_us;                // na fila, até o barramento começar
+    uint32_t duracao_max_us;
+    uint64_t ocupado_janela_us;            // zerado a cada relatório
+} BarramentoEstatisticas;
+
+typedef struct {
+    const char *nome;
+    i2c_inst_t *i2c;
+    uint32_t baudrate;
+    TaskHandle_t tarefa;
+    BarramentoDispositivo *disp[BARRAMENTO_MAX_DISPOSITIVOS];   // por classe
+    uint8_t n_disp;
+    BarramentoDispositivo *selecionado;    // dono atual dos pinos
+    uint32_t recuperacoes;
+} Barramento;
+
+struct BarramentoDispositivo {
+    const char *nome;
+    Barramento *barramento;
+    uint8_t endereco;
+    uint8_t sda, scl;
+    BarramentoClasse classe;
+    QueueHandle_t fila;                    // BarramentoPedido*
+    SemaphoreHandle_t pronto;              // fim do pedido síncrono
+    BarramentoEstatisticas estat;
+};
+
+// i2c_init no controlador e cria a tarefa (no topo: só ela espera o I2C)
+bool barramento_init(Barramento *b, i2c_inst_t *i2c, uint32_t baudrate, UBaseType_t prioridade,
+                     const char *nome);
+
+// Registra o dispositivo (antes do escalonador); pull-up nos pinos. Os
+// primeiros pinos registrados no barramento começam selecionados.
+bool barramento_registra(Barramento *b, BarramentoDispositivo *d, const char *nome, uint8_t endereco,
+                         uint8_t sda, uint8_t scl, BarramentoClasse classe, uint8_t profundidade);
+
+// Entra na fila do dispositivo; false se ela estiver cheia (contado)
+bool barramento_envia(BarramentoDispositivo *d, BarramentoPedido *p);
+
+// Envia e espera o fim; devolve p->resultado
+int barramento_executa(BarramentoDispositivo *d, BarramentoPedido *p);
+
+// Atalhos síncronos: escrita simples e escrita do registrador + leitura
+int barramento_escreve(BarramentoDispositivo *d, const uint8_t *dados, uint16_t n);
+int barramento_le_reg(BarramentoDispositivo *d, uint8_t reg, uint8_t *dados, uint16_t n);
+
+// Uma linha "[I2C] ..." por dispositivo: uso do barramento na janela desde o
+// último relatório, pedidos, pior espera na fila e pior duração
+void barramento_relatorio(void);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * ble_robo.h - Servidor GATT do robô (mesmo perfil do etapa_3/bt_gatt_server_2)
+ *
+ *   0xFF11 (leitura)  : cor de maior prioridade vista pelos sensores, nos
+ *                       códigos do etapa_3 (vermelho 0x01, azul 0x03); a
+ *                       fita amarela não tem código lá e sai como 0x00
+ *   0xFF12 (escrita)  : comando remoto; PARE trava os motores, qualquer outro
+ *                       comando devolve o controle ao seguidor
+ *   0xFF13 (escrita)  : quadro de direção do módulo de visão (quadro_direcao.h)
+ *   0xFF14 (leitura)  : tabela de perfil (perfil_serializa(), leitura longa);
+ *          (escrita)  : qualquer valor pede para zerar o perfil (o monitor
+ *                       zera no próximo período, ble_robo_zerar_perfil())
+ *
+ * Com pico_cyw43_arch_sys_freertos os callbacks do BTstack rodam na tarefa do
+ * async_context (prioridade CYW43_TASK_PRIORITY). Os quadros aceitos vão para
+ * uma caixa de um elemento (xQueueOverwrite): quem lê sempre vê o mais novo.
+ */
+#ifndef BLE_ROBO_H
+#define BLE_ROBO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "quadro_direcao.h"
+#include "seguidor.h"
+
+typedef struct {
+    QuadroDirecao quadro;
+    uint32_t recebido_us;
+} QuadroRecebido;
+
+// Inicializa o BTstack; chamar de dentro de uma tarefa, com o CYW43 já
+// iniciado (cyw43_arch_init, compartilhado com o Wi-Fi da telemetria)
+bool ble_robo_init(void);
+
+// PARE remoto ativo?
+bool ble_robo_parado(void);
+
+// Último quadro da visão, se tiver chegado há menos de 'idade_max_us'
+bool ble_robo_quadro_recente(QuadroRecebido *q, uint32_t idade_max_us);
+
+// Atualiza o valor lido na característica 0xFF11 (traduz TipoCor)
+void ble_robo_cor_atual(TipoCor cor);
+
+// Houve escrita na 0xFF14 desde a última chamada (e limpa o pedido)
+bool ble_robo_zerar_perfil(void);
+
+void ble_robo_relatorio(void);
+
+#endif
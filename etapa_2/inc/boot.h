@@ -0,0 +1,52 @@
+/**
+ * boot.h - Marcas de tempo das fases da partida
+ *
+ * Cada fase da partida ganha uma marca (us desde o reset, time_us_32) na
+ * primeira vez que acontece; as seguintes são ignoradas, então a marca pode
+ * ficar dentro do laço de uma tarefa sem custo além de um teste. As fases são
+ * fixas (BOOT_FASES abaixo) e a ordem da lista é a ordem esperada.
+ *
+ * Caminho até andar: main() sobe barramentos, ponte H e giroscópio sem
+ * esperas fixas e cria as tarefas; o rádio (CYW43 + BLE) sobe na tarefa do
+ * monitor enquanto a dos sensores já liga os TCS34725 e lê. Nada espera pelo
+ * terminal: o USB só é atendido quando o host abre a porta, e aí o monitor
+ * repete o que se perdeu (boot_relatorio(), também no comando 'b').
+ */
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+#define BOOT_FASES(X)                                                       \
+    X(MAIN,        "main")         /* entrada de main() (runtime do SDK) */ \
+    X(BARRAMENTOS, "barramentos")  /* I2C e dispositivos registrados */    \
+    X(MOTOR,       "motor")        /* ponte H e rampa prontas */           \
+    X(IMU,         "imu")          /* MPU6050 configurado (ou ausente) */  \
+    X(ESCALONADOR, "escalonador")  /* tarefas criadas, FreeRTOS partindo */\
+    X(REGISTRO,    "registro")     /* margem do gravador de bordo apagada */\
+    X(TCS,         "tcs")          /* TCS34725 ligados (AEN) */            \
+    X(COR,         "1a_cor")       /* primeira leitura válida de cor */    \
+    X(COMANDO,     "1o_comando")   /* primeiro alvo entregue às rodas */   \
+    X(CYW43,       "cyw43")        /* firmware do rádio carregado */       \
+    X(ANUNCIO,     "anuncio")      /* BLE anunciando */                    \
+    X(USB,         "usb")          /* terminal aberto no host */
+
+typedef enum {
+#define BOOT_ENUM(id, nome) BOOT_##id,
+    BOOT_FASES(BOOT_ENUM)
+#undef BOOT_ENUM
+    BOOT_N_FASES
+} BootFase;
+
+// Guarda 'us' na fase se ela ainda não tem marca
+void boot_marca(BootFase fase, uint32_t us);
+
+// Marca da fase; 0 se ainda não aconteceu
+uint32_t boot_us(BootFase fase);
+
+const char *boot_nome(BootFase fase);
+
+// Uma linha "[BOOT] fase t= ms" por fase, na ordem da lista
+void boot_relatorio(void);
+
+#endif
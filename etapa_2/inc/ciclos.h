@@ -0,0 +1,58 @@
+/**
+ * ciclos.h - Contagem de ciclos de CPU com o SysTick
+ *
+ * O Cortex-M0+ do RP2040 não tem o contador DWT->CYCCNT; o SysTick (24 bits,
+ * decrescente, clock do processador) faz esse papel. Se ninguém configurou o
+ * SysTick ainda, ciclos_init() o deixa livre com recarga máxima. Se o
+ * FreeRTOS já o usa para o tick, a recarga dele é respeitada: medidas de até
+ * um período de tick (1 ms = 125000 ciclos a 125 MHz) continuam corretas.
+ *
+ * No host não existe SysTick: os "ciclos" são nanossegundos do relógio
+ * do sistema (timespec_get), só para manter o mesmo código compilando.
+ */
+#ifndef CICLOS_H
+#define CICLOS_H
+
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+
+#include "hardware/structs/systick.h"
+
+static inline void ciclos_init(void) {
+    if (!(systick_hw->csr & 1u)) {
+        systick_hw->rvr = 0x00FFFFFFu;
+        systick_hw->cvr = 0;
+        systick_hw->csr = 0x5u;            // ENABLE | CLKSOURCE = processador
+    }
+}
+
+static inline uint32_t ciclos_le(void) {
+    return systick_hw->cvr;
+}
+
+// O contador é decrescente e dá a volta em (rvr + 1)
+static inline uint32_t ciclos_decorridos(uint32_t inicio, uint32_t fim) {
+    uint32_t modulo = (systick_hw->rvr & 0x00FFFFFFu) + 1u;
+    return inicio >= fim ? inicio - fim : inicio + modulo - fim;
+}
+
+#else
+
+#include <time.h>
+
+static inline void ciclos_init(void) {}
+
+static inline uint32_t ciclos_le(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec);
+}
+
+static inline uint32_t ciclos_decorridos(uint32_t inicio, uint32_t fim) {
+    return fim - inicio;
+}
+
+#endif
+
+#endif
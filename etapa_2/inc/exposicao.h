@@ -0,0 +1,98 @@
+/**
+ * exposicao.h - Exposição automática do TCS34725 (ganho e ATIME por sensor)
+ *
+ * Um controlador por sensor olha o canal C de cada leitura nova e escolhe o
+ * par ganho (1x, 4x, 16x, 60x) x ciclos de integração (2,4 ms cada,
+ * ATIME = 256 - ciclos) da próxima:
+ *  - a folga vem do ganho: abaixo de 64 ciclos o fundo de escala é
+ *    1024 x ciclos, então a fração do fundo que C ocupa só depende do ganho.
+ *    Fica o maior ganho com C previsto até alvo_pct do fundo;
+ *  - com o ganho escolhido, o menor número de ciclos (>= ciclos_min) com C
+ *    previsto >= 2 x c_snr. É a integração mais curta com contagens
+ *    suficientes para a cromaticidade não ser ruído;
+ *  - com C fora de [baixo_pct, alto_pct] do fundo, abaixo de c_snr ou
+ *    saturado, a configuração muda. Dentro da faixa ela só muda para uma
+ *    integração mais curta. Assim não fica oscilando entre duas vizinhas.
+ *    Saturado, C é só um limite inferior: o plano supõe 4x mais luz.
+ *
+ * Depois de uma mudança, a leitura seguinte ainda pode ser da integração que
+ * estava em curso com a configuração antiga e é descartada. Leitura idêntica
+ * à anterior (fora do escuro e da saturação) é a mesma integração lida de
+ * novo e também não conta.
+ *
+ * As leituras saem na escala comum EXPOSICAO_REFERENCIA (4x e 10 ciclos, a
+ * configuração fixa de antes). Assim a calibração, a telemetria, a rede de
+ * direção e o simulador continuam vendo os mesmos números em qualquer luz.
+ * O corte de brilho (SeguidorParams.brilho_min) passa a valer no C cru, que é
+ * o que mede a relação sinal/ruído.
+ */
+#ifndef EXPOSICAO_H
+#define EXPOSICAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EXPOSICAO_CICLO_US    2400
+#define EXPOSICAO_GANHOS      4         // CONTROL.AGAIN 0..3
+#define EXPOSICAO_REFERENCIA  (4 * 10)  // ganho x ciclos da escala comum
+#define EXPOSICAO_SATURA_PCT  95
+
+typedef struct {
+    uint16_t ciclos_min;         // integração mais curta permitida
+    uint16_t ciclos_max;         // teto: cabe no intervalo entre duas leituras do sensor
+    uint16_t c_snr;              // C cru mínimo para confiar na cromaticidade
+    uint8_t alvo_pct;            // C planejado, % do fundo de escala
+    uint8_t baixo_pct;           // abaixo disso (ou de c_snr): reajusta
+    uint8_t alto_pct;            // acima disso: reajusta
+} ExposicaoParams;
+
+#define EXPOSICAO_PARAMS_PADRAO { \
+    .ciclos_min = 2,              \
+    .ciclos_max = 10,             \
+    .c_snr = 256,                 \
+    .alvo_pct = 40,               \
+    .baixo_pct = 5,               \
+    .alto_pct = 80,               \
+}
+
+typedef enum {
+    EXPOSICAO_NOVA = 0,          // leitura nova, normalizada
+    EXPOSICAO_REPETIDA,          // mesma integração da leitura anterior
+    EXPOSICAO_DESCARTADA,        // integração com a configuração antiga
+} ExposicaoLeitura;
+
+typedef struct {
+    uint8_t ganho;               // índice em 1x, 4x, 16x, 60x
+    uint16_t ciclos;             // 1..256
+    bool mudou;                  // configuração nova a escrever no sensor
+    uint8_t descarta;
+    uint16_t anterior[4];        // C, R, G, B crus da última leitura
+
+    uint32_t novas;
+    uint32_t repetidas;
+    uint32_t descartadas;
+    uint32_t saturadas;
+    uint32_t ajustes;
+    uint32_t novas_relatorio;    // 'novas' no relatório anterior (taxa)
+} Exposicao;
+
+// Começa na configuração de referência, limitada a [ciclos_min, ciclos_max]
+void exposicao_inicia(Exposicao *e, const ExposicaoParams *p);
+
+// Registradores do sensor para a configuração atual
+static inline uint8_t exposicao_atime(const Exposicao *e) { return (uint8_t) (256u - e->ciclos); }
+static inline uint8_t exposicao_control(const Exposicao *e) { return e->ganho; }
+
+uint32_t exposicao_ganho(const Exposicao *e);
+uint32_t exposicao_integracao_us(const Exposicao *e);
+
+// Trata uma leitura crua (C, R, G, B, na ordem dos registradores). Nova: crgb
+// sai na escala comum. Se e->mudou, quem chama escreve exposicao_atime() e
+// exposicao_control() no sensor e zera e->mudou.
+ExposicaoLeitura exposicao_processa(Exposicao *e, const ExposicaoParams *p, uint16_t crgb[4]);
+
+// "[EXP] nome ganho ciclos (ms) | leituras novas/s ..." ('intervalo_ms' desde a
+// chamada anterior, para a taxa)
+void exposicao_relatorio(Exposicao *e, const char *nome, uint32_t intervalo_ms);
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ * hcsr04.h - Sensor ultrassônico HC-SR04 (medição por interrupção, FreeRTOS)
+ *
+ * As bordas do pino de eco são capturadas por um handler "raw" de GPIO (não
+ * disputa o callback único do SDK com o driver do CYW43). Na borda de descida
+ * o handler acorda a tarefa que pediu a medição por notificação; enquanto o
+ * eco não volta, a tarefa fica bloqueada e não gasta CPU.
+ */
+#ifndef HCSR04_H
+#define HCSR04_H
+
+#include <stdint.h>
+
+#include "pico/stdlib.h"
+
+// Sem eco dentro do tempo limite (nada à frente ou sensor desconectado)
+#define HCSR04_SEM_ECO 0xFFFF
+
+void hcsr04_init(uint trig_pin, uint echo_pin);
+
+// Dispara e espera o eco por até 'timeout_ms'; devolve a distância em cm
+uint16_t hcsr04_mede_cm(uint32_t timeout_ms);
+
+#endif
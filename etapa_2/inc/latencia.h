@@ -0,0 +1,95 @@
+/**
+ * latencia.h - Latência do sensor ao PWM: marcas por amostra e percentis
+ *
+ * Cada leitura de cor carrega as marcas (em us) de cada etapa do caminho:
+ *
+ *   COR        a cor apareceu sob o sensor (só o simulador sabe)
+ *   I2C        fim da transação RGBC no barramento
+ *   CLASSIFICA cor identificada
+ *   DECISAO    comando publicado (regra ou rede)
+ *   PWM        primeiro tique da rampa com as rodas no sentido desse comando
+ *              (motor_no_sentido; numa inversão a roda passa pelo zero)
+ *
+ * latencia_amostra() transforma as marcas em trechos (I2C -> classificação,
+ * classificação -> decisão, decisão -> PWM, I2C -> PWM e, quando há a marca
+ * COR, COR -> PWM) e soma cada um num histograma log-linear: exato até 8 us,
+ * depois 8 faixas por oitava (erro < 1/8) até ~16 s, em 704 bytes. Os
+ * percentis saem do histograma (limite superior da faixa, nunca acima do
+ * máximo visto), sem guardar as amostras.
+ *
+ * O mesmo código roda no robô (modo de medida, -DLATENCIA=ON no CMake, tabela
+ * "[LAT]" no monitor) e no simulador src/host/latencia_seguidor.c, que
+ * modela o sensor e as tarefas e pode reprovar um limite de p99 no CI.
+ */
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef LATENCIA_ATIVO
+#define LATENCIA_ATIVO 0
+#endif
+
+#define LATENCIA_SUB_FAIXAS 8
+#define LATENCIA_OITAVAS    21          // 8 us .. 2^24 us
+#define LATENCIA_FAIXAS     (LATENCIA_SUB_FAIXAS + LATENCIA_OITAVAS * LATENCIA_SUB_FAIXAS)
+
+typedef enum {
+    LATENCIA_COR = 0,
+    LATENCIA_I2C,
+    LATENCIA_CLASSIFICA,
+    LATENCIA_DECISAO,
+    LATENCIA_PWM,
+    LATENCIA_N_MARCAS
+} LatenciaMarca;
+
+typedef enum {
+    LATENCIA_I2C_CLASSIFICA = 0,
+    LATENCIA_CLASSIFICA_DECISAO,
+    LATENCIA_DECISAO_PWM,
+    LATENCIA_I2C_PWM,
+    LATENCIA_COR_PWM,
+    LATENCIA_N_TRECHOS
+} LatenciaTrecho;
+
+// Marcas em us (time_us_32 no robô, relógio simulado no host); 'tem' diz
+// quais foram preenchidas
+typedef struct {
+    uint32_t us[LATENCIA_N_MARCAS];
+    uint8_t tem;                        // bit por LatenciaMarca
+} LatenciaMarcas;
+
+typedef struct {
+    uint32_t n;
+    uint32_t max;
+    uint64_t soma;
+    uint32_t faixas[LATENCIA_FAIXAS];
+} LatenciaHistograma;
+
+typedef struct {
+    LatenciaHistograma trecho[LATENCIA_N_TRECHOS];
+} Latencia;
+
+static inline void latencia_marca(LatenciaMarcas *m, LatenciaMarca marca, uint32_t us) {
+    m->us[marca] = us;
+    m->tem |= (uint8_t) (1u << marca);
+}
+
+void latencia_zera(Latencia *l);
+
+// Soma um valor num histograma
+void latencia_registra(LatenciaHistograma *h, uint32_t us);
+
+// Soma os trechos cujas duas marcas existem
+void latencia_amostra(Latencia *l, const LatenciaMarcas *m);
+
+// Percentil em milésimos (500 = mediana, 990 = p99); 0 sem amostras
+uint32_t latencia_percentil(const LatenciaHistograma *h, uint32_t milesimos);
+
+const char *latencia_nome(LatenciaTrecho t);
+
+// Uma linha "[LAT] trecho n= med= p50= p90= p99= max=" por trecho com amostras
+void latencia_relatorio(const Latencia *l);
+
+#endif
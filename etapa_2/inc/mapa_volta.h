@@ -0,0 +1,133 @@
+/**
+ * mapa_volta.h - Memória da volta: marcos de cor, mapa de curvas e perfil
+ * de velocidade
+ *
+ * O seguidor só reage à cor sob cada sensor, então freia para as mesmas
+ * curvas nos mesmos lugares a cada volta. Este módulo aprende a pista na
+ * primeira volta e usa o mapa nas seguintes:
+ *
+ *  - avanço: a soma do comando de avanço (média das rodas) no tempo. Com a
+ *    alimentação direta de motor.h, o comando é ~ a velocidade, então o
+ *    avanço mede distância e não muda quando o robô anda mais rápido;
+ *  - marcos: as trocas de cor da fita (azul -> vermelha, ...). A cor nova
+ *    precisa aparecer MAPA_CONFIRMA_COR vezes sem a antiga reaparecer por
+ *    confirma_avanco. São os pontos da pista que se repetem exatamente a
+ *    cada volta;
+ *  - mapa de curvas: a volta é cortada em fatias de MAPA_FATIA de avanço.
+ *    Cada fatia guarda a fração das decisões que foram giro (Q8, 1 byte).
+ *    Decisões curtas de correção numa reta dão fração baixa; uma curva, alta;
+ *  - aprendizado: começa no primeiro marco e fecha a volta quando esse
+ *    mesmo marco volta, com pelo menos outro no meio. Não precisa de marca
+ *    de largada; pista sem troca de cor não fecha, e o robô fica reativo;
+ *  - seguimento: a posição é o avanço desde o último marco, ressincronizada
+ *    em cada marco. Se as fatias de agora até 'antecipa' à frente estão
+ *    todas abaixo de reta_q8, a base sobe para rapido_q8 x base. Com uma
+ *    curva dentro dessa janela ela volta ao normal antes de chegar lá (freio
+ *    antecipado);
+ *  - divergência: marco fora de ordem, longe de onde devia estar (mais que
+ *    tolerancia_pct do trecho), ou o próximo marco que não chega volta na
+ *    hora para o modo reativo (base normal) e reaprende a partir daí.
+ *
+ * Só a base muda. O giro, a trava de prioridade e a decisão continuam os de
+ * seguidor.c. O mapa inteiro tem ~330 bytes de RAM. O mesmo código roda no
+ * robô (tarefa de decisão) e na varredura do host (--voltas N --memoria 1),
+ * que mede o tempo da primeira volta contra o das seguintes.
+ *
+ * EXPERIMENTAL, desligado no robô (MAPA_VOLTA_ATIVO = 0; -DMAPA_VOLTA=ON no
+ * CMake liga). Na varredura com o modelo calibrado (3 voltas, parâmetros
+ * do robô) as voltas seguintes saem só 2,5% mais rápidas que sem o mapa em
+ * 5 pistas sintéticas e 1,3% em 10, e nenhuma outra combinação de
+ * rapido/reta/antecipa testada fez melhor sem perder pista: com o
+ * zigue-zague do seguidor poucas fatias ficam abaixo de reta_q8, e subir
+ * reta_q8 acelera dentro das curvas. Desligado, o mapa continua aprendendo
+ * e o monitor mostra [MAPA], mas a base fica a de seguidor.h.
+ */
+#ifndef MAPA_VOLTA_H
+#define MAPA_VOLTA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ml_direcao.h"
+#include "seguidor.h"
+
+#ifndef MAPA_VOLTA_ATIVO
+#define MAPA_VOLTA_ATIVO 0
+#endif
+
+#define MAPA_MAX_FATIAS    256
+#define MAPA_MAX_MARCOS    16
+#define MAPA_FATIA         256        // avanço por fatia
+#define MAPA_CONFIRMA_COR  3
+#define MAPA_AVANCO_SHIFT  14         // avanço = soma(comando x ms) >> 14
+
+typedef enum {
+    MAPA_APRENDE = 0,            // reativo, gravando
+    MAPA_SEGUE                   // volta fechada, perfil de velocidade ativo
+} MapaModo;
+
+typedef struct {
+    uint8_t de, para;            // TipoCor antes e depois
+    uint16_t posicao;            // avanço desde o marco 0
+} MapaMarco;
+
+typedef struct {
+    uint16_t confirma_avanco;    // sem a cor antiga por isso: troca confirmada
+    uint8_t tolerancia_pct;      // erro de posição aceito num marco, % do trecho
+    uint8_t reta_q8;             // fatia com menos giros que isso é reta (Q8)
+    uint16_t antecipa;           // avanço olhado à frente (freio antes da curva)
+    uint16_t rapido_q8;          // base na reta conhecida (Q8, 294 = 1,15x)
+} MapaVoltaParams;
+
+#define MAPA_VOLTA_PARAMS_PADRAO { \
+    .confirma_avanco = 128,        \
+    .tolerancia_pct = 25,          \
+    .reta_q8 = 26,                 \
+    .antecipa = 512,               \
+    .rapido_q8 = 294,              \
+}
+
+typedef struct {
+    MapaModo modo;
+    bool gravando;               // aprendendo e já passou do primeiro marco
+    MapaMarco marco[MAPA_MAX_MARCOS];
+    uint8_t n_marcos;
+    uint8_t curva[MAPA_MAX_FATIAS];
+    uint16_t n_fatias;
+    uint16_t comprimento;        // avanço da volta (seguindo)
+    uint8_t proximo;             // seguindo: índice do próximo marco
+
+    // Fatia em gravação
+    uint16_t fatia;
+    uint16_t decisoes, giros;
+
+    // Cor da fita e troca em confirmação
+    uint8_t cor;
+    uint8_t cor_nova, n_cor_nova;
+    uint32_t antiga_vista;       // avanço em que a cor atual apareceu por último
+
+    uint32_t avanco;             // soma(comando x ms) >> MAPA_AVANCO_SHIFT
+    uint32_t resto;
+    uint32_t inicio;             // avanço no último marco
+    uint16_t marco_pos;          // posição dele no mapa
+    uint16_t escala_q8;          // avanço medido / avanço do mapa (Q8)
+    uint32_t ultimo_ms;
+    int32_t comando_avanco;      // comando de avanço desde a última decisão
+    bool iniciado;
+
+    uint32_t voltas;             // voltas seguidas pelo mapa
+    uint32_t divergencias;
+} MapaVolta;
+
+void mapa_volta_inicia(MapaVolta *m);
+
+// Uma decisão: atualiza o mapa e devolve a base a usar até a próxima (base
+// ou a base rápida numa reta conhecida). 'cor' é a maior cor vista nos dois
+// sensores agora; 'base' e 'giro' são os comandos de seguidor.h.
+uint16_t mapa_volta_passo(MapaVolta *m, const MapaVoltaParams *p, MlDirecao direcao, TipoCor cor,
+                          uint32_t agora_ms, uint16_t base, uint16_t giro);
+
+// "[MAPA] modo marcos fatias voltas divergências" e, seguindo, os marcos
+void mapa_volta_relatorio(const MapaVolta *m);
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * memoria.h - Arenas estáticas, trava de alocação e relatório de RAM
+ *
+ * - MEMORIA_ARENA(nome) coloca um buffer na seção .uninitialized_data.arena_<nome>:
+ *   fica fora do .bss (não é zerado no boot) e aparece com nome próprio no
+ *   relatório pós-link (src/host/relatorio_memoria.py).
+ * - arena_tflm[] é a arena do interpretador TFLM, com o tamanho calculado no
+ *   build a partir do modelo (arena_tflm.h, gerado por planeja_arena.py).
+ * - memoria_inferencia_inicio()/fim() marcam o caminho de inferência da tarefa
+ *   atual: qualquer malloc/new/pvPortMalloc feito por ela nesse intervalo
+ *   chama panic() com o tamanho pedido, em vez de fragmentar o heap em silêncio.
+ *   No robô elas cercam tarefa_ml (ml_direcao_amostra + ml_direcao_infere).
+ *   No tinyml_gate não há chamada: o src/ml.cpp da lista do CMake, dono da
+ *   inferência com a arena_tflm, não está nesta árvore.
+ * - memoria_relatorio() imprime o pico do heap da newlib, o mínimo livre do
+ *   heap do FreeRTOS e a marca d'água de pilha de cada tarefa, no formato que
+ *   o relatorio_memoria.py junta com a análise do .elf.
+ */
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if PICO_ON_DEVICE
+#define MEMORIA_ARENA(nome) \
+    __attribute__((section(".uninitialized_data.arena_" #nome), aligned(16)))
+#else
+#define MEMORIA_ARENA(nome) __attribute__((aligned(16)))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if __has_include("arena_tflm.h")
+#include "arena_tflm.h"
+extern uint8_t arena_tflm[ARENA_TFLM_BYTES];
+#endif
+
+void memoria_inferencia_inicio(void);
+void memoria_inferencia_fim(void);
+
+// Pico de uso do heap da newlib (malloc/new) desde o boot, em bytes
+size_t memoria_heap_pico(void);
+
+void memoria_relatorio(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * ml_direcao.h - Inferência int8 da direção a partir dos dois TCS34725
+ *
+ * Entrada: leituras RGBC cruas dos sensores esquerdo e direito, com uma
+ * janela de MODELO_DIRECAO_HISTORICO leituras. Saída: RETO/ESQUERDA/DIREITA.
+ * Todo o estado fica numa arena estática (nenhuma alocação em tempo de
+ * execução). No robô as camadas densas usam o CMSIS-NN do edge-impulse-sdk;
+ * no host (e com ML_DIRECAO_REFERENCIA=1) usa a implementação de referência
+ * em C, que tem a mesma aritmética inteira.
+ */
+#ifndef ML_DIRECAO_H
+#define ML_DIRECAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "modelo_direcao.h"
+
+#ifndef ML_DIRECAO_REFERENCIA
+#define ML_DIRECAO_REFERENCIA 0
+#endif
+
+// 1: camadas densas pelo arm_fully_connected_s8 (-DCMSIS_NN=1, como no robô)
+#if defined(CMSIS_NN) && !ML_DIRECAO_REFERENCIA
+#define ML_DIRECAO_CMSIS 1
+#else
+#define ML_DIRECAO_CMSIS 0
+#endif
+
+typedef enum {
+    ML_DIRECAO_RETO     = 0,
+    ML_DIRECAO_ESQUERDA = 1,
+    ML_DIRECAO_DIREITA  = 2
+} MlDirecao;
+
+// Entrada + camada oculta + saída, lado a lado na arena
+#define ML_DIRECAO_ARENA_BYTES \
+    (MODELO_DIRECAO_ENTRADAS + MODELO_DIRECAO_OCULTA + MODELO_DIRECAO_CLASSES)
+
+typedef struct {
+    uint32_t inferencias;
+    uint32_t ciclos_ultimo;
+    uint32_t ciclos_min;
+    uint32_t ciclos_max;
+    uint64_t ciclos_soma;
+} MlDirecaoEstatisticas;
+
+void ml_direcao_init(void);
+
+// Converte uma leitura RGBC em MODELO_DIRECAO_POR_SENSOR características int8
+void ml_direcao_caracteristicas(uint16_t r, uint16_t g, uint16_t b, uint16_t c, int8_t *saida);
+
+// Empurra a leitura atual dos dois sensores na janela de histórico
+void ml_direcao_amostra(const uint16_t esq_rgbc[4], const uint16_t dir_rgbc[4]);
+
+// Janela completa? (as primeiras leituras após o boot não bastam)
+bool ml_direcao_pronto(void);
+
+// Roda a rede sobre a janela atual; 'logits' é opcional
+MlDirecao ml_direcao_infere(int8_t logits[MODELO_DIRECAO_CLASSES]);
+
+// Roda a rede sobre um vetor de entrada já montado (usado no teste bit-exato)
+void ml_direcao_infere_vetor(const int8_t entrada[MODELO_DIRECAO_ENTRADAS],
+                             int8_t logits[MODELO_DIRECAO_CLASSES]);
+
+const MlDirecaoEstatisticas *ml_direcao_estatisticas(void);
+
+#endif
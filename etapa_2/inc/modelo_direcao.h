@@ -0,0 +1,65 @@
+/**
+ * modelo_direcao.h - Classificador de direção int8 (24 -> 16 ReLU -> 3)
+ *
+ * GERADO por src/host/treina_modelo_direcao.py - NÃO EDITAR À MÃO.
+ * Acerto int8 no conjunto sintético: 92.9%
+ *
+ * Pesos por tensor, simétricos (zero point 0), layout [saída][entrada] como
+ * o filtro do arm_fully_connected_s8. Multiplicadores no formato Q31 + shift
+ * (shift > 0 = deslocamento à esquerda).
+ */
+#ifndef MODELO_DIRECAO_H
+#define MODELO_DIRECAO_H
+
+#include <stdint.h>
+
+#define MODELO_DIRECAO_HISTORICO   3
+#define MODELO_DIRECAO_POR_SENSOR  4
+#define MODELO_DIRECAO_ENTRADAS    24
+#define MODELO_DIRECAO_OCULTA      16
+#define MODELO_DIRECAO_CLASSES     3
+
+#define MODELO_DIRECAO_ENTRADA_ZP  0
+#define MODELO_DIRECAO_OCULTA_ZP   (-128)
+#define MODELO_DIRECAO_SAIDA_ZP    (-21)
+
+#define MODELO_DIRECAO_OCULTA_MULT  2072131055
+#define MODELO_DIRECAO_OCULTA_SHIFT (-5)
+#define MODELO_DIRECAO_SAIDA_MULT   1523388197
+#define MODELO_DIRECAO_SAIDA_SHIFT  (-6)
+
+static const int8_t modelo_direcao_w1[MODELO_DIRECAO_OCULTA * MODELO_DIRECAO_ENTRADAS] = {
+    -1, 11, 1, -3, -82, -24, 99, 16, 3, -2, 4, 5, 0, -7, 15, 4, 2, 9, 2, -3, 6, 0, 2, 4,
+    -40, -37, 88, -7, 44, 18, -60, -6, 3, -9, 5, 1, 0, 2, 9, 3, 5, 1, 8, -1, 4, 8, -3, -3,
+    -6, -5, -8, -1, 10, -11, -3, 0, 0, -1, 0, -2, -3, 7, -5, -6, -3, -4, 0, 1, 2, 0, 1, -3,
+    1, 1, 2, 4, 1, 5, 0, 5, -7, 3, -3, -4, 3, -10, -7, -3, 2, -4, -5, -6, -1, -2, -2, -1,
+    -8, -91, 85, -17, -28, 36, 3, 3, -1, 2, 0, -13, -6, 14, -13, -2, 6, -15, 7, 11, -3, 1, 2, 2,
+    -1, -3, 1, 3, 5, 0, -2, 0, -1, -3, -8, 0, 1, -2, 3, -3, 2, -2, -11, -3, -3, -5, -6, -8,
+    -5, -4, 2, -3, -5, -15, 1, 1, 1, -3, -5, -2, 0, -5, -4, -5, 2, 3, 3, 3, -5, 6, 11, -4,
+    -2, 1, -7, 1, -1, 10, 1, -2, -4, 0, 2, 2, -6, 0, -3, -2, -5, -3, -1, -3, -4, -9, 4, -5,
+    -6, 5, 4, -4, -2, 3, -3, 4, 0, 5, -2, 0, -8, -3, 1, -6, 1, -5, -5, -7, -4, -5, 4, 1,
+    0, 52, -77, 19, -30, 15, 2, 63, -8, 14, -3, 3, -12, 5, -10, 2, -5, -8, -12, 6, 1, -9, 1, 17,
+    -2, 5, 5, -1, -83, -34, 103, 5, 3, 0, 0, 1, -3, -2, 13, 4, 2, 0, 2, 1, 4, -3, 1, 1,
+    -71, 29, 54, 1, 71, -39, -50, -2, -2, -2, 0, 2, 2, 1, 5, 1, 0, 4, 3, -1, 5, -2, -2, -1,
+    60, 58, -127, -5, 8, -40, 13, -1, 2, -3, 10, 2, -2, 12, -5, -2, -5, 4, -17, -5, 0, -5, 2, 0,
+    10, -85, 68, -9, -8, 80, -67, 10, 3, -8, 4, 3, -3, 7, 6, 4, 6, -7, 7, 0, -3, 6, -9, -2,
+    -1, -4, -4, 2, 1, -2, 1, 4, -10, -6, -3, 1, -2, -2, -4, -1, 0, 1, 5, 0, 1, -2, 0, 1,
+    -1, -3, -3, -7, -6, -2, 1, 2, -9, 0, 0, 0, 0, -2, 4, -1, -5, 1, -1, -2, 7, 0, -1, -1,
+};
+
+static const int32_t modelo_direcao_b1[MODELO_DIRECAO_OCULTA] = {
+    810, 1358, -149, 0, 1186, -152, -138, -156,
+    -135, -280, -47, -297, 823, -726, -97, 0,
+};
+
+static const int8_t modelo_direcao_w2[MODELO_DIRECAO_CLASSES * MODELO_DIRECAO_OCULTA] = {
+    4, 64, 0, 5, 1, 7, 13, 21, -2, 22, -13, -77, 7, -66, -2, 15,
+    108, -35, 2, 2, 44, 7, -3, 8, -3, -10, -127, 52, 70, 11, -1, 7,
+    -76, -23, -4, -10, -45, 10, -7, 15, 5, -2, 95, 22, -63, 53, -4, 13,
+};
+
+static const int32_t modelo_direcao_b2[MODELO_DIRECAO_CLASSES] = {
+    -1266, -4849, 6637,
+};
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * motor.h - Ponte H (TB6612) das duas rodas com o mapa de pinos fixo
+ *
+ * Os pinos são constantes deste cabeçalho e são conferidos na compilação
+ * (_Static_assert): todos distintos, dentro do banco 0 e com os dois PWM em
+ * canais diferentes. Dos pinos saem as máscaras, a fatia e o canal de cada
+ * PWM, então motor_aplica() vira código em linha reta, sem desvios nem
+ * tabelas:
+ *  - os quatro pinos de sentido mudam numa escrita só do SIO
+ *    (gpio_put_masked = um store no GPIO_OUT_XOR), então a ponte nunca passa
+ *    por estados intermediários (um lado já em ré, o outro ainda em frente,
+ *    freio curto no meio da troca);
+ *  - as duas fatias de PWM têm a mesma configuração e foram habilitadas
+ *    juntas, então os contadores andam em fase. O CC é duplo: o valor novo só
+ *    vale na próxima virada do contador, que é a mesma nas duas fatias.
+ *    Com as rodas em fatias diferentes são duas escritas seguidas; elas são
+ *    feitas com as interrupções desligadas e longe da virada
+ *    (MOTOR_GUARDA_CONTAGENS), para ela não cair entre as duas.
+ *
+ * PWM: MOTOR_PWM_HZ acima do audível, divisor 1 e, com MOTOR_FASE_CORRETA,
+ * contagem sobe-desce (pulsos centrados, o topo é a metade). O topo sai da
+ * frequência na compilação: 20 kHz com fase correta a 125 MHz dá topo 3124,
+ * ~11,6 bits. O sentido troca na hora e a intensidade nova vale na virada
+ * seguinte (no máximo um período, 50 us).
+ *
+ * Comando por roda: -MOTOR_COMANDO_MAX..+MOTOR_COMANDO_MAX (+ = frente,
+ * - = ré, 0 = solta, IN1 = IN2 = 0), proporcional à velocidade pedida. O
+ * motor só vence o atrito acima de MOTOR_ZONA_MORTA_Q16 do ciclo útil; o
+ * mapa de alimentação direta (motor_ciclo_q16) começa dali, então o comando
+ * 1 já anda e a velocidade fica ~linear no comando.
+ *
+ * Rampa: motor_alvo() só muda o alvo. Um timer de hardware a cada
+ * MOTOR_RAMPA_US anda o comando de cada roda até o alvo, no máximo o passo
+ * daquela roda por tique, e escreve a ponte. Inverter o sentido passa pelo
+ * zero na rampa: sem pico de corrente nem roda patinando. motor_para() pula
+ * a rampa (roda solta não puxa corrente). Cada alvo tem um número, e a rampa
+ * anota o primeiro tique com as duas rodas no sentido dele
+ * (motor_no_sentido): é aí que a curva começa de fato, 6 a 7 ms depois do
+ * motor_alvo() numa inversão com os padrões, e é essa a marca PWM de
+ * latencia.h.
+ */
+#ifndef MOTOR_H
+#define MOTOR_H
+
+#include <stdint.h>
+
+// --- MAPA DE PINOS ---
+#define MOTOR_ESQ_FRENTE 4
+#define MOTOR_ESQ_RE     9
+#define MOTOR_ESQ_PWM    8
+#define MOTOR_DIR_FRENTE 18
+#define MOTOR_DIR_RE     19
+#define MOTOR_DIR_PWM    16
+#define MOTOR_STBY       20
+
+// --- PWM ---
+#ifdef SYS_CLK_KHZ
+#define MOTOR_CLK_HZ     (SYS_CLK_KHZ * 1000u)
+#else
+#define MOTOR_CLK_HZ     125000000u
+#endif
+#define MOTOR_PWM_HZ       20000u
+#define MOTOR_FASE_CORRETA 1
+#define MOTOR_PWM_TOPO     (MOTOR_CLK_HZ / (MOTOR_PWM_HZ * (MOTOR_FASE_CORRETA ? 2u : 1u)) - 1u)
+#define MOTOR_GUARDA_CONTAGENS 32       // ciclos de clk_sys (divisor 1)
+
+// --- COMANDO, ALIMENTAÇÃO DIRETA E RAMPA ---
+#define MOTOR_COMANDO_MAX     65535
+#define MOTOR_ZONA_MORTA_Q16  6000      // ciclo útil em que a roda começa a girar
+#define MOTOR_RAMPA_US        1000
+
+typedef struct {
+    uint16_t passo[2];           // comando por tique de rampa: [0] esquerda, [1] direita
+} MotorRampa;
+
+// 2000 por ms: de parado ao máximo em ~33 ms e inversão de giro no lugar em
+// ~11 ms, abaixo da constante de tempo da roda (~60 ms): corta o degrau de
+// corrente sem atrasar a curva (a varredura no host mede o custo: --rampa)
+#define MOTOR_RAMPA_PADRAO { .passo = { 2000, 2000 } }
+
+#define MOTOR_BIT(p)    (1u << (p))
+#define MOTOR_FATIA(p)  (((p) >> 1) & 7u)
+#define MOTOR_CANAL(p)  ((p) & 1u)
+
+#define MOTOR_MASCARA_SENTIDO (MOTOR_BIT(MOTOR_ESQ_FRENTE) | MOTOR_BIT(MOTOR_ESQ_RE) | \
+                               MOTOR_BIT(MOTOR_DIR_FRENTE) | MOTOR_BIT(MOTOR_DIR_RE))
+#define MOTOR_MASCARA_PWM     (MOTOR_BIT(MOTOR_ESQ_PWM) | MOTOR_BIT(MOTOR_DIR_PWM))
+
+// As duas rodas na mesma fatia (canais A e B): um store só no CC
+#define MOTOR_MESMA_FATIA (MOTOR_FATIA(MOTOR_ESQ_PWM) == MOTOR_FATIA(MOTOR_DIR_PWM))
+
+_Static_assert(MOTOR_ESQ_FRENTE < 30 && MOTOR_ESQ_RE < 30 && MOTOR_ESQ_PWM < 30 &&
+               MOTOR_DIR_FRENTE < 30 && MOTOR_DIR_RE < 30 && MOTOR_DIR_PWM < 30 && MOTOR_STBY < 30,
+               "pino do motor fora do banco 0 (GPIO 0..29)");
+// Com algum pino repetido o OU dos bits fica menor que a soma
+_Static_assert((MOTOR_MASCARA_SENTIDO | MOTOR_MASCARA_PWM | MOTOR_BIT(MOTOR_STBY)) ==
+               MOTOR_BIT(MOTOR_ESQ_FRENTE) + MOTOR_BIT(MOTOR_ESQ_RE) + MOTOR_BIT(MOTOR_ESQ_PWM) +
+               MOTOR_BIT(MOTOR_DIR_FRENTE) + MOTOR_BIT(MOTOR_DIR_RE) + MOTOR_BIT(MOTOR_DIR_PWM) +
+               MOTOR_BIT(MOTOR_STBY),
+               "pinos do motor repetidos");
+_Static_assert(!MOTOR_MESMA_FATIA || MOTOR_CANAL(MOTOR_ESQ_PWM) != MOTOR_CANAL(MOTOR_DIR_PWM),
+               "as duas rodas no mesmo canal de PWM");
+// Topo + 1 cabe em 16 bits (o CC vai até ele) e deixa pelo menos 10 bits
+_Static_assert(MOTOR_PWM_TOPO < 65535 && MOTOR_PWM_TOPO >= 1023,
+               "MOTOR_PWM_HZ fora da faixa para o divisor 1");
+_Static_assert(MOTOR_GUARDA_CONTAGENS < MOTOR_PWM_TOPO / 4, "guarda maior que o período");
+_Static_assert(MOTOR_ZONA_MORTA_Q16 < 65536, "zona morta acima do ciclo útil máximo");
+
+// --- PARTE PURA (também compila no host) ---
+
+// Bits de sentido das duas rodas: só deslocamentos do bit de sinal
+static inline uint32_t motor_bits_sentido(int32_t esq, int32_t dir) {
+    uint32_t esq_re = (uint32_t) esq >> 31, esq_frente = (uint32_t) -esq >> 31;
+    uint32_t dir_re = (uint32_t) dir >> 31, dir_frente = (uint32_t) -dir >> 31;
+    return esq_frente << MOTOR_ESQ_FRENTE | esq_re << MOTOR_ESQ_RE |
+           dir_frente << MOTOR_DIR_FRENTE | dir_re << MOTOR_DIR_RE;
+}
+
+// |v| sem desvio (v já limitado a ±MOTOR_COMANDO_MAX por quem chama)
+static inline uint32_t motor_modulo(int32_t v) {
+    int32_t s = v >> 31;
+    return (uint32_t) ((v ^ s) - s);
+}
+
+// Ciclo útil em Q16 (65536 = 100%) para |comando|: 0 solta a roda, o resto
+// começa na zona morta
+static inline uint32_t motor_ciclo_q16(uint32_t m) {
+    uint32_t anda = (uint32_t) -(int32_t) m >> 31;          // 1 se m > 0
+    return anda * MOTOR_ZONA_MORTA_Q16 + ((m * (65536u - MOTOR_ZONA_MORTA_Q16)) >> 16);
+}
+
+// Nível do CC para o ciclo útil (o CC em topo + 1 é 100%)
+static inline uint32_t motor_nivel(uint32_t ciclo_q16) {
+    return (ciclo_q16 * (MOTOR_PWM_TOPO + 1u)) >> 16;
+}
+
+// Um tique da rampa: anda até 'passo' na direção do alvo
+static inline int32_t motor_rampa_passo(int32_t atual, int32_t alvo, int32_t passo) {
+    int32_t d = alvo - atual;
+    if (d > passo) d = passo;
+    if (d < -passo) d = -passo;
+    return atual + d;
+}
+
+// Roda no sentido do alvo (os dois soltos conta)
+static inline bool motor_mesmo_sentido(int32_t atual, int32_t alvo) {
+    return (atual > 0) - (atual < 0) == (alvo > 0) - (alvo < 0);
+}
+
+// --- PONTE H (só no robô) ---
+
+#if PICO_ON_DEVICE
+#include <stdbool.h>
+
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+// Pinos, fatias com a mesma configuração, contadores zerados e as duas
+// fatias habilitadas no mesmo store; ponte ligada (STBY), rodas soltas e o
+// timer da rampa rodando (no núcleo que chamou)
+bool motor_inicia(const MotorRampa *rampa);
+
+// Novo alvo das duas rodas (de qualquer tarefa); a rampa chega lá. Devolve o
+// número do alvo, para motor_no_sentido()
+uint32_t motor_alvo(int32_t esq, int32_t dir);
+
+// true se a rampa já pôs as duas rodas no sentido do alvo 'n' (ou de um mais
+// novo); *us = instante do primeiro tique assim (time_us_32)
+bool motor_no_sentido(uint32_t n, uint32_t *us);
+
+// Solta as duas rodas na hora, sem rampa
+void motor_para(void);
+
+// Escreve a ponte direto com o comando de cada roda (chamado pela rampa)
+static inline void motor_aplica(int32_t esq, int32_t dir) {
+    uint32_t sentido = motor_bits_sentido(esq, dir);
+    uint32_t nivel_esq = motor_nivel(motor_ciclo_q16(motor_modulo(esq))) << (16 * MOTOR_CANAL(MOTOR_ESQ_PWM));
+    uint32_t nivel_dir = motor_nivel(motor_ciclo_q16(motor_modulo(dir))) << (16 * MOTOR_CANAL(MOTOR_DIR_PWM));
+
+    uint32_t estado = save_and_disable_interrupts();
+    gpio_put_masked(MOTOR_MASCARA_SENTIDO, sentido);
+#if MOTOR_MESMA_FATIA
+    pwm_hw->slice[MOTOR_FATIA(MOTOR_ESQ_PWM)].cc = nivel_esq | nivel_dir;
+#else
+    // O outro canal de cada fatia não é PWM de ninguém: o CC vai inteiro.
+    // A virada é no zero com fase correta e no topo sem ela.
+#if MOTOR_FASE_CORRETA
+    while (pwm_hw->slice[MOTOR_FATIA(MOTOR_ESQ_PWM)].ctr < MOTOR_GUARDA_CONTAGENS) {}
+#else
+    while (pwm_hw->slice[MOTOR_FATIA(MOTOR_ESQ_PWM)].ctr > MOTOR_PWM_TOPO - MOTOR_GUARDA_CONTAGENS) {}
+#endif
+    pwm_hw->slice[MOTOR_FATIA(MOTOR_ESQ_PWM)].cc = nivel_esq;
+    pwm_hw->slice[MOTOR_FATIA(MOTOR_DIR_PWM)].cc = nivel_dir;
+#endif
+    restore_interrupts(estado);
+}
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * mpu6050_fifo.h - Giroscópio do MPU6050 lido pela FIFO interna
+ *
+ * O sensor amostra sozinho (MPU6050_TAXA_HZ) e empilha só o eixo Z do
+ * giroscópio na FIFO dele (2 bytes por amostra). A cada período de controle
+ * mpu6050_le_fifo() lê o contador e esvazia a FIFO numa única leitura em
+ * rajada, em vez de ler registrador por registrador a cada amostra. O tempo
+ * de barramento de cada rajada fica nas estatísticas.
+ *
+ * O acesso passa pelo escalonador do barramento (barramento_i2c.h): contador
+ * e rajada vão num pedido só, sem outro dispositivo entre eles.
+ *
+ * O tinyml_gate lista um src/mpu6050.c próprio (sem barramento); este
+ * driver tem outro nome para os dois não se confundirem.
+ */
+#ifndef MPU6050_FIFO_H
+#define MPU6050_FIFO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "barramento_i2c.h"
+
+#define MPU6050_ENDERECO  0x68
+#define MPU6050_TAXA_HZ   200          // 1 kHz (com DLPF) / (1 + SMPLRT_DIV)
+#define MPU6050_LSB_DPS   131          // fundo de escala ±250 °/s
+#define MPU6050_FIFO_MAX  32           // amostras por leitura (64 bytes)
+
+typedef struct {
+    uint32_t leituras;
+    uint32_t amostras;
+    uint32_t transbordos;              // FIFO cheia (1024 bytes): zerada
+    uint32_t falhas;                   // erro de I2C
+    uint32_t barramento_ultimo_us;
+    uint32_t barramento_max_us;
+    uint64_t barramento_soma_us;
+} Mpu6050Estatisticas;
+
+// Confere o WHO_AM_I, acorda, configura taxa/filtro/escala e liga a FIFO
+bool mpu6050_init(BarramentoDispositivo *disp);
+
+// Esvazia a FIFO em 'gz' (até 'max' amostras, em LSB); devolve quantas leu
+// ou -1 em erro de barramento. Bloqueia a tarefa até o pedido terminar.
+int mpu6050_le_fifo(int16_t *gz, int max);
+
+// Descarta o que estiver na FIFO (ex.: depois de um tempo sem ler)
+void mpu6050_zera_fifo(void);
+
+const Mpu6050Estatisticas *mpu6050_estatisticas(void);
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * oled.h - SSD1306 128x64 com quadro na RAM e envio só do que mudou
+ *
+ * O quadro (8 páginas de 128 colunas, 1 byte = 8 pixels na vertical) fica na
+ * RAM. Escrever um byte igual ao que já está lá não custa nada; um byte
+ * diferente marca a coluna como suja na página dele (faixa mínima/máxima por
+ * página). Um quadro inteiro pelo I2C a 400 kHz leva ~25 ms; um status que
+ * muda poucos números manda algumas dezenas de bytes.
+ *
+ * O envio é em blocos de no máximo OLED_BLOCO_COLUNAS colunas de uma página,
+ * cada bloco uma única transação (endereçamento + dados, ~1 ms no barramento)
+ * feita por DMA direto no registrador do I2C: a CPU só monta o bloco, e a
+ * tarefa do barramento dorme até a interrupção de STOP do controlador.
+ *
+ * O display divide o barramento com um TCS34725 (no BitDogLab o OLED fica no
+ * i2c1, pinos 14/15, o mesmo controlador do sensor esquerdo nos pinos 2/3).
+ * Cada bloco é um pedido da classe BARRAMENTO_CLASSE_DISPLAY no escalonador
+ * (barramento_i2c.h), que troca os pinos e põe o sensor na frente. Além
+ * disso, a tarefa do display só envia numa janela aberta por oled_janela(),
+ * que o dono do sensor chama logo depois de cada leitura: os blocos vão no
+ * intervalo até a próxima, e o que não couber espera a janela seguinte. No
+ * pior caso o sensor espera um bloco.
+ */
+#ifndef OLED_H
+#define OLED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OLED_LARGURA        128
+#define OLED_PAGINAS        8          // 64 linhas
+#define OLED_ENDERECO       0x3C
+#define OLED_BLOCO_COLUNAS  32
+#define OLED_COLUNAS_TEXTO  (OLED_LARGURA / 6)   // fonte 5x7 + 1 coluna de espaço
+
+// Prefixo de endereçamento (6 comandos com byte de controle) + 0x40 dos dados
+#define OLED_BLOCO_CABECALHO 13
+#define OLED_BLOCO_PAGINA    9         // byte do cabeçalho com a página do bloco
+#define OLED_BLOCO_MAX       (OLED_BLOCO_CABECALHO + OLED_BLOCO_COLUNAS)
+
+// --- Quadro e regiões sujas (também compilados no host) ---
+
+typedef struct {
+    uint8_t quadro[OLED_PAGINAS][OLED_LARGURA];
+    uint8_t suja_ini[OLED_PAGINAS];    // suja_ini > suja_fim: página limpa
+    uint8_t suja_fim[OLED_PAGINAS];
+} OledQuadro;
+
+// Quadro apagado e todo sujo (o display liga com lixo na RAM dele)
+void oled_quadro_inicia(OledQuadro *q);
+
+// Texto na página 'linha' (0..7) a partir do caractere 'coluna'; minúsculas
+// viram maiúsculas e o que a fonte não tem vira espaço. Só marca o que mudou.
+void oled_quadro_texto(OledQuadro *q, int linha, int coluna, const char *s);
+
+// Como oled_quadro_texto, completando com espaços até 'largura' caracteres
+void oled_quadro_campo(OledQuadro *q, int linha, int coluna, int largura, const char *s);
+
+bool oled_quadro_sujo(const OledQuadro *q);
+
+// Monta em 'bloco' a próxima transação (a primeira faixa suja, até
+// OLED_BLOCO_COLUNAS colunas) e marca essa faixa como limpa. Devolve o total
+// de bytes ou 0 se não há nada sujo.
+int oled_quadro_proximo_bloco(OledQuadro *q, uint8_t bloco[OLED_BLOCO_MAX]);
+
+// --- Display (só no robô) ---
+
+typedef struct {
+    uint32_t atualizacoes;            // janelas em que desenhou ou enviou algo
+    uint32_t ciclos_max;              // CPU por atualização: desenha() + montagem dos blocos
+    uint64_t ciclos_soma;
+    uint32_t blocos;
+    uint32_t bytes;
+    uint32_t bloco_max_us;            // do disparo do DMA ao STOP
+    uint32_t janelas;
+    uint32_t janelas_curtas;          // sobrou região suja para a próxima janela
+    uint32_t falhas;                  // NACK/abort do I2C
+} OledEstatisticas;
+
+#if PICO_ON_DEVICE
+#include "barramento_i2c.h"
+
+typedef struct {
+    BarramentoDispositivo *disp;      // registrado com OLED_ENDERECO e os pinos do display
+    uint16_t periodo_desenho_ms;      // de quanto em quanto desenha() é chamado
+    uint16_t janela_us;               // quanto da janela o display pode usar
+} OledConfig;
+
+// Inicializa o SSD1306 (bloqueante, antes do escalonador) e cria a tarefa do
+// display. desenha() roda na tarefa e é o único que mexe no quadro.
+bool oled_inicia(const OledConfig *cfg, UBaseType_t prioridade, void (*desenha)(OledQuadro *q));
+
+// Chamado pelo dono do sensor, logo depois de soltar a trava: abre a janela
+void oled_janela(void);
+
+const OledEstatisticas *oled_estatisticas(void);
+void oled_relatorio(void);
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * perfil.h - Zonas de tempo nomeadas (min/méd/máx e histograma por zona)
+ *
+ *   PERFIL_INICIO(DECISAO);
+ *   ...
+ *   PERFIL_FIM(DECISAO);
+ *
+ * As zonas são fixas (PERFIL_ZONAS abaixo) e cada uma tem uma linha numa
+ * tabela estática: contagem, mínimo, soma, máximo e um histograma log2 de 16
+ * faixas (a faixa k conta durações em [2^(k+4), 2^(k+5)), a última acumula o
+ * resto). Cada zona escolhe o relógio na lista: CICLOS é o de ciclos.h
+ * (SysTick no robô), US é o timer de 1 us do RP2040 (timer_hw->timerawl). No
+ * host as duas são nanossegundos, então o mesmo código instrumentado dá
+ * perfis comparáveis no simulador.
+ *
+ * Com PERFIL_ATIVO = 0 (padrão; -DPERFIL=ON no CMake do robô, -DPERFIL_ATIVO=1
+ * no host) os macros somem e o custo é zero. Ativo, uma zona custa duas
+ * leituras do relógio e uma atualização da tabela (~40 ciclos).
+ *
+ * No robô:
+ * - cada zona deve ser atualizada por uma tarefa só (a tabela não trava);
+ * - o SysTick do FreeRTOS recarrega a cada tick (1 ms): zona CICLOS tem de
+ *   ser curta e não bloquear. Zona que espera o barramento, uma notificação
+ *   ou passa de um tick usa US (resolução de 1 us, volta em ~71 min);
+ * - perfil_gpio() liga um pino durante uma zona, para o analisador lógico;
+ * - a tabela sai no USB ("[PERF]", comando 'p') e na característica BLE
+ *   0xFF14 (perfil_serializa(), formato abaixo).
+ * No host as atualizações são atômicas (as threads da varredura dividem a
+ * tabela).
+ *
+ * Serialização (little-endian): u8 versão, u8 zonas, u8 unidade (0 = ciclos,
+ * 1 = ns), u8 zonas em us (bit z = zona z medida em microssegundos; só no
+ * robô); por zona: u32 n, u32 min, u32 média, u32 max, 16 x u16 histograma
+ * (satura em 65535).
+ */
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ciclos.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/timer.h"
+#endif
+
+#ifndef PERFIL_ATIVO
+#define PERFIL_ATIVO 0
+#endif
+
+#define PERFIL_FAIXAS 16
+#define PERFIL_VERSAO 2
+
+#define PERFIL_RELOGIO_CICLOS 0
+#define PERFIL_RELOGIO_US     1
+
+#define PERFIL_ZONAS(X)                                                          \
+    X(SENSOR_I2C, "sensor_i2c", US)     /* leitura RGBC (espera o barramento) */ \
+    X(CLASSIFICA, "classifica", CICLOS) /* seguidor_identifica_cor */            \
+    X(DECISAO,    "decisao",    CICLOS) /* seguidor_decide */                    \
+    X(ML,         "ml",         US)     /* amostra + inferência int8 */          \
+    X(MOTOR,      "motor",      US)     /* um período da tarefa do motor */      \
+    X(IMU,        "imu",        US)     /* FIFO do giroscópio + guinada */       \
+    X(BLE_ATT,    "ble_att",    CICLOS) /* escrita ATT (comando, quadro) */      \
+    X(OLED,       "oled",       US)     /* desenho da tela de status */
+
+typedef enum {
+#define PERFIL_ENUM(id, nome, relogio) PERFIL_##id,
+    PERFIL_ZONAS(PERFIL_ENUM)
+#undef PERFIL_ENUM
+    PERFIL_N_ZONAS
+} PerfilZona;
+
+// Um bit por zona no cabeçalho da serialização
+_Static_assert(PERFIL_N_ZONAS <= 8, "mais zonas que bits no byte de zonas em us");
+
+#define PERFIL_SERIAL_BYTES (4 + PERFIL_N_ZONAS * (16 + 2 * PERFIL_FAIXAS))
+
+typedef struct {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t soma;
+    uint32_t faixas[PERFIL_FAIXAS];
+} PerfilEstatistica;
+
+void perfil_registra(PerfilZona zona, uint32_t duracao);
+void perfil_zera(void);
+const PerfilEstatistica *perfil_zona(PerfilZona zona);
+const char *perfil_nome(PerfilZona zona);
+
+// Uma linha "[PERF] ..." por zona com amostras
+void perfil_relatorio(void);
+
+// Tabela inteira no formato do cabeçalho; devolve os bytes escritos
+size_t perfil_serializa(uint8_t *buf, size_t max);
+
+#if PICO_ON_DEVICE
+// Pino que fica em 1 durante a zona (-1 desliga); um pino por zona
+void perfil_gpio(PerfilZona zona, int pino);
+void perfil_gpio_abre(PerfilZona zona);
+void perfil_gpio_fecha(PerfilZona zona);
+#else
+static inline void perfil_gpio_abre(PerfilZona zona) { (void) zona; }
+static inline void perfil_gpio_fecha(PerfilZona zona) { (void) zona; }
+#endif
+
+// Constante nos macros (a zona é literal): o switch some na compilação
+static inline int perfil_em_us(PerfilZona zona) {
+    switch (zona) {
+#define PERFIL_CASO(id, nome, relogio) case PERFIL_##id: return PERFIL_RELOGIO_##relogio;
+        PERFIL_ZONAS(PERFIL_CASO)
+#undef PERFIL_CASO
+        default: return 0;
+    }
+}
+
+#if PICO_ON_DEVICE
+
+static inline uint32_t perfil_abre(PerfilZona zona) {
+    perfil_gpio_abre(zona);
+    return perfil_em_us(zona) ? timer_hw->timerawl : ciclos_le();
+}
+
+static inline void perfil_fecha(PerfilZona zona, uint32_t inicio) {
+    perfil_registra(zona, perfil_em_us(zona) ? timer_hw->timerawl - inicio
+                                             : ciclos_decorridos(inicio, ciclos_le()));
+    perfil_gpio_fecha(zona);
+}
+
+#else
+
+static inline uint32_t perfil_abre(PerfilZona zona) {
+    (void) zona;
+    return ciclos_le();
+}
+
+static inline void perfil_fecha(PerfilZona zona, uint32_t inicio) {
+    perfil_registra(zona, ciclos_decorridos(inicio, ciclos_le()));
+}
+
+#endif
+
+#if PERFIL_ATIVO
+#define PERFIL_INICIO(zona) const uint32_t perfil_inicio_##zona = perfil_abre(PERFIL_##zona)
+#define PERFIL_FIM(zona)    perfil_fecha(PERFIL_##zona, perfil_inicio_##zona)
+#else
+#define PERFIL_INICIO(zona) ((void) 0)
+#define PERFIL_FIM(zona)    ((void) 0)
+#endif
+
+#endif
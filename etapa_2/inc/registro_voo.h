@@ -0,0 +1,117 @@
+/**
+ * registro_voo.h - Gravador de bordo: leituras e decisões num log na flash
+ *
+ * Cada decisão vira um registro com o RGBC cru dos dois sensores, as cores
+ * classificadas, a prioridade ativa, o movimento escolhido e os instantes de
+ * captura e decisão. Os registros são codificados em delta (em relação ao
+ * anterior da mesma página) com varint, ~15-20 bytes cada, em páginas de 256
+ * bytes independentes: uma página corrompida não estraga as outras.
+ *
+ * A região fica no fim da flash, logo abaixo dos 2 setores do BTstack, e é
+ * usada como log circular: a escrita só anda para frente e o setor mais
+ * antigo é apagado quando chega a vez dele, então todos os setores gastam
+ * igual. No boot, o seq das páginas mostra onde o log parou.
+ *
+ * Custo para o controle:
+ * - registro_voo_anota() só codifica na RAM (poucos us, nunca bloqueia); sem
+ *   página livre, o registro é descartado e contado.
+ * - A tarefa do gravador (prioridade baixa) grava uma página por vez com
+ *   flash_safe_execute: ~1 ms com os dois núcleos parados, a cada ~400 ms.
+ * - Apagar um setor para a flash por ~50 ms: a tarefa só apaga quando o
+ *   callback pode_apagar() deixa (robô parado). A margem de setores apagados
+ *   é refeita pela tarefa logo que ela começa (fase "registro" em boot.h),
+ *   não em main(); se ela acabar com o robô andando, as páginas são
+ *   descartadas (contadas) em vez de travar o laço.
+ *
+ * Página (little-endian), decodificada por src/host/registro_voo_decodifica.py:
+ *   u16 magic 0x5652 ("RV")  u8 versão  u8 n registros
+ *   u32 seq (cresce sempre, inclusive entre sessões)
+ *   u16 sessão (uma por boot)  u16 bytes usados (cabeçalho + registros)
+ *   u32 t_base_us (captura do primeiro registro)
+ *   u16 descartados (registros perdidos na sessão até aqui, satura)
+ *   u16 crc16-ccitt (da página inteira até 'usados', com este campo zerado)
+ *   registros...
+ * Registro:
+ *   u8 estado = cor_esq | cor_dir << 2 | prioridade << 4 | movimento << 6
+ *   varint dt_captura_us (do registro anterior; 0 no primeiro)
+ *   varint atraso_us (decisão - captura)
+ *   8 x zigzag varint: delta de r, g, b, c (esq) e r, g, b, c (dir)
+ */
+#ifndef REGISTRO_VOO_H
+#define REGISTRO_VOO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define REGISTRO_VOO_MAGIC     0x5652
+#define REGISTRO_VOO_VERSAO    1
+#define REGISTRO_VOO_PAGINA    256       // = FLASH_PAGE_SIZE
+#define REGISTRO_VOO_CABECALHO 20
+#define REGISTRO_VOO_MAX_BYTES (1 + 5 + 5 + 8 * 3)
+
+#ifndef REGISTRO_VOO_BYTES
+#define REGISTRO_VOO_BYTES (256 * 1024)  // 64 setores, ~7 min de decisões
+#endif
+
+typedef struct {
+    uint16_t esq[4];          // r, g, b, c crus
+    uint16_t dir[4];
+    uint8_t cor_esq;          // TipoCor
+    uint8_t cor_dir;
+    uint8_t prioridade;       // prioridade_ativa
+    uint8_t movimento;        // MlDirecao
+    uint32_t captura_us;
+    uint32_t decisao_us;
+} RegistroVoo;
+
+// --- Codificação da página (também compilada no host) ---
+
+typedef struct {
+    uint8_t dados[REGISTRO_VOO_PAGINA];
+    uint16_t usados;
+    uint8_t n;
+    RegistroVoo anterior;
+} RegistroVooPagina;
+
+void registro_voo_pagina_inicia(RegistroVooPagina *p, uint16_t sessao);
+
+// Devolve false se o registro não cabe mais (a página deve ser fechada)
+bool registro_voo_pagina_anota(RegistroVooPagina *p, const RegistroVoo *r);
+
+// Preenche n, seq, descartados e o CRC; o resto da página fica em 0xFF
+void registro_voo_pagina_fecha(RegistroVooPagina *p, uint32_t seq, uint32_t descartados);
+
+// Confere magic, versão, tamanho e CRC de uma página lida da flash
+bool registro_voo_pagina_valida(const uint8_t *pagina);
+
+// --- Gravador (só no robô) ---
+
+typedef struct {
+    uint32_t registros;
+    uint32_t registros_descartados;   // sem página livre na RAM
+    uint32_t registros_sem_setor;     // página pronta sem setor apagado
+    uint32_t paginas_gravadas;
+    uint32_t setores_apagados;
+    uint32_t gravacao_max_us;
+    uint32_t apagamento_max_us;
+} RegistroVooEstatisticas;
+
+#if PICO_ON_DEVICE
+#include "FreeRTOS.h"
+
+// Acha o fim do log, abre uma nova sessão e cria a tarefa do gravador (que
+// refaz a margem de setores apagados). Chamar antes do escalonador.
+bool registro_voo_init(UBaseType_t prioridade, bool (*pode_apagar)(void));
+
+// Só uma tarefa pode anotar (a decisão); nunca bloqueia
+void registro_voo_anota(const RegistroVoo *r);
+
+// Imprime as páginas válidas, da mais antiga à mais nova, uma por linha:
+// "REG <512 hex>", entre "REG INICIO ..." e "REG FIM"
+void registro_voo_despeja(void);
+
+const RegistroVooEstatisticas *registro_voo_estatisticas(void);
+void registro_voo_relatorio(void);
+#endif
+
+#endif
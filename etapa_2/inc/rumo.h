@@ -0,0 +1,85 @@
+/**
+ * rumo.h - Estimativa de guinada (yaw) e manutenção de rumo em ponto fixo
+ *
+ * Integra as amostras do giroscópio Z (MPU6050, RUMO_LSB_DPS a
+ * RUMO_TAXA_HZ) num acumulador int64 em Q8; nada de float no caminho do
+ * motor. O MPU6050 não tem magnetômetro, então não existe referência
+ * absoluta de guinada: o filtro complementar fica no viés. A parte de baixa
+ * frequência (o viés do giro) é reestimada por um passa-baixas sempre que o
+ * robô está parado e quase sem rotação; a de alta frequência é a integral
+ * do giro sem o viés. A guinada é relativa e deriva devagar, o que basta
+ * para segurar o rumo por alguns segundos.
+ *
+ * rumo_controla() transforma a direção pedida em comando com sinal por roda
+ * (motor.h):
+ *  - RETO: guarda o rumo ao entrar e corrige com PD (erro de rumo e taxa de
+ *    giro) para andar reto entre trechos de fita;
+ *  - giros: reduz as duas rodas quando a taxa passa de giro_max, e a
+ *    referência capturada no fim do giro segura o excesso de rotação.
+ */
+#ifndef RUMO_H
+#define RUMO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ml_direcao.h"
+
+#define RUMO_TAXA_HZ          200          // = MPU6050_TAXA_HZ (conferido no robô)
+#define RUMO_LSB_DPS          131          // = MPU6050_LSB_DPS
+#define RUMO_CALIBRA_AMOSTRAS 200          // 1 s parado
+
+typedef struct {
+    int8_t sinal;                // +1 ou -1: montagem da placa (guinada + = para a esquerda)
+    int16_t kp_q8;               // PWM por centésimo de grau de erro, Q8
+    int16_t kd_q8;               // PWM por centésimo de grau/s, Q8
+    uint16_t correcao_max;       // limite da correção somada/subtraída em RETO
+    int32_t giro_max_cdps;       // acima disso o giro é freado (centésimos de °/s)
+    int32_t taxa_parado_cdps;    // abaixo disso, parado, a amostra entra no viés
+} RumoParams;
+
+#define RUMO_PARAMS_PADRAO {     \
+    .sinal = 1,                  \
+    .kp_q8 = 1024,               \
+    .kd_q8 = 102,                \
+    .correcao_max = 8000,        \
+    .giro_max_cdps = 18000,      \
+    .taxa_parado_cdps = 300,     \
+}
+
+typedef struct {
+    int64_t acumulado;           // soma de (giro - viés), LSB em Q8 por amostra
+    int32_t vies_q8;             // LSB em Q8
+    int32_t taxa_cdps;           // média do último lote
+    int32_t referencia_cdeg;
+    bool referencia_valida;
+    bool calibrado;
+    uint16_t n_calibra;
+    int32_t soma_calibra;
+} Rumo;
+
+void rumo_init(Rumo *r);
+
+// Consome um lote da FIFO. 'parado': motores desligados (calibra/reajusta o viés)
+void rumo_amostras(const RumoParams *p, Rumo *r, const int16_t *gz, int n, bool parado);
+
+// Guinada relativa em centésimos de grau, em (-18000, 18000]
+int32_t rumo_guinada_cdeg(const Rumo *r);
+
+// Comando sem giroscópio, PWM com sinal (+ = para frente):
+//  - RETO:     esquerda +base, direita +base;
+//  - DIREITA:  esquerda +base, direita -spin (de fora a base, ré na de dentro);
+//  - ESQUERDA: esquerda -base, direita +spin (ré na de dentro com a base, a
+//    de fora com spin).
+// Os giros não são espelhados: a roda esquerda sempre leva a base, como no
+// spin_left() original. Com base > spin o giro à esquerda anda um pouco para
+// trás e o à direita um pouco para frente.
+void rumo_malha_aberta(MlDirecao direcao, int32_t base, int32_t spin,
+                       int32_t *pwm_esq, int32_t *pwm_dir);
+
+// Como rumo_malha_aberta, corrigido pela guinada. Sem calibração devolve o
+// comando de malha aberta.
+void rumo_controla(const RumoParams *p, Rumo *r, MlDirecao direcao,
+                   int32_t base, int32_t spin, int32_t *pwm_esq, int32_t *pwm_dir);
+
+#endif
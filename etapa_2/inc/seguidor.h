@@ -0,0 +1,73 @@
+/**
+ * seguidor.h - Classificação de cor e regra de decisão do seguidor
+ *
+ * A lógica que antes vivia solta em carrinho_seguidor_cor.c (identificar_cor,
+ * trava de prioridade, escolha do movimento), sem hardware nem FreeRTOS: o
+ * robô e o simulador de varredura (src/host/varredura_seguidor.c) compilam
+ * exatamente este código. Tudo que era #define ou literal ajustado no chão
+ * virou campo de SeguidorParams; SEGUIDOR_PARAMS_PADRAO são os valores de
+ * hoje no robô.
+ */
+#ifndef SEGUIDOR_H
+#define SEGUIDOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ml_direcao.h"
+
+typedef enum {
+    COR_NENHUMA = 0,
+    COR_AZUL    = 1,
+    COR_VERMELHA= 2,
+    COR_AMARELA = 3
+} TipoCor;
+
+typedef enum {
+    SEGUIDOR_CLASSIFICA_LUT    = 0,   // tabela gerada (lut_cor.h); célula sem amostra: razões
+    SEGUIDOR_CLASSIFICA_RAZOES = 1    // razões entre canais
+} SeguidorClassificador;
+
+typedef struct {
+    uint16_t base_speed;          // das duas em frente e da roda esquerda no giro (motor.h, até 65535)
+    uint16_t spin_speed;          // da roda direita no giro (rumo_malha_aberta)
+    uint16_t trava_ms;            // quanto tempo a cor mais prioritária fica travada
+    uint16_t periodo_ms;          // período da leitura (alterna os sensores)
+    uint16_t brilho_min;          // C cru abaixo disso (pouco sinal): nenhuma cor
+    // A LUT de hoje vem das fotos da câmera (amarelo: 6 pontos avulsos) e erra
+    // nas assinaturas do TCS34725; fica como opção até ser gerada a partir de
+    // leituras de calibração do próprio sensor
+    uint8_t classificador;        // SeguidorClassificador
+    // Razões em Q8 (1.5 = 384): a regra inteira com SEGUIDOR_CLASSIFICA_RAZOES,
+    // e as células sem amostra da LUT
+    uint16_t razao_amarela_q8;    // r e g > b * razão
+    uint16_t razao_vermelha_q8;   // r > g * razão e r > b * razão
+    uint16_t razao_azul_q8;       // b > r * razão
+} SeguidorParams;
+
+#define SEGUIDOR_PARAMS_PADRAO {          \
+    .base_speed = 12100,                  \
+    .spin_speed = 9900,                   \
+    .trava_ms = 1500,                     \
+    .periodo_ms = 30,                     \
+    .brilho_min = 50,                     \
+    .classificador = SEGUIDOR_CLASSIFICA_RAZOES, \
+    .razao_amarela_q8 = 384,              \
+    .razao_vermelha_q8 = 384,             \
+    .razao_azul_q8 = 358,                 \
+}
+
+typedef struct {
+    TipoCor prioridade_ativa;
+    uint32_t fim_do_bloqueio_ms;
+    bool sem_faixa;               // última decisão: nenhuma cor depois da trava
+} SeguidorEstado;
+
+TipoCor seguidor_identifica_cor(const SeguidorParams *p, uint16_t r, uint16_t g, uint16_t b, uint16_t c);
+
+// Aplica a trava de prioridade e escolhe o movimento. Sem cor nos dois lados
+// devolve RETO e marca e->sem_faixa (o robô ainda pode consultar a visão).
+MlDirecao seguidor_decide(const SeguidorParams *p, SeguidorEstado *e,
+                          TipoCor cor_esq, TipoCor cor_dir, uint32_t agora_ms);
+
+#endif
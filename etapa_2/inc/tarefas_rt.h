@@ -0,0 +1,57 @@
+/**
+ * tarefas_rt.h - Contabilidade de tempo real das tarefas do FreeRTOS
+ *
+ * Cada tarefa do robô tem um TarefaRt com período (0 = disparada por evento),
+ * deadline relativo à liberação e prioridade. A tarefa marca o início e o fim
+ * de cada execução; daí saem o tempo de execução, o tempo de resposta e as
+ * perdas de deadline. O relatório soma o uso de CPU de cada tarefa na janela
+ * desde o último relatório (com configGENERATE_RUN_TIME_STATS o número vem
+ * do próprio kernel; sem isso, da soma dos tempos de execução medidos).
+ */
+#ifndef TAREFAS_RT_H
+#define TAREFAS_RT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TAREFAS_RT_MAX 8
+
+typedef struct {
+    const char *nome;
+    uint32_t periodo_us;         // 0 = tarefa disparada por evento
+    uint32_t deadline_us;        // relativo à liberação
+    UBaseType_t prioridade;
+    TaskHandle_t handle;
+
+    TickType_t proximo_tick;     // base do vTaskDelayUntil
+    uint32_t liberacao_us;       // liberação da execução atual
+    uint32_t inicio_us;
+
+    uint32_t ativacoes;
+    uint32_t perdas;             // resposta > deadline
+    uint32_t exec_ultimo_us;
+    uint32_t exec_max_us;
+    uint32_t resposta_max_us;
+    uint64_t exec_janela_us;     // soma na janela do relatório
+} TarefaRt;
+
+// Registra a tarefa e cria a task do FreeRTOS; 'periodo_ms' = 0 para eventos
+bool tarefa_rt_cria(TarefaRt *t, TaskFunction_t funcao, const char *nome, uint32_t pilha_palavras,
+                    UBaseType_t prioridade, uint32_t periodo_ms, uint32_t deadline_us);
+
+// Tarefas periódicas: dorme até a próxima liberação (vTaskDelayUntil) e abre a execução
+void tarefa_rt_espera_periodo(TarefaRt *t);
+
+// Tarefas por evento: abre a execução com a liberação informada (ex.: instante da leitura)
+void tarefa_rt_inicio(TarefaRt *t, uint32_t liberacao_us);
+
+// Fecha a execução; devolve false se o deadline foi perdido
+bool tarefa_rt_fim(TarefaRt *t);
+
+// Imprime uma linha "[RT] ..." por tarefa e zera a janela de uso de CPU
+void tarefas_rt_relatorio(void);
+
+#endif
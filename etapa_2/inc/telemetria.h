@@ -0,0 +1,126 @@
+/**
+ * telemetria.h - Amostras de telemetria em anel de RAM e lotes binários
+ *
+ * As tarefas de controle registram amostras (sensor, decisão, ML, motor)
+ * num anel fixo de TELEMETRIA_RING posições. Registrar nunca bloqueia: é uma
+ * seção crítica curta e, com o anel cheio, a amostra mais antiga é descartada
+ * (e contada). A tarefa de publicação (telemetria_mqtt.c) monta lotes a partir
+ * da mais antiga e só os remove do anel depois que a publicação deu certo;
+ * sem Wi-Fi, as amostras simplesmente se acumulam no anel.
+ *
+ * Formato do lote (little-endian), decodificado por src/host/telemetria_decodifica.py:
+ *
+ *   cabeçalho, 12 bytes
+ *     u16 magic 0x4C54 ("TL")  u8 versão  u8 n amostras
+ *     u16 seq (incrementa a cada lote publicado)
+ *     u16 perdidas (descartes no anel desde o lote anterior, satura em 65535)
+ *     u32 t0_ms (instante da primeira amostra)
+ *   amostra, 12 bytes (n vezes)
+ *     u16 dt_ms (desde t0)  u8 tipo  u8 aux  u16 v[4]
+ *
+ * Cada v é uma palavra de 16 bits e o tipo diz como ler (TelemetriaTipo): u
+ * sem sinal, saturado em 65535 (telemetria_u); s em complemento de 2,
+ * saturado em -32768..32767 (telemetria_s). O RGBC do TCS34725 passa de 32767
+ * e o PWM com sinal vai a ±65535, então nenhum dos dois cabe num i16 direto.
+ */
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef TELEMETRIA_RING
+#define TELEMETRIA_RING 1024          // amostras (16 B cada)
+#endif
+#define TELEMETRIA_LOTE_MAX 64
+
+#define TELEMETRIA_MAGIC  0x4C54
+#define TELEMETRIA_VERSAO 2
+#define TELEMETRIA_CABECALHO_BYTES 12
+#define TELEMETRIA_AMOSTRA_BYTES   12
+#define TELEMETRIA_LOTE_BYTES(n) (TELEMETRIA_CABECALHO_BYTES + (n) * TELEMETRIA_AMOSTRA_BYTES)
+
+// PWM do motor na amostra: comando / TELEMETRIA_PWM_DIV (±65535 -> ±32767)
+#define TELEMETRIA_PWM_DIV 2
+
+typedef enum {
+    TELEMETRIA_SENSOR  = 1,   // aux = lado (0 esq, 1 dir) | cor << 4; v = r, g, b, c (u)
+    TELEMETRIA_DECISAO = 2,   // aux = direção; v = cor esq, cor dir, prioridade, atraso us (u)
+    TELEMETRIA_ML      = 3,   // aux = direção; v = logits[3] (s), ciclos / 16 (u)
+    TELEMETRIA_MOTOR   = 4    // aux = ação;    v = pwm esq e dir / TELEMETRIA_PWM_DIV (s, ré < 0),
+                              //                motivo da parada, distância cm (u, 0xFFFF sem eco)
+} TelemetriaTipo;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t tipo;
+    uint8_t aux;
+    uint16_t v[4];
+} TelemetriaAmostra;
+
+static inline uint16_t telemetria_u(uint32_t v) {
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t) v;
+}
+
+static inline uint16_t telemetria_s(int32_t v) {
+    return (uint16_t) (int16_t) (v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v);
+}
+
+typedef struct {
+    uint16_t lote;            // amostras por lote (1..TELEMETRIA_LOTE_MAX)
+    uint16_t intervalo_ms;    // publica o que houver depois desse tempo
+    uint8_t qos;              // 0 ou 1
+} TelemetriaConfig;
+
+// Marca de um lote montado e ainda não confirmado
+typedef struct {
+    uint32_t inicio;          // índice absoluto da primeira amostra
+    uint16_t n;
+    uint16_t seq;
+    uint32_t perdidas;        // total de descartes quando o lote foi montado
+} TelemetriaLote;
+
+typedef struct {
+    uint32_t registradas;
+    uint32_t perdidas;        // anel cheio: amostra mais antiga descartada
+    uint32_t publicadas;      // amostras confirmadas
+    uint32_t lotes;
+    uint32_t bytes;
+    uint32_t falhas;          // publicações que falharam (o lote fica no anel)
+    uint32_t reconexoes;
+} TelemetriaEstatisticas;
+
+void telemetria_init(void);
+
+// Registra uma amostra com o instante dado; nunca bloqueia. Os v já vêm
+// codificados (telemetria_u / telemetria_s, conforme o tipo)
+void telemetria_registra_em(uint32_t t_ms, TelemetriaTipo tipo, uint8_t aux,
+                            uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3);
+
+#if PICO_ON_DEVICE
+#include "pico/time.h"
+static inline void telemetria_registra(TelemetriaTipo tipo, uint8_t aux,
+                                       uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3) {
+    telemetria_registra_em(to_ms_since_boot(get_absolute_time()), tipo, aux, v0, v1, v2, v3);
+}
+#endif
+
+uint32_t telemetria_pendentes(void);
+
+// Monta um lote com até 'max' amostras a partir da mais antiga; devolve os
+// bytes escritos em 'buf' (0 = anel vazio). O anel não muda até a confirmação.
+size_t telemetria_monta_lote(uint8_t *buf, size_t tamanho, uint16_t max, TelemetriaLote *lote);
+
+// O lote foi publicado: remove as amostras do anel e avança a sequência
+void telemetria_confirma_lote(const TelemetriaLote *lote, size_t bytes);
+
+void telemetria_conta_falha(void);
+void telemetria_conta_reconexao(void);
+
+const TelemetriaEstatisticas *telemetria_estatisticas(void);
+
+// Imprime "[TEL] ..." com vazão (amostras/s e bytes/s) desde o último relatório
+void telemetria_relatorio(void);
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * telemetria_mqtt.h - Tarefa que publica os lotes de telemetria via MQTT (paho)
+ *
+ * Conecta no Wi-Fi e no broker, monta lotes do anel (telemetria.h) quando há
+ * 'lote' amostras ou quando passa 'intervalo_ms', e publica em QoS 0 ou 1.
+ * Se o Wi-Fi ou o broker caírem, reconecta com espera exponencial; enquanto
+ * isso as amostras ficam no anel. A tarefa roda abaixo de todas as tarefas de
+ * controle e nunca é esperada por elas.
+ *
+ * O CYW43 já deve estar iniciado (cyw43_arch_init) antes de chamar.
+ */
+#ifndef TELEMETRIA_MQTT_H
+#define TELEMETRIA_MQTT_H
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+#include "telemetria.h"
+
+bool telemetria_mqtt_inicia(const TelemetriaConfig *cfg, UBaseType_t prioridade);
+
+#endif
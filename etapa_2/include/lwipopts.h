@@ -0,0 +1,68 @@
+/**
+ * lwipopts.h - lwIP do carrinho_seguidor_cor: com FreeRTOS (NO_SYS 0)
+ *
+ * O lwIP roda na própria tarefa tcpip (pico_cyw43_arch_lwip_sys_freertos) e o
+ * paho MQTT (src/paho_network.c) usa a API de sockets, bloqueante, a partir de
+ * uma tarefa comum. O lwipopts.h do etapa_3 é o do modo sem RTOS (NO_SYS 1,
+ * sem sockets) e não serve para este alvo.
+ */
+#ifndef _LWIPOPTS_H
+#define _LWIPOPTS_H
+
+// see https://www.nongnu.org/lwip/2_1_x/group__lwip__opts.html for details
+
+#define NO_SYS                      0
+#define LWIP_SOCKET                 1
+#define LWIP_NETCONN                1
+#define LWIP_TCPIP_CORE_LOCKING     1
+#define MEM_LIBC_MALLOC             0
+#define MEM_ALIGNMENT               4
+#define MEM_SIZE                    4000
+#define MEMP_NUM_TCP_SEG            32
+#define MEMP_NUM_ARP_QUEUE          10
+#define MEMP_NUM_NETCONN            4
+#define PBUF_POOL_SIZE              24
+#define LWIP_ARP                    1
+#define LWIP_ETHERNET               1
+#define LWIP_ICMP                   1
+#define LWIP_RAW                    1
+#define TCP_WND                     (8 * TCP_MSS)
+#define TCP_MSS                     1460
+#define TCP_SND_BUF                 (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+#define LWIP_NETIF_STATUS_CALLBACK  1
+#define LWIP_NETIF_LINK_CALLBACK    1
+#define LWIP_NETIF_HOSTNAME         1
+#define LWIP_SO_RCVTIMEO            1   // timeout de leitura do paho
+#define MEM_STATS                   0
+#define SYS_STATS                   0
+#define MEMP_STATS                  0
+#define LINK_STATS                  0
+#define LWIP_CHKSUM_ALGORITHM       3
+#define LWIP_DHCP                   1
+#define LWIP_IPV4                   1
+#define LWIP_TCP                    1
+#define LWIP_UDP                    1
+#define LWIP_DNS                    1
+#define LWIP_TCP_KEEPALIVE          1
+#define LWIP_NETIF_TX_SINGLE_PBUF   1
+#define DHCP_DOES_ARP_CHECK         0
+#define LWIP_DHCP_DOES_ACD_CHECK    0
+
+// Tarefa tcpip e caixas de mensagem (sys_arch do FreeRTOS)
+#define TCPIP_THREAD_STACKSIZE      1024
+#define TCPIP_THREAD_PRIO           (configMAX_PRIORITIES - 5)   // abaixo das tarefas de controle
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define TCPIP_MBOX_SIZE             8
+#define DEFAULT_TCP_RECVMBOX_SIZE   8
+#define DEFAULT_UDP_RECVMBOX_SIZE   8
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define DEFAULT_ACCEPTMBOX_SIZE     8
+
+#ifndef NDEBUG
+#define LWIP_DEBUG                  1
+#define LWIP_STATS                  1
+#define LWIP_STATS_DISPLAY          1
+#endif
+
+#endif /* _LWIPOPTS_H */
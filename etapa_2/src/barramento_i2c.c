@@ -0,0 +1,246 @@
+/**
+ * barramento_i2c.c - Tarefa dona de cada I2C, filas por dispositivo e recuperação
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+#include "barramento_i2c.h"
+
+#define N_BARRAMENTOS     2
+#define TIMEOUT_BASE_US   1000
+#define TIMEOUT_BYTE_US   30        // um byte a 400 kHz leva ~23 us
+#define PULSOS_SCL        9
+#define MEIO_PULSO_US     5         // ~100 kHz no destravamento
+
+static Barramento *barramentos[N_BARRAMENTOS];
+static int n_barramentos = 0;
+static uint32_t janela_inicio_us = 0;
+
+// --- PINOS E RECUPERAÇÃO ---
+
+// Dá o controlador aos pinos do dispositivo (se outro dispositivo do mesmo
+// controlador usa outros pinos, os dele ficam soltos, só com o pull-up)
+static void seleciona(Barramento *b, BarramentoDispositivo *d) {
+    BarramentoDispositivo *atual = b->selecionado;
+    if (atual == d) return;
+    if (atual && atual->sda == d->sda && atual->scl == d->scl) {
+        b->selecionado = d;
+        return;
+    }
+    if (atual) {
+        gpio_set_function(atual->sda, GPIO_FUNC_NULL);
+        gpio_set_function(atual->scl, GPIO_FUNC_NULL);
+    }
+    gpio_set_function(d->sda, GPIO_FUNC_I2C);
+    gpio_set_function(d->scl, GPIO_FUNC_I2C);
+    b->selecionado = d;
+}
+
+// Dreno aberto na mão: direção de saída com nível 0 puxa, entrada solta
+static void linha(uint pino, bool solta) {
+    gpio_set_dir(pino, solta ? GPIO_IN : GPIO_OUT);
+    sleep_us(MEIO_PULSO_US);
+}
+
+// Um escravo parado no meio de um byte segura o SDA em 0: pulsos de SCL até
+// ele soltar, um STOP feito à mão e o controlador reiniciado do zero
+static void recupera(Barramento *b, BarramentoDispositivo *d) {
+    i2c_deinit(b->i2c);
+    gpio_init(d->sda);
+    gpio_init(d->scl);
+
+    for (int i = 0; i < PULSOS_SCL && !gpio_get(d->sda); i++) {
+        linha(d->scl, false);
+        linha(d->scl, true);
+    }
+    linha(d->sda, false);       // SDA desce com SCL alto...
+    linha(d->sda, true);        // ...e sobe: STOP
+
+    i2c_init(b->i2c, b->baudrate);
+    gpio_set_function(d->sda, GPIO_FUNC_I2C);
+    gpio_set_function(d->scl, GPIO_FUNC_I2C);
+    b->selecionado = d;
+    b->recuperacoes++;
+}
+
+// --- EXECUÇÃO ---
+
+static int executa_segmentos(i2c_inst_t *i2c, uint8_t endereco, BarramentoPedido *p) {
+    int total = 0;
+    for (int i = 0; i < p->n_seg; i++) {
+        const BarramentoSegmento *s = &p->seg[i];
+        bool continua = i + 1 < p->n_seg;          // repeated start em vez de STOP
+        uint timeout = TIMEOUT_BASE_US + s->n * TIMEOUT_BYTE_US;
+        int r = s->leitura ? i2c_read_timeout_us(i2c, endereco, s->dados, s->n, continua, timeout)
+                           : i2c_write_timeout_us(i2c, endereco, s->dados, s->n, continua, timeout);
+        if (r < 0) return r;
+        if (r != s->n) return PICO_ERROR_GENERIC;
+        total += r;
+    }
+    return total;
+}
+
+static void atende(Barramento *b, BarramentoPedido *p) {
+    BarramentoDispositivo *d = p->disp;
+    uint32_t inicio = time_us_32();
+
+    seleciona(b, d);
+    int r = p->funcao ? p->funcao(b->i2c, d->endereco, p) : executa_segmentos(b->i2c, d->endereco, p);
+    if (r < 0) {
+        d->estat.falhas++;
+        // NACK com as linhas soltas é só um dispositivo ausente; o resto trava
+        if (r == PICO_ERROR_TIMEOUT || !gpio_get(d->sda) || !gpio_get(d->scl)) recupera(b, d);
+    }
+
+    uint32_t fim = time_us_32();
+    uint32_t espera = inicio - p->enviado_us;
+    uint32_t duracao = fim - inicio;
+    d->estat.pedidos++;
+    d->estat.ocupado_janela_us += duracao;
+    if (espera > d->estat.espera_max_us) d->estat.espera_max_us = espera;
+    if (duracao > d->estat.duracao_max_us) d->estat.duracao_max_us = duracao;
+
+    // Depois do aviso o pedido síncrono pode sumir (estava na pilha de quem pediu)
+    p->resultado = r;
+    if (p->concluido) p->concluido(p);
+    if (p->sincrono) xSemaphoreGive(d->pronto);
+}
+
+// Primeiro pedido da classe mais prioritária (disp[] está ordenado por classe)
+static BarramentoPedido *proximo(Barramento *b) {
+    BarramentoPedido *p;
+    for (int i = 0; i < b->n_disp; i++) {
+        if (xQueueReceive(b->disp[i]->fila, &p, 0) == pdTRUE) return p;
+    }
+    return NULL;
+}
+
+static void tarefa_barramento(void *arg) {
+    Barramento *b = arg;
+    for (;;) {
+        BarramentoPedido *p = proximo(b);
+        if (p) {
+            atende(b, p);
+        } else {
+            // Aviso dado depois da varredura fica guardado: nada se perde
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+}
+
+// --- API ---
+
+bool barramento_init(Barramento *b, i2c_inst_t *i2c, uint32_t baudrate, UBaseType_t prioridade,
+                     const char *nome) {
+    if (n_barramentos >= N_BARRAMENTOS) return false;
+    *b = (Barramento) { .nome = nome, .i2c = i2c, .baudrate = baudrate };
+    i2c_init(i2c, baudrate);
+    if (xTaskCreate(tarefa_barramento, nome, 256, b, prioridade, &b->tarefa) != pdPASS) return false;
+    barramentos[n_barramentos++] = b;
+    return true;
+}
+
+bool barramento_registra(Barramento *b, BarramentoDispositivo *d, const char *nome, uint8_t endereco,
+                         uint8_t sda, uint8_t scl, BarramentoClasse classe, uint8_t profundidade) {
+    if (b->n_disp >= BARRAMENTO_MAX_DISPOSITIVOS) return false;
+    *d = (BarramentoDispositivo) {
+        .nome = nome, .barramento = b, .endereco = endereco,
+        .sda = sda, .scl = scl, .classe = classe,
+        .fila = xQueueCreate(profundidade, sizeof(BarramentoPedido *)),
+        .pronto = xSemaphoreCreateBinary(),
+    };
+    if (!d->fila || !d->pronto) return false;
+
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    if (!b->selecionado) {
+        gpio_set_function(sda, GPIO_FUNC_I2C);
+        gpio_set_function(scl, GPIO_FUNC_I2C);
+        b->selecionado = d;
+    }
+
+    // Inserção ordenada por classe; a ordem de registro desempata
+    int i = b->n_disp++;
+    while (i > 0 && b->disp[i - 1]->classe > classe) {
+        b->disp[i] = b->disp[i - 1];
+        i--;
+    }
+    b->disp[i] = d;
+    return true;
+}
+
+bool barramento_envia(BarramentoDispositivo *d, BarramentoPedido *p) {
+    p->disp = d;
+    p->enviado_us = time_us_32();
+    if (xQueueSend(d->fila, &p, 0) != pdTRUE) {
+        d->estat.recusados++;
+        return false;
+    }
+    xTaskNotifyGive(d->barramento->tarefa);
+    return true;
+}
+
+int barramento_executa(BarramentoDispositivo *d, BarramentoPedido *p) {
+    p->sincrono = true;
+
+    // Antes do escalonador quem chama é o dono do barramento
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        p->disp = d;
+        p->enviado_us = time_us_32();
+        atende(d->barramento, p);
+        xSemaphoreTake(d->pronto, 0);
+        return p->resultado;
+    }
+
+    if (!barramento_envia(d, p)) return PICO_ERROR_GENERIC;
+    xSemaphoreTake(d->pronto, portMAX_DELAY);
+    return p->resultado;
+}
+
+int barramento_escreve(BarramentoDispositivo *d, const uint8_t *dados, uint16_t n) {
+    BarramentoPedido p = {
+        .seg = { { .dados = (uint8_t *) dados, .n = n, .leitura = false } },
+        .n_seg = 1,
+    };
+    return barramento_executa(d, &p);
+}
+
+int barramento_le_reg(BarramentoDispositivo *d, uint8_t reg, uint8_t *dados, uint16_t n) {
+    BarramentoPedido p = {
+        .seg = {
+            { .dados = &reg, .n = 1, .leitura = false },
+            { .dados = dados, .n = n, .leitura = true },
+        },
+        .n_seg = 2,
+    };
+    return barramento_executa(d, &p);
+}
+
+void barramento_relatorio(void) {
+    uint32_t agora = time_us_32();
+    uint32_t janela = agora - janela_inicio_us;
+    if (janela == 0) janela = 1;
+
+    for (int i = 0; i < n_barramentos; i++) {
+        Barramento *b = barramentos[i];
+        for (int j = 0; j < b->n_disp; j++) {
+            BarramentoDispositivo *d = b->disp[j];
+            BarramentoEstatisticas *e = &d->estat;
+            uint32_t uso_milesimos = (uint32_t) (e->ocupado_janela_us * 1000u / janela);
+            printf("[I2C] %s %-8s classe %d | uso %lu.%lu%% | pedidos=%lu espera max=%luus "
+                   "dur max=%luus | falhas=%lu recusados=%lu\n",
+                   b->nome, d->nome, (int) d->classe,
+                   (unsigned long) (uso_milesimos / 10), (unsigned long) (uso_milesimos % 10),
+                   (unsigned long) e->pedidos, (unsigned long) e->espera_max_us,
+                   (unsigned long) e->duracao_max_us,
+                   (unsigned long) e->falhas, (unsigned long) e->recusados);
+            e->ocupado_janela_us = 0;
+        }
+        if (b->recuperacoes) {
+            printf("[I2C] %s recuperacoes=%lu\n", b->nome, (unsigned long) b->recuperacoes);
+        }
+    }
+    janela_inicio_us = agora;
+}
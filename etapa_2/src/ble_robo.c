@@ -0,0 +1,188 @@
+/**
+ * ble_robo.c - GATT do robô sobre FreeRTOS (comandos remotos e quadros da visão)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "btstack.h"
+#include "pico/cyw43_arch.h"
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+// Header gerado pelo CMake a partir de etapa_3/src/bt_gatt_server_2/temp_sensor.gatt
+#include "temp_sensor.h"
+#include "ble_robo.h"
+#include "perfil.h"
+#include "boot.h"
+
+// Mesmos códigos do server.c do etapa_3
+#define CMD_PARE 0x00
+#define COR_FF11_NENHUMA  0x00
+#define COR_FF11_VERMELHO 0x01
+#define COR_FF11_AZUL     0x03
+
+#define QUADRO_INTERVALO_MIN_US 10000   // no máximo 100 quadros/s
+
+static uint8_t adv_data[] = {
+    0x02, BLUETOOTH_DATA_TYPE_FLAGS, 0x06,
+    0x05, BLUETOOTH_DATA_TYPE_COMPLETE_LOCAL_NAME, 'R', 'o', 'b', 'o',
+    0x03, BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS, 0x1a, 0x18,
+};
+
+static hci_con_handle_t con_handle = HCI_CON_HANDLE_INVALID;
+static btstack_packet_callback_registration_t hci_callback_registration;
+
+static QueueHandle_t caixa_quadro;          // QuadroRecebido, 1 elemento
+static LimitadorQuadros limitador;
+static volatile bool parado = false;
+static volatile uint8_t cor_atual = 0;
+static volatile bool zerar_perfil = false;
+
+// Foto da tabela de perfil: tirada na leitura com offset 0, as leituras
+// longas seguintes (offset > 0) continuam da mesma foto
+static uint8_t perfil_foto[PERFIL_SERIAL_BYTES];
+static uint16_t perfil_foto_bytes = 0;
+
+// --- CALLBACKS ATT (tarefa do async_context) ---
+
+static void recebe_quadro(const uint8_t *buffer, uint16_t buffer_size) {
+    QuadroRecebido r = { .recebido_us = time_us_32() };
+
+    if (!quadro_direcao_decodifica(buffer, buffer_size, &r.quadro)) {
+        limitador.invalidos++;
+        return;
+    }
+    if (!limitador_quadros_aceita(&limitador, &r.quadro, r.recebido_us)) return;
+
+    xQueueOverwrite(caixa_quadro, &r);
+}
+
+static int att_write_callback(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t transaction_mode,
+                              uint16_t offset, uint8_t *buffer, uint16_t buffer_size) {
+    PERFIL_INICIO(BLE_ATT);
+    if (att_handle == ATT_CHARACTERISTIC_0000FF12_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        if (buffer_size >= 1) {
+            parado = (buffer[0] == CMD_PARE);
+            printf("[BLE] comando 0x%02X -> %s\n", buffer[0], parado ? "PARADO" : "SEGUINDO");
+        }
+    }
+    else if (att_handle == ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        recebe_quadro(buffer, buffer_size);
+    }
+    else if (att_handle == ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        // Qualquer escrita pede para zerar o perfil; quem zera é o monitor
+        // (aqui a tabela seria apagada no meio da atualização de outra tarefa)
+        zerar_perfil = true;
+    }
+    PERFIL_FIM(BLE_ATT);
+    return 0;
+}
+
+static uint16_t att_read_callback(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t offset,
+                                  uint8_t *buffer, uint16_t buffer_size) {
+    if (att_handle == ATT_CHARACTERISTIC_0000FF11_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        if (buffer) buffer[0] = cor_atual;
+        return 1;
+    }
+    if (att_handle == ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        if (offset == 0) perfil_foto_bytes = (uint16_t) perfil_serializa(perfil_foto, sizeof(perfil_foto));
+        return att_read_callback_handle_blob(perfil_foto, perfil_foto_bytes, offset, buffer, buffer_size);
+    }
+    return 0;
+}
+
+static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
+    UNUSED(size);
+    UNUSED(channel);
+
+    if (packet_type != HCI_EVENT_PACKET) return;
+
+    switch (hci_event_packet_get_type(packet)) {
+        case BTSTACK_EVENT_STATE: {
+            if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) return;
+            bd_addr_t null_addr;
+            memset(null_addr, 0, 6);
+            gap_advertisements_set_params(800, 800, 0, 0, null_addr, 0x07, 0x00);
+            gap_advertisements_set_data(sizeof(adv_data), adv_data);
+            gap_advertisements_enable(1);
+            boot_marca(BOOT_ANUNCIO, time_us_32());
+            printf("[BLE] anunciando como 'Robo'\n");
+            break;
+        }
+
+        case HCI_EVENT_LE_META:
+            if (hci_event_le_meta_get_subevent_code(packet) == HCI_SUBEVENT_LE_CONNECTION_COMPLETE) {
+                con_handle = hci_subevent_le_connection_complete_get_connection_handle(packet);
+                gap_request_connection_parameter_update(con_handle, 10, 20, 0, 100);
+                printf("[BLE] conectado 0x%04x\n", con_handle);
+            }
+            break;
+
+        case HCI_EVENT_DISCONNECTION_COMPLETE:
+            con_handle = HCI_CON_HANDLE_INVALID;
+            limitador.tem_ultimo = false;       // nova conexão pode reiniciar os ids
+            xQueueReset(caixa_quadro);
+            printf("[BLE] desconectado, anunciando de novo\n");
+            gap_advertisements_enable(1);
+            break;
+    }
+}
+
+// --- API ---
+
+bool ble_robo_init(void) {
+    caixa_quadro = xQueueCreate(1, sizeof(QuadroRecebido));
+    limitador_quadros_init(&limitador, QUADRO_INTERVALO_MIN_US);
+
+    if (caixa_quadro == NULL) {
+        printf("[BLE] sem memoria para a caixa de quadros\n");
+        return false;
+    }
+
+    l2cap_init();
+    sm_init();
+    att_server_init(profile_data, att_read_callback, att_write_callback);
+
+    hci_callback_registration.callback = &packet_handler;
+    hci_add_event_handler(&hci_callback_registration);
+    att_server_register_packet_handler(packet_handler);
+
+    hci_power_control(HCI_POWER_ON);
+    return true;
+}
+
+bool ble_robo_parado(void) {
+    return parado;
+}
+
+bool ble_robo_quadro_recente(QuadroRecebido *q, uint32_t idade_max_us) {
+    if (caixa_quadro == NULL || xQueuePeek(caixa_quadro, q, 0) != pdTRUE) return false;
+    return time_us_32() - q->recebido_us <= idade_max_us;
+}
+
+// TipoCor (azul 1, vermelha 2, amarela 3) não bate com o protocolo da
+// 0xFF11 (vermelho 1, verde 2, azul 3): sem a tradução um cliente do
+// etapa_3 veria azul e vermelho trocados
+void ble_robo_cor_atual(TipoCor cor) {
+    switch (cor) {
+        case COR_VERMELHA: cor_atual = COR_FF11_VERMELHO; break;
+        case COR_AZUL:     cor_atual = COR_FF11_AZUL;     break;
+        default:           cor_atual = COR_FF11_NENHUMA;  break;
+    }
+}
+
+bool ble_robo_zerar_perfil(void) {
+    if (!zerar_perfil) return false;
+    zerar_perfil = false;
+    return true;
+}
+
+void ble_robo_relatorio(void) {
+    printf("[BLE] %s | quadros aceitos=%lu taxa=%lu ordem=%lu invalidos=%lu ressinc=%lu%s\n",
+           con_handle == HCI_CON_HANDLE_INVALID ? "sem conexao" : "conectado",
+           (unsigned long) limitador.aceitos, (unsigned long) limitador.descartados_taxa,
+           (unsigned long) limitador.descartados_ordem, (unsigned long) limitador.invalidos,
+           (unsigned long) limitador.ressincronias, parado ? " | PARE remoto" : "");
+}
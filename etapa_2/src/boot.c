@@ -0,0 +1,42 @@
+/**
+ * boot.c - Tabela das marcas da partida e relatório
+ */
+#include <stdio.h>
+
+#include "boot.h"
+
+static const char *const nomes[BOOT_N_FASES] = {
+#define BOOT_NOME(id, nome) nome,
+    BOOT_FASES(BOOT_NOME)
+#undef BOOT_NOME
+};
+
+// 0 = sem marca; uma marca que caísse em 0 us vira 1
+static volatile uint32_t marcas[BOOT_N_FASES];
+
+// Cada fase é marcada por uma tarefa só (ou antes do escalonador): sem trava
+void boot_marca(BootFase fase, uint32_t us) {
+    if (!marcas[fase]) marcas[fase] = us ? us : 1;
+}
+
+uint32_t boot_us(BootFase fase) {
+    return marcas[fase];
+}
+
+const char *boot_nome(BootFase fase) {
+    return nomes[fase];
+}
+
+// O rádio sobe em paralelo com os sensores: as fases não chegam em ordem,
+// então cada linha traz o tempo desde o reset e não a diferença
+void boot_relatorio(void) {
+    for (int f = 0; f < BOOT_N_FASES; f++) {
+        uint32_t us = marcas[f];
+        if (us) {
+            printf("[BOOT] %-12s t=%5lu.%lu ms\n", nomes[f],
+                   (unsigned long) (us / 1000u), (unsigned long) (us % 1000u / 100u));
+        } else {
+            printf("[BOOT] %-12s ainda não\n", nomes[f]);
+        }
+    }
+}
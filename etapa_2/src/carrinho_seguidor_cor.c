@@ -1,25 +1,107 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
-#include "hardware/pwm.h"
+#include "pico/stdio_usb.h"
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
 #include "hardware/timer.h" 
 
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+#include "seguidor.h"   // Cor e regra de decisão (as mesmas do simulador de varredura)
+#include "ml_direcao.h" // Classificador de direção int8 (CMSIS-NN)
+#include "tarefas_rt.h" // Períodos, deadlines e uso de CPU das tarefas
+#include "hcsr04.h"     // Ultrassom (obstáculo à frente)
+#include "ble_robo.h"   // Comandos remotos e quadros da visão
+#include "memoria.h"    // Trava de alocação no caminho de inferência
+#include "telemetria.h" // Amostras para o registro remoto
+#include "telemetria_mqtt.h"
+#include "registro_voo.h" // Gravador de bordo na flash ('d' no USB despeja)
+#include "barramento_i2c.h" // Dono de cada I2C: filas por dispositivo e prioridade
+#include "mpu6050_fifo.h" // Giroscópio Z pela FIFO (no i2c0, junto do sensor direito)
+#include "rumo.h"       // Guinada em ponto fixo e manutenção de rumo
+#include "oled.h"       // Tela de status (só as regiões que mudaram, por DMA)
+#include "motor.h"      // Ponte H: sentido e PWM das duas rodas de uma vez
+#include "ciclos.h"
+#include "perfil.h"     // Zonas de tempo ('p' no USB, característica 0xFF14)
+#include "latencia.h"   // Marcas do sensor ao PWM (-DLATENCIA=ON: percentis no monitor)
+#include "boot.h"       // Marcas da partida ('b' no USB)
+#include "exposicao.h"  // Ganho e ATIME automáticos de cada TCS34725
+#include "mapa_volta.h" // Memória da volta: base mais alta nas retas já vistas
+#include "pico/cyw43_arch.h"
+
 // ==========================================
 // CONFIGURAÇÃO DE HARDWARE
 // ==========================================
-#define LED_PIN 25 
-
-#define LEFT_FWD 4
-#define LEFT_BWD 9
-#define LEFT_PWM 8
-#define RIGHT_FWD 18
-#define RIGHT_BWD 19
-#define RIGHT_PWM 16
-#define STBY 20
+// Pinos da ponte H: inc/motor.h (conferidos na compilação)
+
+// HC-SR04: os pinos 8/9 do teste (testes_hc_sr_04-.c) são do motor esquerdo
+// aqui, e os 21/22 são o buzzer e o botão do joystick da BitDogLab. Sobram no
+// conector de expansão o GPIO 17 e o GPIO 28. Ligação:
+//   VCC -> 5 V (VSYS), GND -> GND
+//   TRIG -> GPIO 17 (3,3 V basta para o disparo)
+//   ECHO -> divisor 1k (série) / 2k (ao GND) -> GPIO 28 (o eco sai em 5 V)
+// O microfone da placa também está no GPIO 28 e não é usado pelo robô; se o
+// eco ficar ruidoso, desligar o microfone do pino.
+#define TRIG_PIN 17
+#define ECHO_PIN 28
+
+// 0 = regra de cores decide e a rede roda em paralelo (sombra, só compara)
+// 1 = a rede int8 decide o movimento
+#define MODO_DIRECAO_ML 0
+
+// 0 = giroscópio só estima a guinada (relatório [IMU]), motores em malha aberta
+// 1 = segura o rumo em RETO e freia os giros rápidos (sem MPU6050: malha aberta)
+#define MODO_RUMO 1
 
-#define BASE_SPEED 17000
-#define SPIN_SPEED 15000
+// ==========================================
+// TAREFAS: PRIORIDADES, PERÍODOS E DEADLINES
+// ==========================================
+// O motor fica no topo: aplica o último comando num período fixo e curto.
+// Sensores e decisão vêm logo abaixo; ML e monitor usam a CPU que sobra.
+// O BLE roda na tarefa do async_context do CYW43 (CYW43_TASK_PRIORITY).
+#define PRIO_MOTOR      (configMAX_PRIORITIES - 1)
+#define PRIO_BARRAMENTO (configMAX_PRIORITIES - 1)   // só roda quando alguém espera o I2C
+#define PRIO_SENSORES   (configMAX_PRIORITIES - 2)
+#define PRIO_DECISAO    (configMAX_PRIORITIES - 3)
+#define PRIO_DISTANCIA  (configMAX_PRIORITIES - 4)
+#define PRIO_ML         (tskIDLE_PRIORITY + 2)
+#define PRIO_MONITOR    (tskIDLE_PRIORITY + 1)
+
+#define PERIODO_MOTOR_MS      10
+#define DEADLINE_MOTOR_US     1000    // inclui a rajada da FIFO do MPU6050 (~300 us)
+#define DEADLINE_SENSORES_US  5000
+#define DEADLINE_DECISAO_US   5000    // da captura até o comando na caixa
+#define DEADLINE_ML_US        30000   // antes da próxima leitura
+#define PERIODO_DISTANCIA_MS  60      // ciclo mínimo recomendado do HC-SR04
+#define DEADLINE_DISTANCIA_US 40000
+#define DISTANCIA_TIMEOUT_MS  30      // ~5 m de ida e volta
+#define PERIODO_MONITOR_MS    2000
+
+#define COMANDO_VALIDADE_US   200000  // comando mais velho que isso: para
+#define DISTANCIA_PARADA_CM   15
+
+// Quadros da visão (só usados com a faixa perdida pelos sensores de chão;
+// a regra do quadro é quadro_direcao_comando(), a mesma do etapa_3)
+#define QUADRO_VISAO_IDADE_US  150000
+
+// Telemetria: lote cheio ou intervalo, o que vier primeiro (QoS 0 ou 1)
+#define TELEMETRIA_LOTE         32
+#define TELEMETRIA_INTERVALO_MS 1000
+#define TELEMETRIA_QOS          0
+
+// Tela de status: redesenha a cada período e envia logo depois da leitura do
+// sensor esquerdo, até a janela acabar (a próxima leitura dele vem em 60 ms)
+#define OLED_PERIODO_MS 100
+#define OLED_JANELA_US  20000
+
+// Perfil (-DPERFIL=ON): 'g' no USB passa este pino pelas zonas, uma por vez.
+// Sem pino livre no conector (17 e 28 são do HC-SR04, 21/22 o buzzer e o
+// botão do joystick, 5/6 os botões A/B): o GPIO 12 é o azul do LED RGB da
+// BitDogLab, que só acende junto com a zona. A ponta de prova vai no
+// resistor do LED
+#define PERFIL_GPIO_PINO 12
 
 // ==========================================
 // SENSORES
@@ -33,94 +115,141 @@
 #define TCS34725_ENABLE_AEN 0x02
 #define TCS34725_ENABLE_PON 0x01
 
+#define I2C_BAUDRATE (400 * 1000)
 #define I2C0_SDA_PIN 0
 #define I2C0_SCL_PIN 1
 #define I2C1_SDA_PIN 2
 #define I2C1_SCL_PIN 3
+#define OLED_SDA_PIN 14   // BitDogLab: OLED no i2c1, outros pinos
+#define OLED_SCL_PIN 15
 
+// r, g, b, c na escala comum da exposição (exposicao.h); c_cru é o C lido,
+// que mede a relação sinal/ruído
 typedef struct {
     uint16_t r, g, b, c;
+    uint16_t c_cru;
     bool valid; 
 } ColorData;
 
-typedef enum {
-    COR_NENHUMA = 0, 
-    COR_AZUL    = 1, 
-    COR_VERMELHA= 2, 
-    COR_AMARELA = 3  
-} TipoCor;
-
-// Variáveis globais para leitura assíncrona
-volatile TipoCor cor_esq_atual = COR_NENHUMA;
-volatile TipoCor cor_dir_atual = COR_NENHUMA;
-volatile bool nova_leitura_disponivel = false;
-volatile bool ler_sensor_esquerdo = true;
-
-// --- MOTORES ---
-void pwm_setup(uint pin) {
-    gpio_set_function(pin, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(pin);
-    pwm_set_wrap(slice, 65535);
-    pwm_set_enabled(slice, true);
-}
+// Velocidades, trava, período dos sensores e limiares de cor. Ajustados pela
+// varredura no host (src/host/varredura_seguidor.c) antes de ir para o chão.
+// O período dos sensores alterna os lados: cada um é lido a cada 2 períodos.
+static const SeguidorParams params = SEGUIDOR_PARAMS_PADRAO;
 
-void motors_init() {
-    gpio_init(LEFT_FWD);  gpio_set_dir(LEFT_FWD, GPIO_OUT);
-    gpio_init(LEFT_BWD);  gpio_set_dir(LEFT_BWD, GPIO_OUT);
-    gpio_init(RIGHT_FWD); gpio_set_dir(RIGHT_FWD, GPIO_OUT);
-    gpio_init(RIGHT_BWD); gpio_set_dir(RIGHT_BWD, GPIO_OUT);
-    gpio_init(STBY);      gpio_set_dir(STBY, GPIO_OUT);
-    gpio_put(STBY, 1); 
-    pwm_setup(LEFT_PWM);
-    pwm_setup(RIGHT_PWM);
-}
+// Exposição automática, um controlador por sensor. O teto de integração é
+// limitado no main ao intervalo entre duas leituras do mesmo sensor.
+static ExposicaoParams exposicao_params = EXPOSICAO_PARAMS_PADRAO;
+static Exposicao exposicao_esq, exposicao_dir;
 
-void run_forward() {
-    gpio_put(LEFT_FWD, 1);  gpio_put(LEFT_BWD, 0);
-    gpio_put(RIGHT_FWD, 1); gpio_put(RIGHT_BWD, 0);
-    pwm_set_gpio_level(LEFT_PWM, BASE_SPEED);
-    pwm_set_gpio_level(RIGHT_PWM, BASE_SPEED);
-}
+// Memória da volta: só a tarefa de decisão escreve, o monitor só relata
+static const MapaVoltaParams mapa_params = MAPA_VOLTA_PARAMS_PADRAO;
+static MapaVolta mapa;
 
-void spin_right() {
-    gpio_put(LEFT_FWD, 1);  gpio_put(LEFT_BWD, 0);
-    gpio_put(RIGHT_FWD, 0); gpio_put(RIGHT_BWD, 1);
-    pwm_set_gpio_level(LEFT_PWM, BASE_SPEED);
-    pwm_set_gpio_level(RIGHT_PWM, SPIN_SPEED);
-}
+// Leitura dos dois sensores (a mais nova de cada um). Os slots circulam só
+// por ponteiro: livres -> sensores -> decisão -> ML -> livres.
+typedef struct {
+    ColorData esq, dir;
+    TipoCor cor_esq, cor_dir;
+    uint32_t captura_us;
+    MlDirecao decisao_regra;     // preenchida pela decisão, comparada pelo ML
+    uint16_t base_speed;         // base do mapa da volta para esta leitura
+    LatenciaMarcas marcas;       // do sensor lido neste período
+    bool tem_visao;              // a direção veio do quadro 'visao' (faixa perdida)
+    QuadroRecebido visao;
+} Leitura;
 
-void spin_left() {
-    gpio_put(LEFT_FWD, 0);  gpio_put(LEFT_BWD, 1);
-    gpio_put(RIGHT_FWD, 1); gpio_put(RIGHT_BWD, 0);
-    pwm_set_gpio_level(LEFT_PWM, BASE_SPEED);
-    pwm_set_gpio_level(RIGHT_PWM, SPIN_SPEED);
-}
+typedef struct {
+    MlDirecao direcao;
+    uint16_t base_speed;         // params.base_speed ou a base rápida do mapa
+    uint32_t captura_us;         // da leitura que originou o comando
+    LatenciaMarcas marcas;       // as da leitura, mais a da publicação
+    bool tem_visao;              // comando decidido pelo quadro 'visao'
+    QuadroRecebido visao;
+} Comando;
+
+// Ação aplicada e motivo da parada (amostras TELEMETRIA_MOTOR)
+typedef enum { ACAO_PARADO = 0, ACAO_FRENTE, ACAO_ESQUERDA, ACAO_DIREITA } AcaoMotor;
+typedef enum { PARADA_NENHUMA = 0, PARADA_SEM_COMANDO, PARADA_REMOTA, PARADA_OBSTACULO } MotivoParada;
+
+#define N_LEITURAS 4
+static Leitura leituras[N_LEITURAS];
+
+static QueueHandle_t fila_livres;      // Leitura*
+static QueueHandle_t fila_decisao;     // Leitura*
+static QueueHandle_t fila_ml;          // Leitura*
+static QueueHandle_t caixa_comando;    // Comando, 1 elemento (xQueueOverwrite)
+static QueueHandle_t caixa_distancia;  // uint16_t cm, 1 elemento
+
+static TarefaRt rt_motor, rt_sensores, rt_decisao, rt_distancia, rt_ml, rt_monitor;
+
+// i2c0: TCS34725 direito (sensores) e MPU6050 (motor)
+// i2c1: TCS34725 esquerdo (sensores) e OLED (outros pinos)
+static Barramento barramento_0, barramento_1;
+static BarramentoDispositivo tcs_esq, tcs_dir, imu, tela;
+
+// O que a tela mostra (escrito pelas tarefas, lido pela do display)
+static volatile TipoCor tela_cor_esq = COR_NENHUMA, tela_cor_dir = COR_NENHUMA;
+static volatile int32_t tela_pwm_esq = 0, tela_pwm_dir = 0;
+
+_Static_assert(RUMO_TAXA_HZ == MPU6050_TAXA_HZ && RUMO_LSB_DPS == MPU6050_LSB_DPS,
+               "rumo.h fora de sincronia com a configuração do MPU6050");
+static const RumoParams rumo_params = RUMO_PARAMS_PADRAO;
+static const MotorRampa motor_rampa = MOTOR_RAMPA_PADRAO;
+static Rumo rumo;
+static bool imu_ok = false;
+static uint32_t imu_periodos = 0;
+static uint32_t imu_ciclos_max = 0;
+static uint64_t imu_ciclos_soma = 0;
+
+static volatile uint32_t leituras_perdidas = 0;   // sensores sem slot livre
+static volatile bool motores_parados = true;      // o gravador só apaga flash assim
+static volatile uint32_t ml_descartes = 0;        // ML ainda ocupado
+static uint32_t ml_concordancias = 0;
+
+#if LATENCIA_ATIVO
+static Latencia latencia;                         // escrita só pela tarefa do motor
+#endif
+static LatenciaQuadros latencia_visao;            // câmera -> rodas; só a tarefa do motor escreve
 
 // --- I2C / SENSOR ---
-void tcs_write8(i2c_inst_t *i2c, uint8_t reg, uint8_t value) {
+// Tudo passa pelo escalonador do barramento (barramento_i2c.c): falha de
+// barramento é contada por dispositivo e o barramento é destravado lá
+void tcs_write8(BarramentoDispositivo *tcs, uint8_t reg, uint8_t value) {
     uint8_t buf[2] = {TCS34725_COMMAND_BIT | reg, value};
-    i2c_write_blocking(i2c, TCS34725_ADDR, buf, 2, false);
+    barramento_escreve(tcs, buf, 2);
+}
+
+// Tempo de integração e ganho escolhidos pela exposição; valem a partir da
+// próxima integração
+static void tcs_configura(BarramentoDispositivo *tcs, const Exposicao *e) {
+    tcs_write8(tcs, TCS34725_ATIME, exposicao_atime(e));
+    tcs_write8(tcs, TCS34725_CONTROL, exposicao_control(e));
 }
 
-void tcs_init(i2c_inst_t *i2c) {
-    tcs_write8(i2c, TCS34725_ATIME, 0xF6); // ~24ms (mais rápido)
-    tcs_write8(i2c, TCS34725_CONTROL, 0x01); // 4x Gain
-    tcs_write8(i2c, TCS34725_ENABLE, TCS34725_ENABLE_PON);
-    sleep_ms(3);
-    tcs_write8(i2c, TCS34725_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+// Liga os sensores juntos: uma espera só de PON -> AEN (2,4 ms) para todos,
+// e na tarefa ela libera a CPU em vez de girar
+void tcs_init(BarramentoDispositivo *const tcs[], const Exposicao *const exposicao[], int n) {
+    for (int i = 0; i < n; i++) {
+        tcs_configura(tcs[i], exposicao[i]);
+        tcs_write8(tcs[i], TCS34725_ENABLE, TCS34725_ENABLE_PON);
+    }
+    vTaskDelay(pdMS_TO_TICKS(3));
+    for (int i = 0; i < n; i++) {
+        tcs_write8(tcs[i], TCS34725_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+    }
 }
 
-ColorData read_color_fast(i2c_inst_t *i2c) {
+// Comando + 8 bytes (C, R, G, B) num pedido só, com repeated start
+ColorData read_color_fast(BarramentoDispositivo *tcs) {
     ColorData d;
     d.valid = true;
 
-    uint8_t cmd = TCS34725_COMMAND_BIT | TCS34725_CDATAL;
     uint8_t buf[8];
 
-    int ok1 = i2c_write_blocking(i2c, TCS34725_ADDR, &cmd, 1, true);
-    int ok2 = i2c_read_blocking(i2c, TCS34725_ADDR, buf, 8, false);
-
-    if (ok1 < 0 || ok2 < 0) {
+    PERFIL_INICIO(SENSOR_I2C);
+    int n = barramento_le_reg(tcs, TCS34725_COMMAND_BIT | TCS34725_CDATAL, buf, 8);
+    PERFIL_FIM(SENSOR_I2C);
+    if (n != 8) {
         d.valid = false;
         return d;
     }
@@ -133,117 +262,637 @@ ColorData read_color_fast(i2c_inst_t *i2c) {
     return d;
 }
 
+// Leitura crua -> escala comum. Se o controlador mudou ganho ou ATIME, o
+// sensor é reconfigurado já; repetida ou da configuração antiga não vale.
+static bool tcs_expoe(BarramentoDispositivo *tcs, Exposicao *e, ColorData *d) {
+    uint16_t crgb[4] = { d->c, d->r, d->g, d->b };
+    d->c_cru = d->c;
+    ExposicaoLeitura r = exposicao_processa(e, &exposicao_params, crgb);
+    if (e->mudou) {
+        tcs_configura(tcs, e);
+        e->mudou = false;
+    }
+    if (r != EXPOSICAO_NOVA) return false;
+    d->c = crgb[0];
+    d->r = crgb[1];
+    d->g = crgb[2];
+    d->b = crgb[3];
+    return true;
+}
+
+// A cromaticidade vem da escala comum; o corte de brilho, do C cru
 TipoCor identificar_cor(ColorData d) {
-    if (d.c < 50) return COR_NENHUMA;
-    if (d.r > d.b * 1.5 && d.g > d.b * 1.5) return COR_AMARELA;
-    if (d.r > d.g * 1.5 && d.r > d.b * 1.5) return COR_VERMELHA;
-    if (d.b > d.r * 1.4) return COR_AZUL;
-    return COR_NENHUMA;
-}
-
-// Callback do timer - lê sensores alternadamente
-bool timer_callback(struct repeating_timer *t) {
-    ColorData data;
-    
-    if (ler_sensor_esquerdo) {
-        data = read_color_fast(i2c1);
-        if (data.valid) {
-            cor_esq_atual = identificar_cor(data);
+    return seguidor_identifica_cor(&params, d.r, d.g, d.b, d.c_cru);
+}
+
+// ==========================================
+// TAREFAS
+// ==========================================
+static void publica_comando(MlDirecao direcao, const Leitura *l) {
+    Comando cmd = { .direcao = direcao, .base_speed = l->base_speed,
+                    .captura_us = l->captura_us, .marcas = l->marcas,
+                    // No modo ML a rede pode ter decidido outra coisa
+                    .tem_visao = l->tem_visao && direcao == l->decisao_regra, .visao = l->visao };
+    latencia_marca(&cmd.marcas, LATENCIA_DECISAO, time_us_32());
+    xQueueOverwrite(caixa_comando, &cmd);
+}
+
+// Faixa perdida pelos sensores de chão: usa o último quadro da câmera (BLE).
+// O quadro que decidiu fica na leitura, para a latência câmera -> motor
+static MlDirecao direcao_visao(MlDirecao padrao, Leitura *l) {
+    static const MlDirecao direcoes[] = {
+        [QUADRO_CMD_RETO] = ML_DIRECAO_RETO,
+        [QUADRO_CMD_ESQUERDA] = ML_DIRECAO_ESQUERDA,
+        [QUADRO_CMD_DIREITA] = ML_DIRECAO_DIREITA,
+    };
+    QuadroRecebido r;
+    if (!ble_robo_quadro_recente(&r, QUADRO_VISAO_IDADE_US)) return padrao;
+    QuadroComando c = quadro_direcao_comando(&r.quadro);
+    if (c == QUADRO_CMD_PARE) return padrao;
+    l->tem_visao = true;
+    l->visao = r;
+    return direcoes[c];
+}
+
+// Esvazia a FIFO do giroscópio e atualiza a guinada. No i2c0 o sensor
+// direito tem a frente: a espera é no máximo uma leitura dele (~300 us).
+// Devolve os ciclos de CPU da integração (o barramento o driver mede).
+static uint32_t le_imu(void) {
+    int16_t gz[MPU6050_FIFO_MAX];
+    uint32_t ciclos = 0;
+
+    PERFIL_INICIO(IMU);
+    int n = mpu6050_le_fifo(gz, MPU6050_FIFO_MAX);
+    if (n > 0) {
+        uint32_t c0 = ciclos_le();
+        rumo_amostras(&rumo_params, &rumo, gz, n, motores_parados);
+        ciclos = ciclos_decorridos(c0, ciclos_le());
+    }
+    PERFIL_FIM(IMU);
+    return ciclos;
+}
+
+// Prioridade máxima: aplica o comando mais novo a cada período.
+// Sem comando recente, PARE remoto ou obstáculo perto: motores parados.
+static void tarefa_motor(void *arg) {
+    TarefaRt *rt = arg;
+    Comando cmd;
+    uint16_t distancia = HCSR04_SEM_ECO;
+    AcaoMotor acao_anterior = ACAO_PARADO;
+    MotivoParada motivo_anterior = PARADA_NENHUMA;
+    uint32_t captura_aplicada = 0;
+#if LATENCIA_ATIVO
+    // Marcas esperando a rampa pôr as rodas no sentido do comando
+    LatenciaMarcas pendente;
+    MlDirecao pendente_direcao = ML_DIRECAO_RETO;
+    uint32_t pendente_alvo = 0;
+    bool tem_pendente = false;
+#endif
+    // Quadro da visão que decidiu um comando, esperando a rampa como acima
+    // (sempre ligado: é uma comparação por período)
+    QuadroRecebido visao_pendente;
+    MlDirecao visao_direcao = ML_DIRECAO_RETO;
+    uint32_t visao_alvo = 0;
+    uint16_t visao_id = 0;
+    bool tem_visao = false;
+
+    for (;;) {
+        tarefa_rt_espera_periodo(rt);
+        PERFIL_INICIO(MOTOR);
+
+        uint32_t ciclos = imu_ok ? le_imu() : 0;
+
+        xQueuePeek(caixa_distancia, &distancia, 0);
+        bool tem_comando = xQueuePeek(caixa_comando, &cmd, 0) == pdTRUE &&
+                           time_us_32() - cmd.captura_us <= COMANDO_VALIDADE_US;
+
+        MotivoParada motivo = !tem_comando ? PARADA_SEM_COMANDO :
+                              ble_robo_parado() ? PARADA_REMOTA :
+                              distancia < DISTANCIA_PARADA_CM ? PARADA_OBSTACULO : PARADA_NENHUMA;
+        AcaoMotor acao;
+        int32_t pwm_esq = 0, pwm_dir = 0;
+
+        if (motivo != PARADA_NENHUMA) {
+            motor_para();
+            acao = ACAO_PARADO;
+            rumo.referencia_valida = false;   // parado, pode ter sido mexido
+#if LATENCIA_ATIVO
+            tem_pendente = false;             // a curva não chegou a começar
+#endif
+            tem_visao = false;
         }
-    } else {
-        data = read_color_fast(i2c0);
-        if (data.valid) {
-            cor_dir_atual = identificar_cor(data);
+        else {
+            acao = cmd.direcao == ML_DIRECAO_DIREITA  ? ACAO_DIREITA :
+                   cmd.direcao == ML_DIRECAO_ESQUERDA ? ACAO_ESQUERDA : ACAO_FRENTE;
+
+            uint32_t c0 = ciclos_le();
+            if (MODO_RUMO && imu_ok) {
+                rumo_controla(&rumo_params, &rumo, cmd.direcao, cmd.base_speed,
+                              params.spin_speed, &pwm_esq, &pwm_dir);
+            } else {
+                rumo_malha_aberta(cmd.direcao, cmd.base_speed, params.spin_speed,
+                                  &pwm_esq, &pwm_dir);
+            }
+            ciclos += ciclos_decorridos(c0, ciclos_le());
+
+            uint32_t alvo = motor_alvo(pwm_esq, pwm_dir);
+            boot_marca(BOOT_COMANDO, time_us_32());
+
+            // Primeira aplicação do comando desta leitura: as marcas esperam a
+            // rampa. Leitura nova na mesma direção durante a espera não conta
+            // (quem pediu o sentido foi a anterior); direção nova descarta a
+            // que não chegou
+            if (cmd.captura_us != captura_aplicada) {
+                captura_aplicada = cmd.captura_us;
+#if LATENCIA_ATIVO
+                if (!tem_pendente || cmd.direcao != pendente_direcao) {
+                    pendente = cmd.marcas;
+                    pendente_direcao = cmd.direcao;
+                    pendente_alvo = alvo;
+                    tem_pendente = true;
+                }
+#endif
+                // Mesma regra para o quadro; um quadro usado por várias
+                // leituras conta uma vez
+                if (cmd.tem_visao && cmd.visao.quadro.id_quadro != visao_id &&
+                    (!tem_visao || cmd.direcao != visao_direcao)) {
+                    visao_pendente = cmd.visao;
+                    visao_direcao = cmd.direcao;
+                    visao_id = cmd.visao.quadro.id_quadro;
+                    visao_alvo = alvo;
+                    tem_visao = true;
+                }
+            }
+        }
+        uint32_t visao_us;
+        if (tem_visao && motor_no_sentido(visao_alvo, &visao_us)) {
+            latencia_quadros_registra(&latencia_visao, &visao_pendente.quadro,
+                                      visao_pendente.recebido_us, visao_us);
+            tem_visao = false;
+        }
+#if LATENCIA_ATIVO
+        uint32_t no_sentido_us;
+        if (tem_pendente && motor_no_sentido(pendente_alvo, &no_sentido_us)) {
+            latencia_marca(&pendente, LATENCIA_PWM, no_sentido_us);
+            latencia_amostra(&latencia, &pendente);
+            tem_pendente = false;
         }
+#endif
+
+        imu_periodos++;
+        imu_ciclos_soma += ciclos;
+        if (ciclos > imu_ciclos_max) imu_ciclos_max = ciclos;
+
+        // A cada 10 ms seria ruído: registra só as mudanças
+        if (acao != acao_anterior || motivo != motivo_anterior) {
+            telemetria_registra(TELEMETRIA_MOTOR, (uint8_t) acao,
+                                telemetria_s(pwm_esq / TELEMETRIA_PWM_DIV),
+                                telemetria_s(pwm_dir / TELEMETRIA_PWM_DIV),
+                                (uint16_t) motivo, distancia);
+            acao_anterior = acao;
+            motivo_anterior = motivo;
+        }
+        motores_parados = acao == ACAO_PARADO;
+        tela_pwm_esq = pwm_esq;
+        tela_pwm_dir = pwm_dir;
+
+        PERFIL_FIM(MOTOR);
+        tarefa_rt_fim(rt);
     }
-    
-    ler_sensor_esquerdo = !ler_sensor_esquerdo;
-    nova_leitura_disponivel = true;
-    
-    return true; // Continua repetindo
 }
 
-// ================= MAIN =================
-int main() {
-    stdio_init_all();
-    
-    gpio_init(LED_PIN);
-    gpio_set_dir(LED_PIN, GPIO_OUT);
-    for(int i=0; i<3; i++) { 
-        gpio_put(LED_PIN, 1); sleep_ms(100); 
-        gpio_put(LED_PIN, 0); sleep_ms(100);
-    }
+// Lê um sensor por período (alternando) e publica a leitura num slot livre
+static void tarefa_sensores(void *arg) {
+    TarefaRt *rt = arg;
+    ColorData esq = { 0 }, dir = { 0 };
+    TipoCor cor_esq = COR_NENHUMA, cor_dir = COR_NENHUMA;
+    bool ler_sensor_esquerdo = true;
+
+    // Os sensores sobem aqui e não no main: a espera do PON corre junto com o
+    // rádio e a primeira integração (~24 ms) já conta no período da tarefa
+    BarramentoDispositivo *const tcs[] = { &tcs_esq, &tcs_dir };
+    const Exposicao *const exposicao[] = { &exposicao_esq, &exposicao_dir };
+    tcs_init(tcs, exposicao, 2);
+    boot_marca(BOOT_TCS, time_us_32());
+
+    for (;;) {
+        tarefa_rt_espera_periodo(rt);
+
+        LatenciaMarcas marcas = { 0 };
+        bool nova;
+        if (ler_sensor_esquerdo) {
+            ColorData data = read_color_fast(&tcs_esq);
+            latencia_marca(&marcas, LATENCIA_I2C, time_us_32());
+            data.valid = data.valid && tcs_expoe(&tcs_esq, &exposicao_esq, &data);
+            oled_janela();
+            nova = data.valid;
+            if (data.valid) {
+                if (data.c) boot_marca(BOOT_COR, time_us_32());
+                esq = data;
+                cor_esq = identificar_cor(data);
+                latencia_marca(&marcas, LATENCIA_CLASSIFICA, time_us_32());
+                tela_cor_esq = cor_esq;
+                telemetria_registra(TELEMETRIA_SENSOR, (uint8_t) (0 | cor_esq << 4),
+                                    data.r, data.g, data.b, data.c);
+            }
+        } else {
+            ColorData data = read_color_fast(&tcs_dir);
+            latencia_marca(&marcas, LATENCIA_I2C, time_us_32());
+            data.valid = data.valid && tcs_expoe(&tcs_dir, &exposicao_dir, &data);
+            nova = data.valid;
+            if (data.valid) {
+                if (data.c) boot_marca(BOOT_COR, time_us_32());
+                dir = data;
+                cor_dir = identificar_cor(data);
+                latencia_marca(&marcas, LATENCIA_CLASSIFICA, time_us_32());
+                tela_cor_dir = cor_dir;
+                telemetria_registra(TELEMETRIA_SENSOR, (uint8_t) (1 | cor_dir << 4),
+                                    data.r, data.g, data.b, data.c);
+            }
+        }
+        ler_sensor_esquerdo = !ler_sensor_esquerdo;
 
-    sleep_ms(1000);
-    printf("--- Leitura otimizada com timer ---\n");
+        // Leitura inválida não vai para a decisão: nada mudou nos dois lados,
+        // e com captura_us de agora a cor velha passaria por recente
+        if (!nova) {
+            tarefa_rt_fim(rt);
+            continue;
+        }
 
-    // I2C em modo rápido (400kHz)
-    i2c_init(i2c0, 400 * 1000); 
-    gpio_set_function(I2C0_SDA_PIN, GPIO_FUNC_I2C); 
-    gpio_set_function(I2C0_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C0_SDA_PIN); 
-    gpio_pull_up(I2C0_SCL_PIN);
+        Leitura *l;
+        if (xQueueReceive(fila_livres, &l, 0) == pdTRUE) {
+            l->esq = esq;
+            l->dir = dir;
+            l->cor_esq = cor_esq;
+            l->cor_dir = cor_dir;
+            l->captura_us = time_us_32();
+            l->marcas = marcas;
+            xQueueSend(fila_decisao, &l, 0);
+        } else {
+            leituras_perdidas++;
+        }
 
-    i2c_init(i2c1, 400 * 1000);
-    gpio_set_function(I2C1_SDA_PIN, GPIO_FUNC_I2C); 
-    gpio_set_function(I2C1_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C1_SDA_PIN); 
-    gpio_pull_up(I2C1_SCL_PIN);
+        tarefa_rt_fim(rt);
+    }
+}
 
-    motors_init();
-    tcs_init(i2c0);
-    tcs_init(i2c1);
+// Regra de cores com trava de prioridade; o deadline conta da captura
+static void tarefa_decisao(void *arg) {
+    TarefaRt *rt = arg;
+    SeguidorEstado estado = { .prioridade_ativa = COR_NENHUMA };
+    Leitura *l;
 
-    // Configura timer para ler sensores a cada 30ms alternadamente
-    struct repeating_timer timer;
-    add_repeating_timer_ms(30, timer_callback, NULL, &timer);
+    for (;;) {
+        xQueueReceive(fila_decisao, &l, portMAX_DELAY);
+        tarefa_rt_inicio(rt, l->captura_us);
 
-    TipoCor prioridade_ativa = COR_NENHUMA;
-    uint32_t fim_do_bloqueio = 0;
+        TipoCor maior_cor_agora = (l->cor_dir > l->cor_esq) ? l->cor_dir : l->cor_esq;
+        TipoCor prioridade_antes = estado.prioridade_ativa;
+        uint32_t tempo_agora = to_ms_since_boot(get_absolute_time());
 
-    while (true) {
-        // Espera nova leitura estar disponível
-        if (!nova_leitura_disponivel) {
-            sleep_ms(1);
-            continue;
+        MlDirecao decisao = seguidor_decide(&params, &estado, l->cor_esq, l->cor_dir, tempo_agora);
+        if (maior_cor_agora > prioridade_antes) {
+            printf("Prioridade travada em: %d\n", maior_cor_agora);
+        }
+        l->tem_visao = false;
+        if (estado.sem_faixa) {
+            decisao = direcao_visao(decisao, l);
+        }
+        TipoCor prioridade_ativa = estado.prioridade_ativa;
+
+        // O mapa segue a regra (também no modo ML, que só troca a direção).
+        // Experimental: sem MAPA_VOLTA_ATIVO ele só aprende, a base não muda
+        uint16_t base_mapa = mapa_volta_passo(&mapa, &mapa_params, decisao, maior_cor_agora, tempo_agora,
+                                              params.base_speed, params.spin_speed);
+        l->base_speed = MAPA_VOLTA_ATIVO ? base_mapa : params.base_speed;
+        l->decisao_regra = decisao;
+        ble_robo_cor_atual(maior_cor_agora);
+        if (!MODO_DIRECAO_ML) publica_comando(decisao, l);
+
+        const RegistroVoo reg = {
+            .esq = { l->esq.r, l->esq.g, l->esq.b, l->esq.c },
+            .dir = { l->dir.r, l->dir.g, l->dir.b, l->dir.c },
+            .cor_esq = (uint8_t) l->cor_esq,
+            .cor_dir = (uint8_t) l->cor_dir,
+            .prioridade = (uint8_t) prioridade_ativa,
+            .movimento = (uint8_t) decisao,
+            .captura_us = l->captura_us,
+            .decisao_us = time_us_32(),
+        };
+        registro_voo_anota(&reg);
+
+        uint32_t atraso_us = reg.decisao_us - l->captura_us;
+        telemetria_registra(TELEMETRIA_DECISAO, (uint8_t) decisao, l->cor_esq, l->cor_dir,
+                            prioridade_ativa, telemetria_u(atraso_us));
+
+        // O slot segue para a inferência; se ela estiver ocupada, volta ao pool
+        if (xQueueSend(fila_ml, &l, 0) != pdTRUE) {
+            ml_descartes++;
+            xQueueSend(fila_livres, &l, 0);
         }
-        
-        nova_leitura_disponivel = false;
-        
-        // Copia valores voláteis localmente
-        TipoCor cor_esq_real = cor_esq_atual;
-        TipoCor cor_dir_real = cor_dir_atual;
 
-        // Lógica de prioridade
-        TipoCor maior_cor_agora = (cor_dir_real > cor_esq_real) ? cor_dir_real : cor_esq_real;
-        uint32_t tempo_agora = to_ms_since_boot(get_absolute_time());
+        tarefa_rt_fim(rt);
+    }
+}
+
+// Classificador int8: sombra da regra (ou decide, com MODO_DIRECAO_ML = 1)
+static void tarefa_ml(void *arg) {
+    TarefaRt *rt = arg;
+    Leitura *l;
+
+    for (;;) {
+        xQueueReceive(fila_ml, &l, portMAX_DELAY);
+        tarefa_rt_inicio(rt, l->captura_us);
+
+        const uint16_t esq_rgbc[4] = { l->esq.r, l->esq.g, l->esq.b, l->esq.c };
+        const uint16_t dir_rgbc[4] = { l->dir.r, l->dir.g, l->dir.b, l->dir.c };
+        int8_t logits[MODELO_DIRECAO_CLASSES];
+        MlDirecao decisao_ml = ML_DIRECAO_RETO;
+
+        // Caminho de inferência inteiro (janela + rede): alocar aqui é
+        // panic(), e a zona ML mede os dois (só a janela até ela encher)
+        memoria_inferencia_inicio();
+        PERFIL_INICIO(ML);
+        ml_direcao_amostra(esq_rgbc, dir_rgbc);
+        bool inferiu = ml_direcao_pronto();
+        if (inferiu) decisao_ml = ml_direcao_infere(logits);
+        PERFIL_FIM(ML);
+        memoria_inferencia_fim();
+
+        if (inferiu) {
+            telemetria_registra(TELEMETRIA_ML, (uint8_t) decisao_ml, telemetria_s(logits[0]),
+                                telemetria_s(logits[1]), telemetria_s(logits[2]),
+                                telemetria_u(ml_direcao_estatisticas()->ciclos_ultimo / 16));
+
+            if (decisao_ml == l->decisao_regra) ml_concordancias++;
+            if (MODO_DIRECAO_ML) publica_comando(decisao_ml, l);
+        }
+
+        xQueueSend(fila_livres, &l, 0);
+        tarefa_rt_fim(rt);
+    }
+}
+
+static void tarefa_distancia(void *arg) {
+    TarefaRt *rt = arg;
+
+    for (;;) {
+        tarefa_rt_espera_periodo(rt);
+        uint16_t cm = hcsr04_mede_cm(DISTANCIA_TIMEOUT_MS);
+        xQueueOverwrite(caixa_distancia, &cm);
+        tarefa_rt_fim(rt);
+    }
+}
+
+// Amostras por rajada, tempo de barramento (driver) e de CPU (guinada + controle)
+static void imu_relatorio(void) {
+    const Mpu6050Estatisticas *e = mpu6050_estatisticas();
+    if (e->leituras == 0 || imu_periodos == 0) return;
+    printf("[IMU] amostras/leitura %lu.%lu | barramento us med=%lu max=%lu | cpu ciclos med=%lu max=%lu"
+           " | transbordos %lu falhas %lu | vies %ld/256 LSB guinada %ld cgraus%s\n",
+           (unsigned long) (e->amostras / e->leituras),
+           (unsigned long) (e->amostras * 10u / e->leituras % 10u),
+           (unsigned long) (e->barramento_soma_us / e->leituras),
+           (unsigned long) e->barramento_max_us,
+           (unsigned long) (imu_ciclos_soma / imu_periodos),
+           (unsigned long) imu_ciclos_max,
+           (unsigned long) e->transbordos, (unsigned long) e->falhas,
+           (long) rumo.vies_q8, (long) rumo_guinada_cdeg(&rumo),
+           rumo.calibrado ? "" : " (calibrando)");
+}
+
+// Roda na tarefa do display: só os campos que mudaram viram tráfego no I2C
+static void desenha_status(OledQuadro *q) {
+    static const char *const nomes[] = { "----", "AZUL", "VERM", "AMAR" };
+    char linha[OLED_COLUNAS_TEXTO + 1];
+    uint16_t distancia = HCSR04_SEM_ECO;
+    xQueuePeek(caixa_distancia, &distancia, 0);
+    PERFIL_INICIO(OLED);
+
+    oled_quadro_texto(q, 0, 0, "SEGUIDOR DE COR");
+    snprintf(linha, sizeof(linha), "COR E:%s D:%s", nomes[tela_cor_esq], nomes[tela_cor_dir]);
+    oled_quadro_campo(q, 2, 0, OLED_COLUNAS_TEXTO, linha);
+    snprintf(linha, sizeof(linha), "VEL E:%+4ld%% D:%+4ld%%",
+             (long) (tela_pwm_esq * 100 / 65535), (long) (tela_pwm_dir * 100 / 65535));
+    oled_quadro_campo(q, 4, 0, OLED_COLUNAS_TEXTO, linha);
+    if (distancia == HCSR04_SEM_ECO) {
+        snprintf(linha, sizeof(linha), "DIST ---");
+    } else {
+        snprintf(linha, sizeof(linha), "DIST %u CM", distancia);
+    }
+    oled_quadro_campo(q, 6, 0, OLED_COLUNAS_TEXTO, linha);
+    PERFIL_FIM(OLED);
+}
+
+static bool gravador_pode_apagar(void) {
+    return motores_parados;
+}
 
-        if (maior_cor_agora > prioridade_ativa) {
-            prioridade_ativa = maior_cor_agora;
-            fim_do_bloqueio = tempo_agora + 1500;
-            printf("Prioridade travada em: %d\n", prioridade_ativa);
+// 'z' no USB ou escrita na 0xFF14; sempre no monitor (o callback do BTstack
+// só deixa o pedido)
+static void zera_perfil(void) {
+    perfil_zera();
+    latencia_quadros_init(&latencia_visao);
+#if LATENCIA_ATIVO
+    latencia_zera(&latencia);
+#endif
+    printf("[PERF] zerado\n");
+}
+
+// Comandos do terminal USB: 'd' despeja o gravador de bordo, 'p' imprime o
+// perfil, 'z' zera o perfil (e a latência), 'g' passa o pino do analisador
+// para a próxima zona
+static void atende_usb(void) {
+    static int zona_gpio = -1;
+
+    switch (getchar_timeout_us(0)) {
+    case 'd':
+        registro_voo_despeja();
+        break;
+    case 'p':
+        perfil_relatorio();
+        break;
+    case 'b':
+        boot_relatorio();
+        break;
+    case 'z':
+        zera_perfil();
+        break;
+    case 'g':
+        if (zona_gpio >= 0) perfil_gpio((PerfilZona) zona_gpio, -1);
+        if (++zona_gpio == PERFIL_N_ZONAS) zona_gpio = -1;
+        if (zona_gpio >= 0) {
+            perfil_gpio((PerfilZona) zona_gpio, PERFIL_GPIO_PINO);
+            printf("[PERF] GPIO %d = %s\n", PERFIL_GPIO_PINO, perfil_nome((PerfilZona) zona_gpio));
+        } else {
+            printf("[PERF] GPIO %d desligado\n", PERFIL_GPIO_PINO);
         }
+        break;
+    default:
+        break;
+    }
+}
+
+// Prioridade mais baixa: sobe o CYW43 (BLE e Wi-Fi), imprime as estatísticas
+// e atende os comandos do terminal USB. A carga do firmware do rádio é a parte
+// mais longa da partida e corre aqui, com os sensores e o motor já rodando
+static void tarefa_monitor(void *arg) {
+    TarefaRt *rt = arg;
+    uint32_t relatorios = 0;
+    bool terminal = false;
+
+    if (cyw43_arch_init()) {
+        printf("[BLE] falha ao iniciar o CYW43\n");
+    } else {
+        boot_marca(BOOT_CYW43, time_us_32());
+        ble_robo_init();
+        const TelemetriaConfig cfg = {
+            .lote = TELEMETRIA_LOTE,
+            .intervalo_ms = TELEMETRIA_INTERVALO_MS,
+            .qos = TELEMETRIA_QOS,
+        };
+        // Abaixo do monitor não há nada: a publicação nunca atrasa o controle
+        telemetria_mqtt_inicia(&cfg, tskIDLE_PRIORITY + 1);
+    }
 
-        if (tempo_agora > fim_do_bloqueio) {
-            prioridade_ativa = COR_NENHUMA;
+    for (;;) {
+        tarefa_rt_espera_periodo(rt);
+
+        // Ninguém espera pelo terminal: quando o host abre a porta, o que
+        // saiu antes (cabeçalho da partida) é repetido a partir das marcas
+        bool conectado = stdio_usb_connected();
+        if (conectado && !terminal) {
+            boot_marca(BOOT_USB, time_us_32());
+            printf("--- Seguidor de cor com FreeRTOS ---\n");
+            printf("[MOTOR] PWM %u Hz%s, topo %u\n", MOTOR_PWM_HZ,
+                   MOTOR_FASE_CORRETA ? " (fase correta)" : "", MOTOR_PWM_TOPO);
+            printf("MPU6050: %s\n", !imu_ok ? "ausente (malha aberta)" :
+                                     MODO_RUMO ? "ok, rumo ativo" : "ok, só estima a guinada");
+            printf("ML direcao: arena %d bytes, modo %s\n", ML_DIRECAO_ARENA_BYTES,
+                   MODO_DIRECAO_ML ? "ativo" : "sombra");
+            boot_relatorio();
         }
+        terminal = conectado;
 
-        // Aplica filtro de bloqueio
-        TipoCor cor_esq_final = cor_esq_real;
-        TipoCor cor_dir_final = cor_dir_real;
+        atende_usb();
+        if (ble_robo_zerar_perfil()) zera_perfil();
 
-        if (cor_esq_real < prioridade_ativa) cor_esq_final = COR_NENHUMA;
-        if (cor_dir_real < prioridade_ativa) cor_dir_final = COR_NENHUMA;
+        tarefas_rt_relatorio();
 
-        // Decisão de movimento
-        if (cor_dir_final > cor_esq_final) {
-            spin_right();
+        const MlDirecaoEstatisticas *ml = ml_direcao_estatisticas();
+        if (ml->inferencias > 0) {
+            printf("[ML] ciclos min=%lu med=%lu max=%lu | arena %d bytes | concorda %lu%% | descartes %lu\n",
+                   (unsigned long) ml->ciclos_min,
+                   (unsigned long) (ml->ciclos_soma / ml->inferencias),
+                   (unsigned long) ml->ciclos_max, ML_DIRECAO_ARENA_BYTES,
+                   (unsigned long) (ml_concordancias * 100u / ml->inferencias),
+                   (unsigned long) ml_descartes);
         }
-        else if (cor_esq_final > cor_dir_final) {
-            spin_left();
+        if (leituras_perdidas) {
+            printf("[RT] leituras sem slot livre: %lu\n", (unsigned long) leituras_perdidas);
         }
-        else {
-            run_forward();
+        if (imu_ok) imu_relatorio();
+        exposicao_relatorio(&exposicao_esq, "tcs_esq", PERIODO_MONITOR_MS);
+        exposicao_relatorio(&exposicao_dir, "tcs_dir", PERIODO_MONITOR_MS);
+        mapa_volta_relatorio(&mapa);
+        barramento_relatorio();
+        ble_robo_relatorio();
+        if (latencia_visao.amostras) {
+            printf("[VISAO] camera->rodas n=%lu | atraso acima do min us: min=%lu med=%lu max=%lu"
+                   " | recepcao->rodas max=%lu us\n",
+                   (unsigned long) latencia_visao.amostras, (unsigned long) latencia_visao.atraso_min_us,
+                   (unsigned long) latencia_quadros_media_us(&latencia_visao),
+                   (unsigned long) latencia_visao.atraso_max_us, (unsigned long) latencia_visao.aplicacao_max_us);
         }
+        telemetria_relatorio();
+        registro_voo_relatorio();
+        oled_relatorio();
+#if LATENCIA_ATIVO
+        latencia_relatorio(&latencia);    // acumulada desde o boot ou o último 'z'
+#endif
+        if (++relatorios % 5 == 0) memoria_relatorio();
+
+        tarefa_rt_fim(rt);
+    }
+}
+
+// ================= MAIN =================
+int main() {
+    stdio_init_all();
+    boot_marca(BOOT_MAIN, time_us_32());
+
+    // I2C em modo rápido (400kHz); cada barramento tem uma tarefa dona e os
+    // dispositivos entram por classe (sensores de cor, giroscópio, display)
+    barramento_init(&barramento_0, i2c0, I2C_BAUDRATE, PRIO_BARRAMENTO, "i2c0");
+    barramento_init(&barramento_1, i2c1, I2C_BAUDRATE, PRIO_BARRAMENTO, "i2c1");
+    barramento_registra(&barramento_0, &tcs_dir, "tcs_dir", TCS34725_ADDR,
+                        I2C0_SDA_PIN, I2C0_SCL_PIN, BARRAMENTO_CLASSE_SENSOR, 2);
+    barramento_registra(&barramento_0, &imu, "mpu6050", MPU6050_ENDERECO,
+                        I2C0_SDA_PIN, I2C0_SCL_PIN, BARRAMENTO_CLASSE_CONTROLE, 2);
+    barramento_registra(&barramento_1, &tcs_esq, "tcs_esq", TCS34725_ADDR,
+                        I2C1_SDA_PIN, I2C1_SCL_PIN, BARRAMENTO_CLASSE_SENSOR, 2);
+    barramento_registra(&barramento_1, &tela, "oled", OLED_ENDERECO,
+                        OLED_SDA_PIN, OLED_SCL_PIN, BARRAMENTO_CLASSE_DISPLAY, 2);
+    boot_marca(BOOT_BARRAMENTOS, time_us_32());
+
+    // Cada sensor é lido a cada 2 períodos: integração maior que isso só
+    // devolveria a mesma leitura
+    uint32_t ciclos_teto = 2u * params.periodo_ms * 1000u / EXPOSICAO_CICLO_US;
+    if (exposicao_params.ciclos_max > ciclos_teto) exposicao_params.ciclos_max = (uint16_t) ciclos_teto;
+    exposicao_inicia(&exposicao_esq, &exposicao_params);
+    exposicao_inicia(&exposicao_dir, &exposicao_params);
+    mapa_volta_inicia(&mapa);
+    latencia_quadros_init(&latencia_visao);
+
+    if (!motor_inicia(&motor_rampa)) {
+        printf("[MOTOR] sem timer para a rampa\n");
+    }
+    boot_marca(BOOT_MOTOR, time_us_32());
+    rumo_init(&rumo);
+    imu_ok = mpu6050_init(&imu);
+    boot_marca(BOOT_IMU, time_us_32());
+
+    const OledConfig oled = {
+        .disp = &tela,
+        .periodo_desenho_ms = OLED_PERIODO_MS, .janela_us = OLED_JANELA_US,
+    };
+    if (!oled_inicia(&oled, tskIDLE_PRIORITY + 1, desenha_status)) {
+        printf("OLED: ausente\n");
+    }
+    hcsr04_init(TRIG_PIN, ECHO_PIN);
+    ml_direcao_init();
+    telemetria_init();
+    registro_voo_init(tskIDLE_PRIORITY + 1, gravador_pode_apagar);
+
+    // Filas de ponteiros para os slots e caixas de um elemento
+    fila_livres     = xQueueCreate(N_LEITURAS, sizeof(Leitura *));
+    fila_decisao    = xQueueCreate(N_LEITURAS, sizeof(Leitura *));
+    fila_ml         = xQueueCreate(N_LEITURAS, sizeof(Leitura *));
+    caixa_comando   = xQueueCreate(1, sizeof(Comando));
+    caixa_distancia = xQueueCreate(1, sizeof(uint16_t));
+    for (int i = 0; i < N_LEITURAS; i++) {
+        Leitura *l = &leituras[i];
+        xQueueSend(fila_livres, &l, 0);
+    }
+
+    tarefa_rt_cria(&rt_motor, tarefa_motor, "motor", 384, PRIO_MOTOR,
+                   PERIODO_MOTOR_MS, DEADLINE_MOTOR_US);
+    tarefa_rt_cria(&rt_sensores, tarefa_sensores, "sensores", 384, PRIO_SENSORES,
+                   params.periodo_ms, DEADLINE_SENSORES_US);
+    tarefa_rt_cria(&rt_decisao, tarefa_decisao, "decisao", 384, PRIO_DECISAO,
+                   0, DEADLINE_DECISAO_US);
+    tarefa_rt_cria(&rt_distancia, tarefa_distancia, "distancia", 256, PRIO_DISTANCIA,
+                   PERIODO_DISTANCIA_MS, DEADLINE_DISTANCIA_US);
+    tarefa_rt_cria(&rt_ml, tarefa_ml, "ml", 512, PRIO_ML,
+                   0, DEADLINE_ML_US);
+    tarefa_rt_cria(&rt_monitor, tarefa_monitor, "monitor", 1024, PRIO_MONITOR,
+                   PERIODO_MONITOR_MS, PERIODO_MONITOR_MS * 1000u);
+
+    boot_marca(BOOT_ESCALONADOR, time_us_32());
+    vTaskStartScheduler();
+
+    // Só chega aqui se faltar heap para o escalonador
+    while (true) {
+        tight_loop_contents();
     }
 }
\ No newline at end of file
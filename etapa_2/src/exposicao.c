@@ -0,0 +1,107 @@
+/**
+ * exposicao.c - Plano de ganho/ATIME e normalização das leituras (robô e host)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "exposicao.h"
+
+static const uint8_t ganhos[EXPOSICAO_GANHOS] = { 1, 4, 16, 60 };
+
+// Contagem máxima de um canal: 1024 por ciclo, limitada aos 16 bits
+static uint32_t fundo(uint32_t ciclos) {
+    uint32_t f = 1024u * ciclos;
+    return f > 65535u ? 65535u : f;
+}
+
+static uint16_t limita_ciclos(const ExposicaoParams *p, uint32_t n) {
+    if (n < p->ciclos_min) n = p->ciclos_min;
+    if (n > p->ciclos_max) n = p->ciclos_max;
+    return (uint16_t) n;
+}
+
+void exposicao_inicia(Exposicao *e, const ExposicaoParams *p) {
+    *e = (Exposicao) { .ganho = 1, .ciclos = limita_ciclos(p, 10) };
+}
+
+uint32_t exposicao_ganho(const Exposicao *e) {
+    return ganhos[e->ganho];
+}
+
+uint32_t exposicao_integracao_us(const Exposicao *e) {
+    return (uint32_t) e->ciclos * EXPOSICAO_CICLO_US;
+}
+
+// Do maior ganho para o menor: o primeiro com folga ganha, com o menor número
+// de ciclos que chega a 2 x c_snr. Sem nenhum com folga: 1x e ciclos_min.
+static void planeja(const Exposicao *e, const ExposicaoParams *p, uint32_t c,
+                    uint8_t *ganho, uint16_t *ciclos) {
+    uint64_t exposicao = (uint64_t) ganhos[e->ganho] * e->ciclos;
+    *ganho = 0;
+    *ciclos = p->ciclos_min;
+    for (int g = EXPOSICAO_GANHOS - 1; g >= 0; g--) {
+        uint16_t n = p->ciclos_max;
+        if (c) {
+            uint64_t num = 2u * p->c_snr * exposicao, den = (uint64_t) c * ganhos[g];
+            n = limita_ciclos(p, (uint32_t) ((num + den - 1) / den));
+        }
+        uint64_t previsto = (uint64_t) c * ganhos[g] * n / exposicao;
+        if (previsto * 100u <= (uint64_t) fundo(n) * p->alvo_pct) {
+            *ganho = (uint8_t) g;
+            *ciclos = n;
+            return;
+        }
+    }
+}
+
+ExposicaoLeitura exposicao_processa(Exposicao *e, const ExposicaoParams *p, uint16_t crgb[4]) {
+    uint32_t c = crgb[0], f = fundo(e->ciclos);
+    bool saturada = c * 100u >= f * EXPOSICAO_SATURA_PCT;
+
+    // Escuro ou saturado repetem de verdade: só compara no meio da escala
+    if (c && !saturada && !memcmp(crgb, e->anterior, sizeof e->anterior)) {
+        e->repetidas++;
+        return EXPOSICAO_REPETIDA;
+    }
+    memcpy(e->anterior, crgb, sizeof e->anterior);
+    if (e->descarta) {
+        e->descarta--;
+        e->descartadas++;
+        return EXPOSICAO_DESCARTADA;
+    }
+
+    bool fora = saturada || c < p->c_snr || c * 100u < f * p->baixo_pct || c * 100u > f * p->alto_pct;
+    e->saturadas += saturada;
+
+    uint8_t ganho;
+    uint16_t ciclos;
+    planeja(e, p, saturada ? c * 4u : c, &ganho, &ciclos);
+
+    // Normaliza com a configuração que fez esta leitura, antes de trocar
+    uint32_t exposicao = ganhos[e->ganho] * (uint32_t) e->ciclos;
+    for (int i = 0; i < 4; i++) {
+        crgb[i] = (uint16_t) ((crgb[i] * (uint32_t) EXPOSICAO_REFERENCIA + exposicao / 2u) / exposicao);
+    }
+
+    if ((ganho != e->ganho || ciclos != e->ciclos) && (fora || ciclos < e->ciclos)) {
+        e->ganho = ganho;
+        e->ciclos = ciclos;
+        e->mudou = true;
+        e->descarta = 1;
+        e->ajustes++;
+    }
+    e->novas++;
+    return EXPOSICAO_NOVA;
+}
+
+void exposicao_relatorio(Exposicao *e, const char *nome, uint32_t intervalo_ms) {
+    uint32_t us = exposicao_integracao_us(e);
+    uint32_t taxa = intervalo_ms ? (e->novas - e->novas_relatorio) * 1000u / intervalo_ms : 0;
+    e->novas_relatorio = e->novas;
+    printf("[EXP] %-7s %2lux %3u ciclos (%lu.%lu ms) | %lu leituras/s | repetidas %lu descartadas %lu "
+           "saturadas %lu ajustes %lu\n",
+           nome, (unsigned long) exposicao_ganho(e), e->ciclos,
+           (unsigned long) (us / 1000u), (unsigned long) (us % 1000u / 100u), (unsigned long) taxa,
+           (unsigned long) e->repetidas, (unsigned long) e->descartadas,
+           (unsigned long) e->saturadas, (unsigned long) e->ajustes);
+}
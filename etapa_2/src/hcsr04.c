@@ -0,0 +1,70 @@
+/**
+ * hcsr04.c - Medição do HC-SR04 com captura de bordas por interrupção
+ */
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "hcsr04.h"
+
+static uint trig;
+static uint echo;
+
+static volatile uint32_t subida_us = 0;
+static volatile uint32_t descida_us = 0;
+static TaskHandle_t volatile tarefa_esperando = NULL;
+
+static void echo_irq(void) {
+    uint32_t eventos = gpio_get_irq_event_mask(echo);
+    if (!eventos) return;
+    gpio_acknowledge_irq(echo, eventos);
+
+    uint32_t agora = time_us_32();
+    if (eventos & GPIO_IRQ_EDGE_RISE) {
+        subida_us = agora;
+    }
+    if ((eventos & GPIO_IRQ_EDGE_FALL) && tarefa_esperando) {
+        descida_us = agora;
+        BaseType_t acordou = pdFALSE;
+        vTaskNotifyGiveFromISR(tarefa_esperando, &acordou);
+        tarefa_esperando = NULL;
+        portYIELD_FROM_ISR(acordou);
+    }
+}
+
+void hcsr04_init(uint trig_pin, uint echo_pin) {
+    trig = trig_pin;
+    echo = echo_pin;
+
+    gpio_init(trig);
+    gpio_set_dir(trig, GPIO_OUT);
+    gpio_put(trig, 0);
+    gpio_init(echo);
+    gpio_set_dir(echo, GPIO_IN);
+
+    gpio_add_raw_irq_handler(echo, echo_irq);
+    gpio_set_irq_enabled(echo, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+uint16_t hcsr04_mede_cm(uint32_t timeout_ms) {
+    ulTaskNotifyTake(pdTRUE, 0);           // descarta notificação antiga
+    subida_us = 0;
+    tarefa_esperando = xTaskGetCurrentTaskHandle();
+
+    // Pulso de disparo de 10 us
+    gpio_put(trig, 1);
+    busy_wait_us_32(10);
+    gpio_put(trig, 0);
+
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0 || subida_us == 0) {
+        tarefa_esperando = NULL;
+        return HCSR04_SEM_ECO;
+    }
+
+    // Datasheet: distância (cm) = largura do eco (us) / 58
+    uint32_t cm = (descida_us - subida_us) / 58u;
+    return cm < HCSR04_SEM_ECO ? (uint16_t) cm : HCSR04_SEM_ECO;
+}
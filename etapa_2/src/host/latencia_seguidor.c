@@ -0,0 +1,300 @@
+/**
+ * latencia_seguidor.c - Latência da cor sob o sensor até o PWM, sem hardware
+ *
+ * Simula o mesmo caminho do robô em tempo de eventos (us):
+ *   - TCS34725 com ciclo RGBC livre (fase aleatória por sensor); o registro
+ *     tem a última integração completa, e uma integração que pegou a cor
+ *     só em parte dá a mistura das assinaturas (mais ruído);
+ *   - tarefa dos sensores no período de SeguidorParams, alternando os lados,
+ *     com espera pelo barramento e a transação RGBC;
+ *   - classificação e decisão com o código do robô (src/seguidor.c);
+ *   - tarefa do motor a cada 10 ms, que lê a caixa de comando depois da
+ *     rajada do giroscópio e muda o alvo das rodas;
+ *   - rampa do motor (motor.h) a cada MOTOR_RAMPA_US, com fase sorteada. A
+ *     marca PWM é o primeiro tique com as duas rodas no sentido do comando,
+ *     como motor_no_sentido() no robô: numa inversão a roda de dentro passa
+ *     pelo zero antes (6 a 7 ms com os padrões).
+ * Cada ensaio sorteia as fases e o instante em que a cor aparece sob um
+ * sensor (o carrinho vinha reto, sem faixa), e anota as mesmas marcas que o
+ * robô anota com -DLATENCIA=ON (latencia.h). O trecho cor->pwm vai até a
+ * roda no sentido da direção nova. Os custos por etapa têm padrões medidos
+ * no robô ([PERF] e [I2C]) e podem ser trocados na linha de comando.
+ * O ruído por canal é menor que o da varredura (2%): com 5% o fundo às vezes
+ * vira vermelho, a trava segura e o ensaio mede a trava, não o caminho.
+ *
+ * Com --limite-p99 o programa sai com 1 se o p99 de cor->pwm passar do
+ * limite: serve de teste de regressão de latência sem o robô.
+ *
+ * Compilação (a partir desta pasta):
+ *   gcc -std=gnu11 -O2 -I../../inc -o latencia_seguidor latencia_seguidor.c ../seguidor.c ../latencia.c
+ *
+ * Uso:
+ *   ./latencia_seguidor
+ *   ./latencia_seguidor --ensaios 50000 --periodo 20 --limite-p99 80000
+ *   ./latencia_seguidor --cor vermelha --lado dir --espera-max 1000
+ *   ./latencia_seguidor --rampa 65535          sem rampa (comando em degrau)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "latencia.h"
+#include "motor.h"
+#include "seguidor.h"
+
+// --- TEMPOS DO ROBÔ (padrões; carrinho_seguidor_cor.c e [PERF]/[I2C]) ---
+#define PERIODO_MOTOR_US   10000
+#define INTEGRACAO_US      24000      // ATIME 0xF6: 10 x 2.4 ms
+#define CICLO_TCS_US       26400      // + 2.4 ms de inicialização por ciclo RGBC
+#define TRANSACAO_I2C_US   250        // comando + 8 bytes com repeated start a 400 kHz
+#define ESPERA_MAX_US      300        // pedido à frente no barramento (FIFO do MPU6050)
+#define CLASSIFICA_US      10
+#define DECISAO_US         60         // fila até a tarefa de decisão + regra
+#define MOTOR_US           350        // da liberação do motor até ler a caixa (giroscópio)
+
+#define AQUECIMENTO_US     200000     // antes da cor: estado estável, andando reto
+#define HORIZONTE_US       1000000    // depois da cor: desiste
+
+typedef struct {
+    uint32_t periodo_sensor_us;
+    uint32_t ciclo_tcs_us;
+    uint32_t espera_max_us;
+    uint32_t classifica_us;
+    uint32_t decisao_us;
+    uint32_t motor_us;
+    double ruido;                     // desvio relativo por canal
+    TipoCor cor;
+    int lado;                         // 0 = esquerdo, 1 = direito, 2 = sorteado
+    MotorRampa rampa;
+} Cenario;
+
+// Média rgbc por cor (mesmas assinaturas de fábrica da varredura)
+static const double assinatura[4][4] = {
+    { 0.36 * 900, 0.34 * 900, 0.30 * 900, 900 },     // nenhuma (chão)
+    { 0.20 * 300, 0.30 * 300, 0.50 * 300, 300 },     // azul
+    { 0.60 * 350, 0.20 * 350, 0.20 * 350, 350 },     // vermelha
+    { 0.45 * 700, 0.40 * 700, 0.15 * 700, 700 },     // amarela
+};
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static uint32_t sorteia(uint32_t *s, uint32_t n) {
+    return n ? xorshift(s) % n : 0;
+}
+
+static double gauss(uint32_t *s) {
+    double u = 0;
+    for (int i = 0; i < 4; i++) u += (xorshift(s) >> 8) * (1.0 / 16777216.0);
+    return (u - 2.0) * 1.7320508;
+}
+
+// Leitura feita em 't': a última integração completa antes dele, misturando
+// fundo e cor pela fração da janela que já via a cor
+static TipoCor le_tcs(const SeguidorParams *p, const Cenario *c, uint32_t fase_tcs, bool com_cor,
+                      uint32_t t_cor, uint32_t t, uint32_t *rng) {
+    uint32_t fim = t < fase_tcs ? 0 : fase_tcs + (t - fase_tcs) / c->ciclo_tcs_us * c->ciclo_tcs_us;
+    double f = 0;
+    if (com_cor && fim > t_cor) {
+        f = (double) (fim - t_cor) / INTEGRACAO_US;
+        if (f > 1) f = 1;
+    }
+    uint16_t v[4];
+    for (int k = 0; k < 4; k++) {
+        double m = (1 - f) * assinatura[COR_NENHUMA][k] + f * assinatura[c->cor][k];
+        double x = m * (1 + c->ruido * gauss(rng));
+        v[k] = (uint16_t) (x < 0 ? 0 : x > 65535 ? 65535 : x);
+    }
+    return seguidor_identifica_cor(p, v[0], v[1], v[2], v[3]);
+}
+
+typedef struct {
+    MlDirecao direcao;
+    uint32_t captura_us;
+    LatenciaMarcas marcas;
+} Comando;
+
+// Alvo das rodas para a direção (mesmos sentidos de rumo_malha_aberta)
+static void alvo_rodas(const SeguidorParams *p, MlDirecao d, int32_t alvo[2]) {
+    if (d == ML_DIRECAO_DIREITA)       { alvo[0] = p->base_speed;  alvo[1] = -p->spin_speed; }
+    else if (d == ML_DIRECAO_ESQUERDA) { alvo[0] = -p->base_speed; alvo[1] = p->spin_speed; }
+    else                               { alvo[0] = alvo[1] = p->base_speed; }
+}
+
+// Tiques da rampa antes de 'ate'
+static void anda_rampa(const MotorRampa *r, int32_t roda[2], const int32_t alvo[2], uint32_t *tique,
+                       uint32_t ate) {
+    for (; *tique < ate; *tique += MOTOR_RAMPA_US) {
+        for (int i = 0; i < 2; i++) roda[i] = motor_rampa_passo(roda[i], alvo[i], r->passo[i]);
+    }
+}
+
+// Primeiro tique a partir de 'tique' com as duas rodas no sentido do alvo
+static uint32_t no_sentido(const MotorRampa *r, const int32_t roda[2], const int32_t alvo[2], uint32_t tique) {
+    int32_t v[2] = { roda[0], roda[1] };
+    for (;; tique += MOTOR_RAMPA_US) {
+        for (int i = 0; i < 2; i++) v[i] = motor_rampa_passo(v[i], alvo[i], r->passo[i]);
+        if (motor_mesmo_sentido(v[0], alvo[0]) && motor_mesmo_sentido(v[1], alvo[1])) return tique;
+    }
+}
+
+// Um ensaio; devolve false se a direção nunca mudou dentro do horizonte
+static bool ensaio(const SeguidorParams *p, const Cenario *c, Latencia *lat, uint32_t *rng) {
+    SeguidorEstado estado = { .prioridade_ativa = COR_NENHUMA };
+    TipoCor cor_lado[2] = { COR_NENHUMA, COR_NENHUMA };
+    uint32_t fase_tcs[2] = { sorteia(rng, c->ciclo_tcs_us), sorteia(rng, c->ciclo_tcs_us) };
+    int lado_cor = c->lado == 2 ? (int) sorteia(rng, 2) : c->lado;
+    int lendo = (int) sorteia(rng, 2);
+    uint32_t t_cor = AQUECIMENTO_US + sorteia(rng, c->periodo_sensor_us * 2);
+
+    uint32_t prox_sensor = sorteia(rng, c->periodo_sensor_us);
+    uint32_t prox_motor = sorteia(rng, PERIODO_MOTOR_US);
+    uint32_t prox_tique = sorteia(rng, MOTOR_RAMPA_US);
+
+    // Rodas em regime, andando reto
+    int32_t roda[2], alvo[2];
+    alvo_rodas(p, ML_DIRECAO_RETO, alvo);
+    roda[0] = alvo[0];
+    roda[1] = alvo[1];
+
+    Comando publicado = { .direcao = ML_DIRECAO_RETO }, aplicado = { .direcao = ML_DIRECAO_RETO };
+    bool tem_comando = false, aplicou = false;
+    MlDirecao antes_da_cor = ML_DIRECAO_RETO;
+
+    // Decisão pendente: leitura já feita, comando ainda não publicado
+    Comando pendente;
+    uint32_t publica_em = UINT32_MAX;
+
+    while (prox_motor < t_cor + HORIZONTE_US) {
+        uint32_t le_caixa = prox_motor + c->motor_us;
+
+        // Leituras (e decisões) que terminam antes de o motor olhar a caixa
+        for (;;) {
+            if (publica_em <= le_caixa) {
+                publicado = pendente;
+                tem_comando = true;
+                publica_em = UINT32_MAX;
+                continue;
+            }
+            if (publica_em != UINT32_MAX || prox_sensor > le_caixa) break;
+
+            LatenciaMarcas m = { 0 };
+            uint32_t t_i2c = prox_sensor + sorteia(rng, c->espera_max_us + 1) + TRANSACAO_I2C_US;
+            latencia_marca(&m, LATENCIA_I2C, t_i2c);
+            cor_lado[lendo] = le_tcs(p, c, fase_tcs[lendo], lendo == lado_cor, t_cor, t_i2c, rng);
+            uint32_t t_cls = t_i2c + c->classifica_us;
+            latencia_marca(&m, LATENCIA_CLASSIFICA, t_cls);
+            lendo ^= 1;
+            prox_sensor += c->periodo_sensor_us;
+
+            uint32_t t_dec = t_cls + c->decisao_us;
+            pendente.direcao = seguidor_decide(p, &estado, cor_lado[0], cor_lado[1], t_dec / 1000);
+            pendente.captura_us = t_cls;
+            pendente.marcas = m;
+            latencia_marca(&pendente.marcas, LATENCIA_DECISAO, t_dec);
+            publica_em = t_dec;
+        }
+
+        if (tem_comando && (!aplicou || publicado.captura_us != aplicado.captura_us)) {
+            aplicado = publicado;
+            aplicou = true;
+            anda_rampa(&c->rampa, roda, alvo, &prox_tique, le_caixa);
+            alvo_rodas(p, aplicado.direcao, alvo);
+            latencia_marca(&aplicado.marcas, LATENCIA_PWM, no_sentido(&c->rampa, roda, alvo, prox_tique));
+            if (le_caixa < t_cor) {
+                antes_da_cor = aplicado.direcao;
+            } else if (aplicado.direcao != antes_da_cor) {
+                latencia_marca(&aplicado.marcas, LATENCIA_COR, t_cor);
+                latencia_amostra(lat, &aplicado.marcas);
+                return true;
+            }
+            // Só conta depois do aquecimento (a fila começa vazia)
+            if (le_caixa >= AQUECIMENTO_US / 2) latencia_amostra(lat, &aplicado.marcas);
+        }
+        prox_motor += PERIODO_MOTOR_US;
+    }
+    return false;
+}
+
+static TipoCor le_cor(const char *s) {
+    if (!strcmp(s, "azul")) return COR_AZUL;
+    if (!strcmp(s, "vermelha")) return COR_VERMELHA;
+    if (!strcmp(s, "amarela")) return COR_AMARELA;
+    return COR_NENHUMA;
+}
+
+int main(int argc, char **argv) {
+    SeguidorParams p = SEGUIDOR_PARAMS_PADRAO;
+    Cenario c = {
+        .ciclo_tcs_us = CICLO_TCS_US,
+        .espera_max_us = ESPERA_MAX_US,
+        .classifica_us = CLASSIFICA_US,
+        .decisao_us = DECISAO_US,
+        .motor_us = MOTOR_US,
+        .ruido = 0.02,
+        .cor = COR_AZUL,
+        .lado = 2,
+        .rampa = MOTOR_RAMPA_PADRAO,
+    };
+    long ensaios = 10000, limite_p99 = 0;
+    uint32_t semente = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i], *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!v && strcmp(a, "-h") != 0) { fprintf(stderr, "%s sem valor\n", a); return 1; }
+        if      (!strcmp(a, "--ensaios"))     ensaios = atol(v);
+        else if (!strcmp(a, "--semente"))     semente = (uint32_t) strtoul(v, NULL, 0);
+        else if (!strcmp(a, "--periodo"))     p.periodo_ms = (uint16_t) atoi(v);
+        else if (!strcmp(a, "--ciclo-tcs"))   c.ciclo_tcs_us = (uint32_t) atol(v);
+        else if (!strcmp(a, "--espera-max"))  c.espera_max_us = (uint32_t) atol(v);
+        else if (!strcmp(a, "--classifica"))  c.classifica_us = (uint32_t) atol(v);
+        else if (!strcmp(a, "--decisao"))     c.decisao_us = (uint32_t) atol(v);
+        else if (!strcmp(a, "--motor"))       c.motor_us = (uint32_t) atol(v);
+        else if (!strcmp(a, "--ruido"))       c.ruido = atof(v) / 100;
+        else if (!strcmp(a, "--cor"))         c.cor = le_cor(v);
+        else if (!strcmp(a, "--lado"))        c.lado = !strcmp(v, "esq") ? 0 : !strcmp(v, "dir") ? 1 : 2;
+        else if (!strcmp(a, "--rampa"))       c.rampa.passo[0] = c.rampa.passo[1] = (uint16_t) atoi(v);
+        else if (!strcmp(a, "--limite-p99"))  limite_p99 = atol(v);
+        else {
+            fprintf(stderr, "uso: %s [--ensaios N] [--semente S] [--periodo ms] [--ciclo-tcs us]\n"
+                            "          [--espera-max us] [--classifica us] [--decisao us] [--motor us] [--ruido %%]\n"
+                            "          [--cor azul|vermelha|amarela] [--lado esq|dir|ambos] [--rampa passo]\n"
+                            "          [--limite-p99 us]\n",
+                    argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (c.cor == COR_NENHUMA || p.periodo_ms == 0 || c.ciclo_tcs_us < INTEGRACAO_US || ensaios <= 0 ||
+        c.rampa.passo[0] == 0 || c.rampa.passo[1] == 0) {
+        fprintf(stderr, "cenario invalido\n");
+        return 1;
+    }
+    c.periodo_sensor_us = (uint32_t) p.periodo_ms * 1000u;
+
+    static Latencia lat;
+    latencia_zera(&lat);
+    uint32_t rng = semente | 1;
+    long sem_mudanca = 0;
+    for (long i = 0; i < ensaios; i++) {
+        if (!ensaio(&p, &c, &lat, &rng)) sem_mudanca++;
+    }
+
+    printf("%ld ensaios: sensores a cada %u ms (cada lado %u ms), ciclo RGBC %u us, motor %d ms\n",
+           ensaios, p.periodo_ms, 2u * p.periodo_ms, c.ciclo_tcs_us, PERIODO_MOTOR_US / 1000);
+    latencia_relatorio(&lat);
+    if (sem_mudanca) printf("sem mudanca de direcao: %ld\n", sem_mudanca);
+
+    if (limite_p99 > 0) {
+        uint32_t p99 = latencia_percentil(&lat.trecho[LATENCIA_COR_PWM], 990);
+        bool ok = sem_mudanca == 0 && p99 <= (uint32_t) limite_p99;
+        printf("%s: p99 cor->pwm %lu us, limite %ld us\n", ok ? "OK" : "FALHA", (unsigned long) p99, limite_p99);
+        return ok ? 0 : 1;
+    }
+    return 0;
+}
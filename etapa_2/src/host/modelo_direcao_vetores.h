@@ -0,0 +1,150 @@
+/**
+ * modelo_direcao_vetores.h - Vetores de referência do modelo de direção
+ *
+ * GERADO por treina_modelo_direcao.py junto com inc/modelo_direcao.h.
+ * Saídas calculadas pela referência inteira em Python (mesma aritmética do
+ * CMSIS-NN); verifica_modelo_direcao.c exige igualdade bit a bit.
+ */
+#ifndef MODELO_DIRECAO_VETORES_H
+#define MODELO_DIRECAO_VETORES_H
+
+#include <stdint.h>
+#include "modelo_direcao.h"
+
+#define MODELO_DIRECAO_N_VETORES 64
+
+static const int8_t vetores_entrada[MODELO_DIRECAO_N_VETORES][MODELO_DIRECAO_ENTRADAS] = {
+    {54, 48, 21, 42, 80, 19, 24, 19, 54, 48, 21, 42, 81, 25, 25, 19, 54, 48, 18, 36, 81, 25, 25, 19},
+    {75, 28, 21, 26, 51, 49, 23, 58, 75, 28, 21, 26, 57, 53, 16, 41, 48, 39, 39, 76, 57, 53, 16, 41},
+    {58, 53, 17, 26, 45, 51, 39, 61, 58, 53, 17, 26, 47, 40, 32, 79, 56, 51, 12, 52, 47, 40, 32, 79},
+    {25, 39, 64, 21, 57, 52, 25, 31, 25, 39, 64, 21, 53, 51, 19, 61, 26, 38, 65, 18, 53, 51, 19, 61},
+    {46, 43, 41, 60, 42, 41, 37, 82, 76, 24, 22, 23, 42, 41, 37, 82, 76, 24, 22, 23, 51, 44, 40, 44},
+    {27, 41, 63, 19, 45, 42, 35, 46, 27, 41, 63, 19, 42, 50, 39, 63, 25, 38, 63, 12, 42, 50, 39, 63},
+    {55, 52, 21, 61, 78, 26, 28, 20, 47, 47, 35, 44, 78, 26, 28, 20, 47, 47, 35, 44, 73, 24, 26, 14},
+    {75, 25, 26, 28, 29, 39, 60, 16, 77, 33, 22, 24, 29, 39, 60, 16, 77, 33, 22, 24, 26, 39, 62, 20},
+    {44, 43, 36, 41, 45, 41, 34, 41, 45, 44, 34, 55, 45, 41, 34, 41, 45, 44, 34, 55, 41, 45, 43, 54},
+    {60, 49, 18, 34, 22, 37, 67, 22, 60, 49, 18, 34, 24, 40, 63, 17, 59, 45, 20, 37, 24, 40, 63, 17},
+    {42, 38, 37, 50, 83, 28, 26, 25, 42, 38, 37, 50, 80, 28, 26, 28, 46, 40, 33, 79, 80, 28, 26, 28},
+    {37, 40, 37, 35, 50, 47, 39, 72, 37, 40, 37, 35, 48, 45, 39, 34, 59, 54, 16, 39, 48, 45, 39, 34},
+    {47, 40, 37, 79, 26, 39, 63, 13, 48, 41, 36, 52, 26, 39, 63, 13, 48, 41, 36, 52, 23, 43, 69, 11},
+    {47, 38, 27, 75, 25, 33, 64, 14, 41, 44, 38, 39, 25, 33, 64, 14, 41, 44, 38, 39, 26, 39, 70, 21},
+    {45, 39, 35, 63, 56, 50, 20, 34, 45, 39, 35, 63, 52, 59, 20, 45, 44, 38, 35, 52, 52, 59, 20, 45},
+    {28, 40, 65, 19, 47, 46, 35, 73, 28, 40, 65, 19, 52, 43, 39, 53, 29, 34, 61, 13, 52, 43, 39, 53},
+    {61, 49, 20, 55, 43, 43, 39, 38, 55, 48, 16, 39, 43, 43, 39, 38, 55, 48, 16, 39, 48, 41, 36, 67},
+    {46, 40, 37, 39, 51, 52, 17, 45, 43, 47, 38, 79, 51, 52, 17, 45, 43, 47, 38, 79, 75, 25, 23, 16},
+    {26, 44, 61, 15, 56, 51, 20, 54, 48, 38, 42, 50, 56, 51, 20, 54, 48, 38, 42, 50, 61, 51, 22, 37},
+    {44, 45, 38, 76, 81, 21, 26, 27, 44, 45, 38, 76, 74, 21, 22, 28, 40, 35, 32, 82, 74, 21, 22, 28},
+    {52, 49, 18, 62, 54, 50, 17, 32, 46, 47, 36, 44, 54, 50, 17, 32, 46, 47, 36, 44, 58, 48, 16, 46},
+    {78, 27, 18, 19, 83, 22, 21, 27, 75, 24, 26, 21, 83, 22, 21, 27, 75, 24, 26, 21, 76, 26, 24, 22},
+    {84, 20, 25, 24, 21, 40, 61, 27, 76, 27, 23, 20, 21, 40, 61, 27, 76, 27, 23, 20, 21, 34, 63, 17},
+    {28, 36, 61, 15, 77, 26, 25, 16, 28, 36, 61, 15, 73, 26, 21, 21, 26, 40, 63, 24, 73, 26, 21, 21},
+    {74, 24, 25, 28, 76, 24, 28, 13, 74, 24, 25, 28, 78, 23, 30, 14, 56, 51, 28, 52, 78, 23, 30, 14},
+    {49, 37, 33, 56, 42, 40, 36, 65, 49, 37, 33, 56, 47, 42, 42, 51, 48, 48, 34, 73, 47, 42, 42, 51},
+    {24, 39, 65, 23, 58, 53, 19, 64, 20, 33, 61, 28, 58, 53, 19, 64, 20, 33, 61, 28, 56, 46, 19, 56},
+    {43, 42, 33, 48, 50, 49, 20, 51, 50, 44, 38, 78, 50, 49, 20, 51, 50, 44, 38, 78, 57, 47, 19, 42},
+    {49, 45, 35, 59, 32, 34, 67, 13, 45, 44, 41, 47, 32, 34, 67, 13, 45, 44, 41, 47, 42, 46, 40, 42},
+    {42, 39, 36, 83, 24, 33, 68, 18, 42, 39, 36, 83, 28, 37, 62, 17, 43, 40, 38, 80, 28, 37, 62, 17},
+    {34, 35, 67, 16, 56, 52, 23, 29, 56, 50, 17, 26, 56, 52, 23, 29, 56, 50, 17, 26, 61, 44, 21, 31},
+    {46, 39, 32, 57, 79, 23, 22, 25, 46, 39, 32, 57, 74, 24, 28, 21, 54, 45, 37, 69, 74, 24, 28, 21},
+    {43, 44, 36, 36, 57, 49, 22, 33, 43, 44, 36, 36, 54, 49, 13, 29, 43, 39, 40, 53, 54, 49, 13, 29},
+    {41, 49, 35, 77, 51, 42, 38, 65, 41, 49, 35, 77, 42, 42, 41, 58, 81, 27, 24, 29, 42, 42, 41, 58},
+    {75, 29, 19, 15, 49, 38, 36, 83, 43, 45, 40, 42, 49, 38, 36, 83, 43, 45, 40, 42, 47, 44, 37, 67},
+    {52, 48, 24, 26, 54, 49, 18, 30, 54, 50, 21, 61, 54, 49, 18, 30, 54, 50, 21, 61, 45, 41, 41, 77},
+    {25, 34, 62, 22, 48, 41, 34, 59, 26, 40, 65, 26, 48, 41, 34, 59, 26, 40, 65, 26, 46, 44, 41, 65},
+    {51, 49, 15, 48, 27, 34, 64, 19, 65, 50, 21, 45, 27, 34, 64, 19, 65, 50, 21, 45, 21, 42, 61, 21},
+    {45, 47, 41, 66, 73, 30, 20, 19, 45, 43, 35, 75, 73, 30, 20, 19, 45, 43, 35, 75, 76, 26, 22, 31},
+    {50, 44, 33, 57, 81, 26, 24, 20, 50, 44, 33, 57, 70, 25, 24, 29, 44, 46, 33, 64, 70, 25, 24, 29},
+    {56, 49, 22, 41, 23, 37, 63, 24, 56, 49, 22, 41, 21, 39, 66, 16, 51, 52, 16, 63, 21, 39, 66, 16},
+    {74, 31, 30, 27, 55, 54, 23, 27, 78, 24, 24, 15, 55, 54, 23, 27, 78, 24, 24, 15, 60, 55, 18, 28},
+    {46, 46, 38, 46, 50, 49, 35, 69, 46, 46, 38, 46, 42, 39, 37, 53, 42, 41, 36, 52, 42, 39, 37, 53},
+    {25, 38, 57, 14, 47, 44, 42, 79, 22, 38, 61, 26, 47, 44, 42, 79, 22, 38, 61, 26, 45, 39, 38, 74},
+    {20, 40, 59, 22, 58, 44, 19, 63, 24, 38, 63, 26, 58, 44, 19, 63, 24, 38, 63, 26, 55, 58, 23, 58},
+    {22, 42, 64, 18, 28, 34, 60, 14, 80, 29, 24, 21, 28, 34, 60, 14, 80, 29, 24, 21, 24, 39, 60, 25},
+    {26, 36, 60, 28, 78, 23, 25, 13, 26, 36, 60, 28, 47, 44, 35, 79, 25, 39, 64, 25, 47, 44, 35, 79},
+    {47, 41, 39, 39, 78, 25, 25, 29, 47, 41, 39, 39, 77, 29, 22, 22, 46, 41, 38, 79, 77, 29, 22, 22},
+    {56, 49, 20, 36, 43, 44, 36, 66, 56, 49, 20, 36, 45, 40, 34, 42, 53, 57, 12, 65, 45, 40, 34, 42},
+    {73, 26, 25, 17, 55, 51, 18, 56, 73, 26, 25, 17, 56, 49, 19, 32, 65, 50, 18, 31, 56, 49, 19, 32},
+    {25, 34, 61, 20, 59, 52, 11, 38, 26, 35, 66, 24, 59, 52, 11, 38, 26, 35, 66, 24, 74, 31, 26, 17},
+    {42, 44, 41, 48, 43, 43, 36, 84, 42, 44, 41, 48, 76, 26, 27, 24, 48, 41, 36, 82, 76, 26, 27, 24},
+    {76, 26, 23, 24, 59, 48, 17, 65, 72, 22, 25, 32, 59, 48, 17, 65, 72, 22, 25, 32, 55, 51, 21, 62},
+    {76, 27, 27, 17, 77, 27, 24, 13, 76, 27, 27, 17, 74, 27, 28, 27, 76, 24, 25, 17, 74, 27, 28, 27},
+    {21, 43, 62, 20, 57, 49, 15, 64, 23, 44, 60, 23, 57, 49, 15, 64, 23, 44, 60, 23, 53, 49, 17, 44},
+    {73, 24, 28, 17, 45, 41, 34, 71, 72, 26, 26, 17, 45, 41, 34, 71, 72, 26, 26, 17, 46, 46, 36, 64},
+    {20, 36, 64, 12, 56, 56, 14, 57, 20, 36, 64, 12, 57, 52, 17, 47, 51, 43, 39, 47, 57, 52, 17, 47},
+    {58, 48, 20, 31, 74, 27, 23, 21, 58, 46, 20, 34, 74, 27, 23, 21, 58, 46, 20, 34, 75, 28, 25, 23},
+    {49, 51, 18, 65, 37, 47, 40, 64, 49, 51, 18, 65, 45, 44, 34, 42, 61, 56, 13, 45, 45, 44, 34, 42},
+    {72, 24, 29, 14, 72, 27, 22, 13, 72, 24, 29, 14, 21, 33, 64, 11, 74, 25, 25, 25, 21, 33, 64, 11},
+    {56, 51, 14, 53, 72, 26, 22, 20, 56, 51, 14, 53, 70, 22, 29, 17, 79, 25, 32, 27, 70, 22, 29, 17},
+    {59, 50, 16, 55, 44, 44, 42, 38, 59, 50, 16, 55, 49, 45, 38, 63, 59, 50, 17, 47, 49, 45, 38, 63},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127},
+};
+
+static const int8_t vetores_saida[MODELO_DIRECAO_N_VETORES][MODELO_DIRECAO_CLASSES] = {
+    {-50, 35, -23},
+    {-24, -33, 20},
+    {16, 95, -98},
+    {-46, -40, 38},
+    {35, -22, -23},
+    {-15, 44, -45},
+    {-45, 26, -20},
+    {-38, 33, -30},
+    {31, -25, -25},
+    {-25, 52, -51},
+    {-36, -61, 45},
+    {34, -12, -33},
+    {-44, -37, 33},
+    {-39, -8, 7},
+    {-4, -101, 57},
+    {-25, 54, -43},
+    {1, 83, -84},
+    {-9, -102, 64},
+    {-54, -46, 52},
+    {-59, -40, 46},
+    {32, -49, -16},
+    {22, -2, -53},
+    {-39, 49, -45},
+    {-38, -43, 33},
+    {27, -39, -27},
+    {32, -12, -31},
+    {-70, -30, 52},
+    {7, -95, 48},
+    {-44, -12, 14},
+    {-43, -44, 39},
+    {-41, -44, 37},
+    {-38, -44, 33},
+    {-4, -96, 49},
+    {29, -4, -32},
+    {8, 93, -91},
+    {32, -61, -8},
+    {-24, 45, -40},
+    {-24, 53, -51},
+    {-38, -61, 46},
+    {-39, -31, 23},
+    {-25, 37, -37},
+    {-24, -61, 39},
+    {38, -31, -20},
+    {-6, 44, -49},
+    {-60, -39, 50},
+    {23, -35, -31},
+    {-41, -44, 37},
+    {-31, -63, 43},
+    {10, 81, -85},
+    {-28, -49, 36},
+    {-69, -31, 52},
+    {38, -4, -40},
+    {-22, -49, 35},
+    {36, -45, -29},
+    {-69, -36, 56},
+    {-19, 53, -42},
+    {-75, -20, 47},
+    {-26, 18, -30},
+    {14, 74, -80},
+    {31, -66, -6},
+    {-31, 28, -32},
+    {3, 90, -90},
+    {-3, -25, -14},
+    {73, 50, -100},
+};
+
+#endif
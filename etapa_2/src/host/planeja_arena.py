@@ -0,0 +1,249 @@
+"""
+planeja_arena.py - Dimensiona a arena do TFLM a partir do modelo .tflite
+
+Lê o flatbuffer do modelo (o arquivo .tflite ou o array C que o Edge Impulse
+exporta em tflite-model/), calcula o tempo de vida de cada tensor não
+constante e faz o mesmo planejamento guloso do GreedyMemoryPlanner do TFLM:
+os tensores são ordenados do maior para o menor e cada um vai para o menor
+deslocamento que não colide com outro tensor vivo ao mesmo tempo.
+
+O resultado é um header com o tamanho mínimo da arena:
+
+  ARENA_TFLM_ATIVACOES_BYTES  pico das ativações (saída do planejador)
+  ARENA_TFLM_PERSISTENTE_BYTES estimativa do que o interpretador guarda no
+                              fim da arena (TfLiteEvalTensor, nós, etc.)
+  ARENA_TFLM_BYTES            soma das duas + folga, alinhada a 16
+
+Os buffers de rascunho dos kernels (CMSIS-NN) dependem do kernel e não estão
+no flatbuffer: entram na folga. O valor real aparece em tempo de execução com
+interpreter.arena_used_bytes(); se passar do planejado, aumente --folga.
+
+Uso:
+  python3 planeja_arena.py ../../tflite-model/tflite_learn_5.h -o arena_tflm.h
+  python3 planeja_arena.py modelo.tflite --detalhe
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+ALINHAMENTO = 16
+
+# TensorType do schema do TFLite -> bytes por elemento
+BYTES_TIPO = {0: 4, 1: 2, 2: 4, 3: 1, 4: 8, 6: 1, 7: 2, 8: 8, 9: 1, 10: 8, 15: 4, 16: 2, 17: 1}
+
+# Estimativa da parte persistente por tensor e por operador (TFLM, 32 bits):
+# TfLiteEvalTensor + ponteiros de quantização, NodeAndRegistration + OpData
+PERSISTENTE_POR_TENSOR = 24
+PERSISTENTE_POR_OPERADOR = 80
+PERSISTENTE_FIXO = 256
+
+
+# --- LEITURA DO FLATBUFFER ---
+
+class Tabela:
+    """Acesso mínimo a uma tabela de flatbuffer (só leitura)."""
+
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        self.vtable = vtable
+        self.vtable_len = struct.unpack_from("<H", buf, vtable)[0]
+
+    def _campo(self, indice):
+        off = 4 + 2 * indice
+        if off >= self.vtable_len:
+            return 0
+        return struct.unpack_from("<H", self.buf, self.vtable + off)[0]
+
+    def escalar(self, indice, fmt, padrao=0):
+        off = self._campo(indice)
+        if not off:
+            return padrao
+        return struct.unpack_from("<" + fmt, self.buf, self.pos + off)[0]
+
+    def _indireto(self, indice):
+        off = self._campo(indice)
+        if not off:
+            return None
+        p = self.pos + off
+        return p + struct.unpack_from("<I", self.buf, p)[0]
+
+    def vetor_tabelas(self, indice):
+        p = self._indireto(indice)
+        if p is None:
+            return []
+        n = struct.unpack_from("<I", self.buf, p)[0]
+        itens = []
+        for i in range(n):
+            q = p + 4 + 4 * i
+            itens.append(Tabela(self.buf, q + struct.unpack_from("<I", self.buf, q)[0]))
+        return itens
+
+    def vetor_escalares(self, indice, fmt):
+        p = self._indireto(indice)
+        if p is None:
+            return []
+        n = struct.unpack_from("<I", self.buf, p)[0]
+        return list(struct.unpack_from("<%d%s" % (n, fmt), self.buf, p + 4)) if n else []
+
+    def tamanho_vetor(self, indice):
+        p = self._indireto(indice)
+        return struct.unpack_from("<I", self.buf, p)[0] if p is not None else 0
+
+    def texto(self, indice):
+        p = self._indireto(indice)
+        if p is None:
+            return ""
+        n = struct.unpack_from("<I", self.buf, p)[0]
+        return self.buf[p + 4:p + 4 + n].decode("utf-8", "replace")
+
+
+def carrega_modelo(caminho):
+    """Aceita o .tflite binário ou um .h/.cpp com o array em hexadecimal."""
+    with open(caminho, "rb") as f:
+        dados = f.read()
+    if caminho.endswith((".h", ".cpp", ".cc", ".c")):
+        texto = dados.decode("utf-8", "replace")
+        inicio = texto.find("{", texto.find("[]"))
+        fim = texto.find("}", inicio)
+        if inicio < 0 or fim < 0:
+            sys.exit("Nenhum array de bytes encontrado em %s" % caminho)
+        dados = bytes(int(h, 16) for h in re.findall(r"0x([0-9a-fA-F]{1,2})", texto[inicio:fim]))
+    if len(dados) < 8 or dados[4:8] != b"TFL3":
+        sys.exit("%s não parece um modelo TFLite (identificador TFL3 ausente)" % caminho)
+    return dados
+
+
+# --- PLANEJAMENTO ---
+
+def alinha(n, a=ALINHAMENTO):
+    return (n + a - 1) // a * a
+
+
+def tensores_vivos(buf):
+    """Retorna (lista de (nome, bytes, primeiro, ultimo), n_tensores, n_operadores)."""
+    modelo = Tabela(buf, struct.unpack_from("<I", buf, 0)[0])
+    buffers = modelo.vetor_tabelas(4)
+    subgrafos = modelo.vetor_tabelas(2)
+    if not subgrafos:
+        sys.exit("Modelo sem subgrafos")
+    g = subgrafos[0]
+    tensores = g.vetor_tabelas(0)
+    operadores = g.vetor_tabelas(3)
+    entradas = g.vetor_escalares(1, "i")
+    saidas = g.vetor_escalares(2, "i")
+
+    primeiro = {}
+    ultimo = {}
+    for t in entradas:
+        primeiro[t] = 0
+    for i, op in enumerate(operadores):
+        for t in op.vetor_escalares(1, "i"):
+            if t >= 0:
+                primeiro.setdefault(t, i)
+                ultimo[t] = i
+        for t in op.vetor_escalares(2, "i") + op.vetor_escalares(8, "i"):
+            if t >= 0:
+                primeiro.setdefault(t, i)
+                ultimo[t] = max(ultimo.get(t, i), i)
+    fim = max(len(operadores) - 1, 0)
+    for t in saidas:
+        ultimo[t] = fim
+
+    vivos = []
+    for t, tensor in enumerate(tensores):
+        if t not in primeiro:
+            continue
+        b = tensor.escalar(2, "I")
+        constante = b < len(buffers) and buffers[b].tamanho_vetor(0) > 0
+        if constante or tensor.escalar(5, "B"):
+            continue                        # pesos ficam na flash; variáveis são persistentes
+        elementos = 1
+        for d in tensor.vetor_escalares(0, "i"):
+            elementos *= max(d, 1)
+        tipo = tensor.escalar(1, "b")
+        if tipo not in BYTES_TIPO:
+            sys.exit("Tipo de tensor %d não suportado (%s)" % (tipo, tensor.texto(3)))
+        vivos.append((tensor.texto(3) or "t%d" % t, elementos * BYTES_TIPO[tipo],
+                      primeiro[t], ultimo.get(t, primeiro[t])))
+    return vivos, len(tensores), len(operadores)
+
+
+def planeja(vivos):
+    """Planejador guloso por tamanho (o mesmo critério do TFLM). Retorna (pico, deslocamentos)."""
+    ordem = sorted(range(len(vivos)), key=lambda i: (-vivos[i][1], vivos[i][2]))
+    colocados = []
+    deslocamento = {}
+    for i in ordem:
+        _, tam, ini, fim = vivos[i]
+        tam = alinha(tam)
+        candidato = 0
+        conflitos = sorted((o, o + alinha(vivos[j][1])) for j, o in colocados
+                           if vivos[j][2] <= fim and ini <= vivos[j][3])
+        for a, b in conflitos:
+            if candidato + tam <= a:
+                break
+            candidato = max(candidato, b)
+        deslocamento[i] = candidato
+        colocados.append((i, candidato))
+    pico = max((deslocamento[i] + alinha(vivos[i][1]) for i in deslocamento), default=0)
+    return pico, deslocamento
+
+
+def gera_header(nome_modelo, ativacoes, persistente, total, folga):
+    return """/**
+ * arena_tflm.h - Tamanho da arena do TFLM (gerado por src/host/planeja_arena.py)
+ *
+ * Modelo: %s
+ * NÃO EDITE: o CMake gera este arquivo de novo quando o modelo muda.
+ */
+#ifndef ARENA_TFLM_H
+#define ARENA_TFLM_H
+
+#define ARENA_TFLM_ATIVACOES_BYTES   %d
+#define ARENA_TFLM_PERSISTENTE_BYTES %d
+#define ARENA_TFLM_FOLGA_PCT         %d
+#define ARENA_TFLM_BYTES             %d
+
+#endif
+""" % (nome_modelo, ativacoes, persistente, folga, total)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("modelo", help=".tflite ou .h/.cpp com o array do modelo")
+    ap.add_argument("-o", "--saida", help="header a gerar (sem -o só imprime)")
+    ap.add_argument("--folga", type=int, default=10, help="folga em %% para rascunho dos kernels")
+    ap.add_argument("--detalhe", action="store_true", help="lista o deslocamento de cada tensor")
+    args = ap.parse_args()
+
+    buf = carrega_modelo(args.modelo)
+    vivos, n_tensores, n_operadores = tensores_vivos(buf)
+    ativacoes, deslocamento = planeja(vivos)
+    persistente = (PERSISTENTE_FIXO + PERSISTENTE_POR_TENSOR * n_tensores +
+                   PERSISTENTE_POR_OPERADOR * n_operadores)
+    total = alinha((ativacoes + persistente) * (100 + args.folga) // 100)
+    ingenuo = sum(alinha(v[1]) for v in vivos)
+
+    if args.detalhe:
+        for i in sorted(deslocamento, key=lambda i: deslocamento[i]):
+            nome, tam, ini, fim = vivos[i]
+            print("  %8d  %7d B  ops %3d..%-3d  %s" % (deslocamento[i], tam, ini, fim, nome))
+    print("%s: %d operadores, %d tensores (%d na arena)" %
+          (os.path.basename(args.modelo), n_operadores, n_tensores, len(vivos)))
+    print("Ativações: %d bytes (sem reuso seriam %d)" % (ativacoes, ingenuo))
+    print("Persistente (estimado): %d bytes | arena com %d%% de folga: %d bytes" %
+          (persistente, args.folga, total))
+
+    if args.saida:
+        with open(args.saida, "w", encoding="utf-8") as f:
+            f.write(gera_header(os.path.basename(args.modelo), ativacoes, persistente, total, args.folga))
+        print("Gerado", args.saida)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+"""
+registro_voo_decodifica.py - Converte o despejo do gravador de bordo em CSV
+
+No robô, mande 'd' pelo terminal USB: o monitor imprime as páginas do log
+("REG <hex>", ver inc/registro_voo.h). Salve a saída (ou leia direto da
+porta) e rode este script: ele confere o CRC de cada página, ordena por seq,
+separa as sessões (uma por boot) e decodifica os registros.
+
+Saídas:
+  CSV completo: sessao, seq, t_us, atraso_us, RGBC dos dois sensores, cores,
+                prioridade e movimento (o que o robô viu e decidiu)
+  --replay:     só t_us (desde o início), RGBC esquerdo/direito e a direção, para
+                alimentar o simulador/treino com uma volta real (gera_dados()
+                do treina_modelo_direcao.py)
+
+Uso:
+  python3 registro_voo_decodifica.py despejo.txt --lista
+  python3 registro_voo_decodifica.py despejo.txt -o volta.csv            (última sessão)
+  python3 registro_voo_decodifica.py despejo.txt --sessao 12 --replay volta_replay.csv
+  cat /dev/ttyACM0 | python3 registro_voo_decodifica.py -o volta.csv
+"""
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = 0x5652
+VERSAO = 1
+PAGINA = 256
+CABECALHO = struct.Struct("<HBBIHHIHH")
+
+MOVIMENTOS = ["reto", "esquerda", "direita", "?"]
+
+COLUNAS = ["sessao", "seq", "t_us", "atraso_us",
+           "esq_r", "esq_g", "esq_b", "esq_c", "dir_r", "dir_g", "dir_b", "dir_c",
+           "cor_esq", "cor_dir", "prioridade", "movimento"]
+
+
+def crc16(dados):
+    crc = 0xFFFF
+    for b in dados:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def le_varint(dados, i):
+    v = desloc = 0
+    while True:
+        b = dados[i]
+        i += 1
+        v |= (b & 0x7F) << desloc
+        desloc += 7
+        if not b & 0x80:
+            return v, i
+
+
+def decodifica_pagina(pagina):
+    """Devolve (cabeçalho dict, lista de registros) ou None se inválida."""
+    if len(pagina) != PAGINA:
+        return None
+    magic, versao, n, seq, sessao, usados, t_base, descartados, crc = CABECALHO.unpack_from(pagina)
+    if magic != MAGIC or versao != VERSAO or not CABECALHO.size <= usados <= PAGINA:
+        return None
+    copia = bytearray(pagina[:usados])
+    copia[18:20] = b"\0\0"
+    if crc16(copia) != crc:
+        return None
+
+    registros = []
+    i = CABECALHO.size
+    t = t_base
+    rgbc = [0] * 8
+    for _ in range(n):
+        estado = pagina[i]
+        i += 1
+        dt, i = le_varint(pagina, i)
+        atraso, i = le_varint(pagina, i)
+        t = (t + dt) & 0xFFFFFFFF
+        for k in range(8):
+            z, i = le_varint(pagina, i)
+            rgbc[k] += (z >> 1) ^ -(z & 1)          # zigzag
+        registros.append({
+            "sessao": sessao, "seq": seq, "t_us": t, "atraso_us": atraso,
+            "esq_r": rgbc[0], "esq_g": rgbc[1], "esq_b": rgbc[2], "esq_c": rgbc[3],
+            "dir_r": rgbc[4], "dir_g": rgbc[5], "dir_b": rgbc[6], "dir_c": rgbc[7],
+            "cor_esq": estado & 3, "cor_dir": (estado >> 2) & 3,
+            "prioridade": (estado >> 4) & 3, "movimento": (estado >> 6) & 3,
+        })
+    if i != usados:
+        return None
+    cab = {"seq": seq, "sessao": sessao, "n": n, "descartados": descartados}
+    return cab, registros
+
+
+def paginas(linhas):
+    for linha in linhas:
+        linha = linha.strip()
+        if not linha.startswith("REG ") or linha.startswith(("REG INICIO", "REG FIM")):
+            continue
+        try:
+            yield bytes.fromhex(linha[4:])
+        except ValueError:
+            yield b""
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("despejo", nargs="?", help="log serial com as linhas REG (padrão: entrada)")
+    ap.add_argument("--sessao", type=int, help="sessão a exportar (padrão: a mais recente)")
+    ap.add_argument("--todas", action="store_true", help="exporta todas as sessões")
+    ap.add_argument("--lista", action="store_true", help="só lista as sessões")
+    ap.add_argument("-o", "--saida", help="CSV completo (padrão: saída padrão)")
+    ap.add_argument("--replay", help="CSV de replay (t_us, RGBC, direcao)")
+    args = ap.parse_args()
+
+    entrada = open(args.despejo) if args.despejo else sys.stdin
+    invalidas = 0
+    por_seq = {}
+    for pagina in paginas(entrada):
+        r = decodifica_pagina(pagina)
+        if r is None:
+            invalidas += 1
+            continue
+        por_seq[r[0]["seq"]] = r                   # repetidas no despejo: tanto faz
+
+    # Sessões na ordem do log (seq), com buracos de seq e descartes do robô
+    sessoes = {}
+    anterior = None
+    for seq in sorted(por_seq):
+        cab, registros = por_seq[seq]
+        s = sessoes.setdefault(cab["sessao"], {"paginas": 0, "registros": [], "buracos": 0, "descartados": 0})
+        if anterior is not None and anterior[1] == cab["sessao"] and seq != anterior[0] + 1:
+            s["buracos"] += seq - anterior[0] - 1
+        s["paginas"] += 1
+        s["registros"].extend(registros)
+        s["descartados"] = max(s["descartados"], cab["descartados"])
+        anterior = (seq, cab["sessao"])
+
+    if not sessoes:
+        print("nenhuma pagina valida (%d invalidas)" % invalidas, file=sys.stderr)
+        return 1
+
+    for num, s in sessoes.items():
+        regs = s["registros"]
+        dur = ((regs[-1]["t_us"] - regs[0]["t_us"]) & 0xFFFFFFFF) / 1e6 if regs else 0
+        print("sessao %5d: %4d paginas %6d registros %7.1f s | paginas faltando %d | descartados no robo %d" %
+              (num, s["paginas"], len(regs), dur, s["buracos"], s["descartados"]), file=sys.stderr)
+    if invalidas:
+        print("%d paginas invalidas (CRC ou formato)" % invalidas, file=sys.stderr)
+    if args.lista:
+        return 0
+
+    if args.todas:
+        escolhidas = list(sessoes)
+    else:
+        escolhida = args.sessao if args.sessao is not None else anterior[1]
+        if escolhida not in sessoes:
+            print("sessao %d nao esta no despejo" % escolhida, file=sys.stderr)
+            return 1
+        escolhidas = [escolhida]
+    registros = [r for num in escolhidas for r in sessoes[num]["registros"]]
+
+    saida = open(args.saida, "w", newline="") if args.saida else sys.stdout
+    w = csv.DictWriter(saida, fieldnames=COLUNAS)
+    w.writeheader()
+    w.writerows(registros)
+    if args.saida:
+        saida.close()
+
+    if args.replay:
+        with open(args.replay, "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["t_us", "esq_r", "esq_g", "esq_b", "esq_c", "dir_r", "dir_g", "dir_b", "dir_c", "direcao"])
+            t = 0
+            for i, r in enumerate(registros):
+                if i:                                # relativo ao início, sem a volta dos 32 bits
+                    t += (r["t_us"] - registros[i - 1]["t_us"]) & 0xFFFFFFFF
+                w.writerow([t, r["esq_r"], r["esq_g"], r["esq_b"], r["esq_c"],
+                            r["dir_r"], r["dir_g"], r["dir_b"], r["dir_c"], MOVIMENTOS[r["movimento"]]])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,165 @@
+"""
+relatorio_memoria.py - Relatório de RAM do .elf (RP2040, 264 KB)
+
+Roda depois do link (o CMake chama com o .elf do alvo) e mostra como a RAM
+foi dividida:
+  - seções estáticas (.data, .bss, .uninitialized_data, scratch_x/y...)
+  - arenas (buffers marcados com MEMORIA_ARENA, em .uninitialized_data)
+  - heap do FreeRTOS (ucHeap do heap_4) e heap da newlib (.heap)
+  - pilhas dos núcleos (scratch_x/scratch_y)
+  - maiores símbolos em RAM
+
+As pilhas das tarefas do FreeRTOS saem do ucHeap e só existem em tempo de
+execução: com --serial, as linhas "[MEM] ..." impressas por memoria_relatorio()
+(capturadas do USB) entram no relatório com as marcas d'água de cada tarefa.
+
+Uso:
+  python3 relatorio_memoria.py build/tinyml_gate.elf
+  python3 relatorio_memoria.py build/tinyml_gate.elf --serial captura.txt -o memoria.txt
+"""
+import argparse
+import re
+import struct
+import sys
+
+RAM_INICIO = 0x20000000
+RAM_TOTAL = 264 * 1024
+
+SHF_ALLOC = 0x2
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+STT_OBJECT = 1
+
+
+# --- LEITURA DO ELF (32 bits, little endian) ---
+
+def le_elf(caminho):
+    with open(caminho, "rb") as f:
+        d = f.read()
+    if d[:4] != b"\x7fELF" or d[4] != 1 or d[5] != 1:
+        sys.exit("%s não é um ELF32 little endian" % caminho)
+    shoff, = struct.unpack_from("<I", d, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", d, 0x2E)
+
+    secoes = []
+    for i in range(shnum):
+        nome, tipo, flags, addr, off, tam, link, _, _, entsize = struct.unpack_from(
+            "<10I", d, shoff + i * shentsize)
+        secoes.append({"nome_off": nome, "tipo": tipo, "flags": flags, "addr": addr,
+                       "off": off, "tam": tam, "link": link, "entsize": entsize})
+    tab = secoes[shstrndx]
+    for s in secoes:
+        s["nome"] = _texto(d, tab["off"] + s["nome_off"])
+
+    simbolos = []
+    for s in secoes:
+        if s["tipo"] != SHT_SYMTAB:
+            continue
+        strtab = secoes[s["link"]]
+        for i in range(s["tam"] // 16):
+            nome, valor, tam, info, _, shndx = struct.unpack_from("<IIIBBH", d, s["off"] + i * 16)
+            if info & 0xF != STT_OBJECT or tam == 0 or shndx >= len(secoes):
+                continue
+            simbolos.append({"nome": _texto(d, strtab["off"] + nome), "addr": valor,
+                             "tam": tam, "secao": secoes[shndx]["nome"]})
+    return secoes, simbolos
+
+
+def _texto(d, pos):
+    return d[pos:d.index(b"\0", pos)].decode("utf-8", "replace")
+
+
+def na_ram(addr):
+    return RAM_INICIO <= addr < RAM_INICIO + RAM_TOTAL
+
+
+# --- RELATÓRIO ---
+
+def le_serial(caminho):
+    """Linhas '[MEM] chave a=1 b=2' -> lista de (chave, {a: '1', ...})."""
+    itens = []
+    with open(caminho, encoding="utf-8", errors="replace") as f:
+        for linha in f:
+            m = re.search(r"\[MEM\] (\w+) (.*)", linha)
+            if m:
+                itens.append((m.group(1), dict(re.findall(r"(\w+)=(\S+)", m.group(2)))))
+    return itens
+
+
+def kb(n):
+    return "%8d B %7.1f KB" % (n, n / 1024)
+
+
+def relatorio(caminho, serial, n_maiores):
+    secoes, simbolos = le_elf(caminho)
+    ram = [s for s in secoes if s["flags"] & SHF_ALLOC and s["tam"] and na_ram(s["addr"])]
+    simb_ram = [s for s in simbolos if na_ram(s["addr"])]
+    linhas = []
+    w = linhas.append
+
+    w("RAM de %s (%d KB)" % (caminho, RAM_TOTAL // 1024))
+    w("")
+    w("Seções")
+    usado = 0
+    for s in sorted(ram, key=lambda s: s["addr"]):
+        w("  %-24s 0x%08x %s%s" % (s["nome"], s["addr"], kb(s["tam"]),
+                                   "" if s["tipo"] == SHT_NOBITS else "  (copiada da flash)"))
+        usado += s["tam"]
+    w("  %-24s %10s %s  (%.1f%%)" % ("total", "", kb(usado), 100.0 * usado / RAM_TOTAL))
+    w("  %-24s %10s %s" % ("livre", "", kb(RAM_TOTAL - usado)))
+
+    arenas = [s for s in simb_ram if s["secao"].startswith(".uninitialized_data")]
+    heap_rtos = [s for s in simb_ram if s["nome"] == "ucHeap"]
+    heap_newlib = sum(s["tam"] for s in ram if s["nome"] == ".heap")
+    pilhas = sum(s["tam"] for s in ram if s["nome"] in (".stack_dummy", ".stack1_dummy"))
+    heaps = sum(s["tam"] for s in heap_rtos) + heap_newlib
+    estatica = usado - heaps - pilhas - sum(s["tam"] for s in arenas)
+
+    w("")
+    w("Divisão")
+    w("  %-24s %s" % ("estática (.data/.bss)", kb(estatica)))
+    for a in arenas:
+        w("  %-24s %s" % (a["nome"], kb(a["tam"])))
+    for h in heap_rtos:
+        w("  %-24s %s" % ("heap FreeRTOS (ucHeap)", kb(h["tam"])))
+    w("  %-24s %s" % ("heap newlib (.heap)", kb(heap_newlib)))
+    w("  %-24s %s" % ("pilhas dos núcleos", kb(pilhas)))
+
+    w("")
+    w("Maiores símbolos em RAM")
+    for s in sorted(simb_ram, key=lambda s: -s["tam"])[:n_maiores]:
+        w("  %-40s %-20s %s" % (s["nome"][:40], s["secao"][:20], kb(s["tam"])))
+
+    if serial:
+        w("")
+        w("Em execução (memoria_relatorio)")
+        for chave, v in le_serial(serial):
+            if chave == "heap_newlib":
+                w("  heap newlib: pico %s B de %s B" % (v.get("pico"), v.get("limite")))
+            elif chave == "heap_freertos":
+                total = int(v.get("total", 0))
+                minimo = int(v.get("livre_min", 0))
+                w("  heap FreeRTOS: pico %d B de %d B (mínimo livre %d B)" % (total - minimo, total, minimo))
+            elif chave == "pilha":
+                w("  pilha %-16s mínimo livre %s B" % (v.get("tarefa"), v.get("livre_min")))
+    return "\n".join(linhas) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("elf")
+    ap.add_argument("--serial", help="captura do USB com as linhas [MEM] de memoria_relatorio()")
+    ap.add_argument("--maiores", type=int, default=15, help="quantos símbolos listar")
+    ap.add_argument("-o", "--saida", help="grava o relatório também neste arquivo")
+    args = ap.parse_args()
+
+    texto = relatorio(args.elf, args.serial, args.maiores)
+    sys.stdout.write(texto)
+    if args.saida:
+        with open(args.saida, "w", encoding="utf-8") as f:
+            f.write(texto)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,124 @@
+"""
+telemetria_decodifica.py - Decodifica os lotes de telemetria do robô
+
+Lê um lote por linha em hexadecimal (o formato de "mosquitto_sub -F %x") ou
+arquivos .bin, confere a sequência e imprime as amostras e um resumo com a
+vazão, os lotes perdidos no caminho (buraco na seq, possível em QoS 0) e as
+amostras descartadas no anel do robô (campo "perdidas" do cabeçalho).
+
+Formato: ver inc/telemetria.h.
+
+Uso:
+  mosquitto_sub -h localhost -t robo/telemetria -F %x | python3 telemetria_decodifica.py
+  python3 telemetria_decodifica.py /tmp/lotes/*.bin --resumo
+"""
+import argparse
+import struct
+import sys
+import time
+
+MAGIC = 0x4C54
+CABECALHO = struct.Struct("<HBBHHI")
+AMOSTRA = struct.Struct("<HBBHHHH")
+VERSAO = 2
+PWM_DIV = 2                                  # TELEMETRIA_PWM_DIV
+SEM_ECO = 0xFFFF
+
+TIPOS = {1: "sensor", 2: "decisao", 3: "ml", 4: "motor"}
+DIRECOES = {0: "reto", 1: "esquerda", 2: "direita"}
+
+
+def decodifica(lote):
+    if len(lote) < CABECALHO.size:
+        raise ValueError("lote curto (%d bytes)" % len(lote))
+    magic, versao, n, seq, perdidas, t0 = CABECALHO.unpack_from(lote)
+    if magic != MAGIC or versao != VERSAO:
+        raise ValueError("cabeçalho inválido (magic 0x%04x, versão %d)" % (magic, versao))
+    if len(lote) != CABECALHO.size + n * AMOSTRA.size:
+        raise ValueError("tamanho %d não bate com %d amostras" % (len(lote), n))
+    amostras = []
+    for i in range(n):
+        dt, tipo, aux, *v = AMOSTRA.unpack_from(lote, CABECALHO.size + i * AMOSTRA.size)
+        amostras.append((t0 + dt, tipo, aux, v))
+    return seq, perdidas, amostras
+
+
+def s16(x):
+    """Campo com sinal (complemento de 2) de uma amostra."""
+    return x - 0x10000 if x & 0x8000 else x
+
+
+def descreve(t, tipo, aux, v):
+    nome = TIPOS.get(tipo, "tipo%d" % tipo)
+    if tipo == 1:
+        return "%10d %-8s %s cor=%d rgbc=%s" % (t, nome, "dir" if aux & 1 else "esq", aux >> 4, v)
+    if tipo == 2:
+        return "%10d %-8s %-8s v=%s" % (t, nome, DIRECOES.get(aux, aux), v)
+    if tipo == 3:
+        logits = [s16(x) for x in v[:3]]
+        return "%10d %-8s %-8s logits=%s ciclos=%d" % (t, nome, DIRECOES.get(aux, aux), logits, v[3] * 16)
+    if tipo == 4:
+        pwm = [s16(x) * PWM_DIV for x in v[:2]]
+        distancia = "sem eco" if v[3] == SEM_ECO else "%d cm" % v[3]
+        return "%10d %-8s acao=%d pwm=%s motivo=%d distancia=%s" % (t, nome, aux, pwm, v[2], distancia)
+    return "%10d %-8s aux=%d v=%s" % (t, nome, aux, v)
+
+
+def lotes(args):
+    if args.arquivos:
+        for caminho in args.arquivos:
+            with open(caminho, "rb") as f:
+                yield f.read()
+    else:
+        for linha in sys.stdin:
+            linha = linha.strip()
+            if linha:
+                yield bytes.fromhex(linha)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("arquivos", nargs="*", help="lotes .bin (sem arquivos: hex por linha na entrada)")
+    ap.add_argument("--resumo", action="store_true", help="só o resumo, sem as amostras")
+    args = ap.parse_args()
+
+    inicio = time.monotonic()
+    n_lotes = n_amostras = n_bytes = invalidos = 0
+    lotes_perdidos = descartadas = repetidos = 0
+    seq_esperada = None
+    por_tipo = {}
+
+    for lote in lotes(args):
+        try:
+            seq, perdidas, amostras = decodifica(lote)
+        except ValueError as e:
+            invalidos += 1
+            print("[invalido] %s" % e, file=sys.stderr)
+            continue
+        if seq_esperada is not None:
+            salto = (seq - seq_esperada) & 0xFFFF
+            if salto >= 0x8000:
+                repetidos += 1                   # reenvio (QoS 1) ou lote antigo
+                continue
+            lotes_perdidos += salto
+        seq_esperada = (seq + 1) & 0xFFFF
+        n_lotes += 1
+        n_bytes += len(lote)
+        n_amostras += len(amostras)
+        descartadas += perdidas
+        for a in amostras:
+            por_tipo[a[1]] = por_tipo.get(a[1], 0) + 1
+            if not args.resumo:
+                print(descreve(*a))
+
+    duracao = max(time.monotonic() - inicio, 1e-3)
+    print("%d lotes, %d amostras, %d bytes em %.1f s (%.0f amostras/s, %.0f B/s)" %
+          (n_lotes, n_amostras, n_bytes, duracao, n_amostras / duracao, n_bytes / duracao))
+    print("por tipo: %s" % ", ".join("%s=%d" % (TIPOS.get(t, t), c) for t, c in sorted(por_tipo.items())))
+    print("lotes perdidos (seq): %d | repetidos: %d | invalidos: %d | descartadas no anel: %d" %
+          (lotes_perdidos, repetidos, invalidos, descartadas))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
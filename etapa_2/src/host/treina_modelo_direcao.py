@@ -0,0 +1,325 @@
+"""
+treina_modelo_direcao.py - Treina e quantiza (int8) o classificador de direção
+
+Rede densa pequena (entradas -> 16 ReLU -> 3) que recebe as leituras RGBC
+dos dois TCS34725 com uma janela curta de histórico e devolve a classe de
+movimento: RETO, ESQUERDA ou DIREITA (as mesmas decisões de main()).
+
+Sem gravações de pista ainda, o conjunto de treino é sintético: sequências de
+cores sob os sensores, com leituras ruidosas e a mesma leitura alternada
+(esquerdo/direito) do timer do robô; o rótulo é a regra de decisão atual
+(imitação). Quando houver traces gravados, basta trocar gera_dados().
+
+Saídas:
+  ../../inc/modelo_direcao.h          pesos int8, bias int32, multiplicadores
+  modelo_direcao_vetores.h            entradas e saídas de referência para o
+                                      teste bit-exato (verifica_modelo_direcao.c)
+
+A aritmética inteira aqui é a mesma do CMSIS-NN/TFLite (arm_nn_requantize):
+a saída do firmware tem que bater bit a bit com esta referência.
+
+Uso:
+  python3 treina_modelo_direcao.py
+"""
+import os
+
+import numpy as np
+
+AQUI = os.path.dirname(os.path.abspath(__file__))
+SAIDA_MODELO = os.path.join(AQUI, "..", "..", "inc", "modelo_direcao.h")
+SAIDA_VETORES = os.path.join(AQUI, "modelo_direcao_vetores.h")
+
+HISTORICO = 3                # leituras: atual + 2 anteriores
+POR_SENSOR = 4               # r, g, b (cromaticidade) e c (brilho)
+ENTRADAS = HISTORICO * 2 * POR_SENSOR
+OCULTA = 16
+CLASSES = ["RETO", "ESQUERDA", "DIREITA"]
+N_VETORES = 64
+
+# TipoCor: a ordem é a prioridade
+NENHUMA, AZUL, VERMELHA, AMARELA = range(4)
+
+# Cromaticidade r:g:b e brilho (C) típicos sob o sensor, ATIME 0xF6 / ganho 4x
+ASSINATURAS = {
+    NENHUMA:  ((0.36, 0.34, 0.30), 900),
+    AZUL:     ((0.20, 0.30, 0.50), 300),
+    VERMELHA: ((0.60, 0.20, 0.20), 350),
+    AMARELA:  ((0.45, 0.40, 0.15), 700),
+}
+
+
+# --- MESMAS CONTAS DE ml_direcao.c ---
+
+def caracteristicas(r, g, b, c):
+    """RGBC cru -> 4 valores int8 em 0..127."""
+    if c == 0:
+        return [0, 0, 0, 0]
+    return [min(127, (r * 127) // c), min(127, (g * 127) // c),
+            min(127, (b * 127) // c), min(127, c >> 4)]
+
+
+def srdhm(a, b):
+    """Multiplicação alta com arredondamento (arm_nn_doubling_high_mult_no_sat)."""
+    ab = a * b
+    nudge = (1 << 30) if ab >= 0 else 1 - (1 << 30)
+    q = abs(ab + nudge) >> 31
+    return q if ab + nudge >= 0 else -q
+
+
+def rdbpot(x, e):
+    """Divisão por 2^e com arredondamento (arm_nn_divide_by_power_of_two)."""
+    mascara = (1 << e) - 1
+    resto = x & mascara
+    limite = (mascara >> 1) + (1 if x < 0 else 0)
+    return (x >> e) + (1 if resto > limite else 0)
+
+
+def requantiza(acc, mult, shift):
+    return rdbpot(srdhm(acc * (1 << max(shift, 0)), mult), max(-shift, 0))
+
+
+def densa_int8(x, w, b, zp_entrada, mult, shift, zp_saida):
+    saida = []
+    for o in range(w.shape[0]):
+        acc = int(b[o]) + sum((int(xi) - zp_entrada) * int(wi) for xi, wi in zip(x, w[o]))
+        v = requantiza(acc, mult, shift) + zp_saida
+        saida.append(max(-128, min(127, v)))
+    return saida
+
+
+def infere_int8(q, x):
+    h = densa_int8(x, q["w1"], q["b1"], q["zp_in"], q["m1"], q["s1"], q["zp_h"])
+    return densa_int8(h, q["w2"], q["b2"], q["zp_h"], q["m2"], q["s2"], q["zp_o"])
+
+
+# --- DADOS SINTÉTICOS ---
+
+def decisao(esq, dir_):
+    if dir_ > esq:
+        return 2
+    if esq > dir_:
+        return 1
+    return 0
+
+
+def leitura(rng, cor):
+    (cr, cg, cb), brilho = ASSINATURAS[cor]
+    c = max(1.0, brilho * rng.uniform(0.6, 1.5))
+    ruido = rng.normal(0, 0.025, 3)
+    r, g, b = (max(0.0, v + e) * c for v, e in zip((cr, cg, cb), ruido))
+    return int(r), int(g), int(b), int(c)
+
+
+def gera_dados(rng, sequencias=3000, passos=40):
+    X, y = [], []
+    for _ in range(sequencias):
+        esq = dir_ = NENHUMA
+        lida = {0: leitura(rng, NENHUMA), 1: leitura(rng, NENHUMA)}
+        janela = []
+        for passo in range(passos):
+            # A faixa entra e sai debaixo de um sensor de cada vez
+            if rng.random() < 0.15:
+                esq = int(rng.integers(0, 4))
+            if rng.random() < 0.15:
+                dir_ = int(rng.integers(0, 4))
+            # Timer alterna: só um sensor é relido por amostra
+            lado = passo % 2
+            lida[lado] = leitura(rng, esq if lado == 0 else dir_)
+
+            janela.insert(0, caracteristicas(*lida[0]) + caracteristicas(*lida[1]))
+            del janela[HISTORICO:]
+            if len(janela) == HISTORICO:
+                X.append(sum(janela, []))
+                y.append(decisao(esq, dir_))
+    return np.array(X, dtype=np.int32), np.array(y)
+
+
+# --- TREINO (float) ---
+
+def treina(X, y, rng, epocas=60, lr=0.01):
+    x = X.astype(np.float32) / 127.0
+    w1 = rng.normal(0, np.sqrt(2 / ENTRADAS), (OCULTA, ENTRADAS)).astype(np.float32)
+    b1 = np.zeros(OCULTA, np.float32)
+    w2 = rng.normal(0, np.sqrt(2 / OCULTA), (len(CLASSES), OCULTA)).astype(np.float32)
+    b2 = np.zeros(len(CLASSES), np.float32)
+    params = [w1, b1, w2, b2]
+    m = [np.zeros_like(p) for p in params]
+    v = [np.zeros_like(p) for p in params]
+    t = 0
+
+    for epoca in range(epocas):
+        ordem = rng.permutation(len(x))
+        for i in range(0, len(x), 128):
+            idx = ordem[i:i + 128]
+            xb, yb = x[idx], y[idx]
+            h = np.maximum(0, xb @ w1.T + b1)
+            z = h @ w2.T + b2
+            p = np.exp(z - z.max(axis=1, keepdims=True))
+            p /= p.sum(axis=1, keepdims=True)
+            dz = p
+            dz[np.arange(len(yb)), yb] -= 1
+            dz /= len(yb)
+            dh = (dz @ w2) * (h > 0)
+            grads = [dh.T @ xb, dh.sum(0), dz.T @ h, dz.sum(0)]
+            t += 1
+            for k, (prm, g) in enumerate(zip(params, grads)):        # Adam
+                m[k] = 0.9 * m[k] + 0.1 * g
+                v[k] = 0.999 * v[k] + 0.001 * g * g
+                prm -= lr * (m[k] / (1 - 0.9 ** t)) / (np.sqrt(v[k] / (1 - 0.999 ** t)) + 1e-8)
+        if epoca % 20 == 19:
+            acc = np.mean((np.maximum(0, x @ w1.T + b1) @ w2.T + b2).argmax(1) == y)
+            print(f"epoca {epoca + 1}: acerto float {100 * acc:.1f}%")
+    return w1, b1, w2, b2
+
+
+# --- QUANTIZAÇÃO ---
+
+def multiplicador(real):
+    """Real -> (multiplicador Q31, shift) como QuantizeMultiplier do TFLite."""
+    mant, exp = np.frexp(real)
+    q = int(round(mant * (1 << 31)))
+    if q == (1 << 31):
+        q //= 2
+        exp += 1
+    return q, int(exp)
+
+
+def quantiza(w1, b1, w2, b2, X):
+    s_in, zp_in = 1 / 127.0, 0
+    s_w1 = np.abs(w1).max() / 127
+    s_w2 = np.abs(w2).max() / 127
+
+    # Faixas das ativações calibradas nos próprios dados
+    h = np.maximum(0, (X / 127.0) @ w1.T + b1)
+    s_h, zp_h = np.percentile(h, 99.9) / 255, -128
+    z = h @ w2.T + b2
+    zmin, zmax = min(z.min(), 0), max(z.max(), 0)
+    s_o = (zmax - zmin) / 255
+    zp_o = int(round(-128 - zmin / s_o))
+
+    q = {"zp_in": zp_in, "zp_h": zp_h, "zp_o": zp_o, "s_o": s_o}
+    q["w1"] = np.clip(np.round(w1 / s_w1), -127, 127).astype(np.int32)
+    q["b1"] = np.round(b1 / (s_in * s_w1)).astype(np.int64)
+    q["w2"] = np.clip(np.round(w2 / s_w2), -127, 127).astype(np.int32)
+    q["b2"] = np.round(b2 / (s_h * s_w2)).astype(np.int64)
+    q["m1"], q["s1"] = multiplicador(s_in * s_w1 / s_h)
+    q["m2"], q["s2"] = multiplicador(s_h * s_w2 / s_o)
+    return q
+
+
+# --- GERAÇÃO DOS HEADERS ---
+
+def tabela(valores, por_linha=16):
+    v = list(valores)
+    return "\n".join("    " + ", ".join(str(int(x)) for x in v[i:i + por_linha]) + ","
+                     for i in range(0, len(v), por_linha))
+
+
+def escreve_modelo(q, acerto):
+    texto = f"""/**
+ * modelo_direcao.h - Classificador de direção int8 ({ENTRADAS} -> {OCULTA} ReLU -> {len(CLASSES)})
+ *
+ * GERADO por src/host/treina_modelo_direcao.py - NÃO EDITAR À MÃO.
+ * Acerto int8 no conjunto sintético: {100 * acerto:.1f}%
+ *
+ * Pesos por tensor, simétricos (zero point 0), layout [saída][entrada] como
+ * o filtro do arm_fully_connected_s8. Multiplicadores no formato Q31 + shift
+ * (shift > 0 = deslocamento à esquerda).
+ */
+#ifndef MODELO_DIRECAO_H
+#define MODELO_DIRECAO_H
+
+#include <stdint.h>
+
+#define MODELO_DIRECAO_HISTORICO   {HISTORICO}
+#define MODELO_DIRECAO_POR_SENSOR  {POR_SENSOR}
+#define MODELO_DIRECAO_ENTRADAS    {ENTRADAS}
+#define MODELO_DIRECAO_OCULTA      {OCULTA}
+#define MODELO_DIRECAO_CLASSES     {len(CLASSES)}
+
+#define MODELO_DIRECAO_ENTRADA_ZP  {q["zp_in"]}
+#define MODELO_DIRECAO_OCULTA_ZP   ({q["zp_h"]})
+#define MODELO_DIRECAO_SAIDA_ZP    ({q["zp_o"]})
+
+#define MODELO_DIRECAO_OCULTA_MULT  {q["m1"]}
+#define MODELO_DIRECAO_OCULTA_SHIFT ({q["s1"]})
+#define MODELO_DIRECAO_SAIDA_MULT   {q["m2"]}
+#define MODELO_DIRECAO_SAIDA_SHIFT  ({q["s2"]})
+
+static const int8_t modelo_direcao_w1[MODELO_DIRECAO_OCULTA * MODELO_DIRECAO_ENTRADAS] = {{
+{tabela(q["w1"].reshape(-1), ENTRADAS)}
+}};
+
+static const int32_t modelo_direcao_b1[MODELO_DIRECAO_OCULTA] = {{
+{tabela(q["b1"], 8)}
+}};
+
+static const int8_t modelo_direcao_w2[MODELO_DIRECAO_CLASSES * MODELO_DIRECAO_OCULTA] = {{
+{tabela(q["w2"].reshape(-1), OCULTA)}
+}};
+
+static const int32_t modelo_direcao_b2[MODELO_DIRECAO_CLASSES] = {{
+{tabela(q["b2"], 8)}
+}};
+
+#endif
+"""
+    with open(SAIDA_MODELO, "w", encoding="utf-8", newline="\n") as f:
+        f.write(texto)
+
+
+def escreve_vetores(entradas, saidas):
+    texto = f"""/**
+ * modelo_direcao_vetores.h - Vetores de referência do modelo de direção
+ *
+ * GERADO por treina_modelo_direcao.py junto com inc/modelo_direcao.h.
+ * Saídas calculadas pela referência inteira em Python (mesma aritmética do
+ * CMSIS-NN); verifica_modelo_direcao.c exige igualdade bit a bit.
+ */
+#ifndef MODELO_DIRECAO_VETORES_H
+#define MODELO_DIRECAO_VETORES_H
+
+#include <stdint.h>
+#include "modelo_direcao.h"
+
+#define MODELO_DIRECAO_N_VETORES {len(entradas)}
+
+static const int8_t vetores_entrada[MODELO_DIRECAO_N_VETORES][MODELO_DIRECAO_ENTRADAS] = {{
+{chr(10).join("    {" + ", ".join(str(int(v)) for v in e) + "}," for e in entradas)}
+}};
+
+static const int8_t vetores_saida[MODELO_DIRECAO_N_VETORES][MODELO_DIRECAO_CLASSES] = {{
+{chr(10).join("    {" + ", ".join(str(int(v)) for v in s) + "}," for s in saidas)}
+}};
+
+#endif
+"""
+    with open(SAIDA_VETORES, "w", encoding="utf-8", newline="\n") as f:
+        f.write(texto)
+
+
+def main():
+    rng = np.random.default_rng(2025)
+    X, y = gera_dados(rng)
+    print(f"{len(X)} amostras: " + ", ".join(f"{c}={np.sum(y == i)}" for i, c in enumerate(CLASSES)))
+
+    w1, b1, w2, b2 = treina(X, y, rng)
+    q = quantiza(w1, b1, w2, b2, X)
+
+    teste_X, teste_y = gera_dados(np.random.default_rng(7), sequencias=300)
+    previsto = np.array([int(np.argmax(infere_int8(q, x))) for x in teste_X])
+    acerto = float(np.mean(previsto == teste_y))
+    print(f"acerto int8 (teste): {100 * acerto:.1f}%")
+
+    # Vetores de referência: amostras de teste + casos de borda
+    idx = np.random.default_rng(1).choice(len(teste_X), N_VETORES - 2, replace=False)
+    entradas = [list(teste_X[i]) for i in idx] + [[0] * ENTRADAS, [127] * ENTRADAS]
+    saidas = [infere_int8(q, e) for e in entradas]
+
+    escreve_modelo(q, acerto)
+    escreve_vetores(entradas, saidas)
+    print("Gerado:", os.path.normpath(SAIDA_MODELO), "e", os.path.normpath(SAIDA_VETORES))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,808 @@
+/**
+ * varredura_seguidor.c - Varredura de parâmetros do seguidor em pistas simuladas
+ *
+ * Roda a mesma regra do robô (src/seguidor.c: classificação de cor, trava de
+ * prioridade, escolha do movimento) num modelo simples do carrinho: tração
+ * diferencial com zona morta e atraso de primeira ordem nos motores (mais a
+ * rampa e o mapa de alimentação direta de src/motor.c), leitura
+ * alternada dos dois TCS34725 no período configurado e a tarefa do motor
+ * aplicando o último comando a cada 10 ms. Cada combinação de parâmetros
+ * roda em todas as pistas; as combinações são divididas entre threads (uma
+ * por núcleo) e ordenadas por voltas completas, tempo de volta e quantas
+ * vezes o carrinho saiu da faixa.
+ *
+ * Pistas:
+ *   - sintéticas (--pistas N): laço fechado com curvas aleatórias, trechos
+ *     vermelho e amarelo e um desvio azul sem saída em cada bifurcação (a
+ *     trava de prioridade tem que segurar a cor mais alta);
+ *   - de arquivo (--pista arq, em mm):
+ *       p <x> <y> <cor>                  ponto do laço (cor do trecho seguinte)
+ *       r <cor> <x1> <y1> <x2> <y2> ...  ramo aberto (desvio)
+ * Leituras gravadas (--calibra volta.csv, o CSV completo do
+ * registro_voo_decodifica.py) trocam as assinaturas RGBC de fábrica pela
+ * média e o desvio de cada cor medidos na pista de verdade.
+ *
+ * Com --voltas N o carrinho dá N voltas seguidas em cada pista. --memoria
+ * liga a memória da volta (src/mapa_volta.c, a mesma do robô): a primeira
+ * volta é reativa e grava o mapa, as seguintes aceleram nas retas
+ * conhecidas. A tabela mostra a 1a volta e a média das seguintes, e
+ * quantas vezes o mapa divergiu.
+ *
+ * Validação (--valida): antes de confiar na grade, o modelo tem de
+ * reproduzir o robô, e só os parâmetros dele (SEGUIDOR_PARAMS_PADRAO) rodam.
+ *   - --valida sinteticas: os parâmetros do robô têm de fechar todas as
+ *     pistas sintéticas (--pistas N) sem sair da faixa, com a média da volta
+ *     em pelo menos VEL_MIN_FRACAO da velocidade em reta com base_speed.
+ *     É a conferência de sanidade do modelo, roda sem nada do laboratório;
+ *   - --valida <s>: com a pista do laboratório (--pista), as leituras
+ *     gravadas nela (--calibra) e o tempo de volta medido no robô, a saída
+ *     diz se todas as voltas fecharam e o erro do tempo de volta simulado
+ *     contra o medido (dentro de --tolerancia, padrão 20%). As pistas
+ *     sintéticas ficam de fora.
+ * O código de saída é 0 só se a validação passar.
+ *
+ * Estado da validação: com VMAX_MPS em 0,9 (motor TT sem carga a 6 V) os
+ * parâmetros do robô fechavam 0/3 pistas sintéticas, a ~0,05 m/s. Com
+ * 0,5 m/s (com carga, na tensão das pilhas) eles fecham 10/10 pistas
+ * sintéticas sem sair da faixa, com TAU_MOTOR_S de 0,03 a 0,1 s, a
+ * ~0,073 m/s de média (79%) para 0,092 m/s em reta (a oval lisa de 1,8 x 1,1 m
+ * sai a ~0,07 m/s). Em 0,45 e 0,6 m/s uma ou outra pista já se perde na
+ * saída de um trecho prioritário, com a trava ainda segurando a cor mais
+ * alta: o modelo é sensível a VMAX_MPS ali. A pista do laboratório e um
+ * despejo do gravador com voltas inteiras ainda faltam; até --valida <s>
+ * passar com eles, a grade compara combinações entre si e não dá os
+ * valores do robô.
+ *
+ * Compilação (a partir desta pasta):
+ *   gcc -std=gnu11 -O2 -pthread -I../../inc -o varredura_seguidor varredura_seguidor.c ../seguidor.c \
+ *       ../mapa_volta.c ../perfil.c -lm
+ * Com -DPERFIL_ATIVO=1 as zonas do seguidor (classifica, decisao) são
+ * medidas em todas as threads e a tabela [PERF] sai no fim, em ns.
+ *
+ * Uso:
+ *   ./varredura_seguidor                                   grade padrão, 3 pistas sintéticas
+ *   ./varredura_seguidor --base 13000:21000:1000 --trava 800:2000:200 -o grade.csv
+ *   ./varredura_seguidor --pista pista_lab.txt --calibra volta.csv --top 20
+ *   ./varredura_seguidor --rampa 65535                      sem rampa (comando em degrau)
+ *   ./varredura_seguidor --voltas 4 --memoria 1             ganho da memória da volta
+ *   ./varredura_seguidor --valida sinteticas --pistas 10
+ *   ./varredura_seguidor --pista pista_lab.txt --calibra volta.csv --voltas 3 --valida 21.5
+ */
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "seguidor.h"
+#include "perfil.h"
+#include "motor.h"
+#include "mapa_volta.h"
+
+// --- MODELO DO CARRINHO (medidas do chassi, aproximadas) ---
+#define ENTRE_RODAS_M    0.13
+#define SENSOR_FRENTE_M  0.07     // do eixo das rodas até os sensores
+#define SENSOR_LADO_M    0.012    // cada sensor a 12 mm do centro
+#define VMAX_MPS         0.5      // roda com carga e 100% de ciclo útil (sem carga a 6 V: ~0,9)
+#define PWM_MORTO        6000     // ciclo útil (Q16) abaixo do qual o motor não vence o atrito
+#define TAU_MOTOR_S      0.06
+#define PERIODO_MOTOR_US 10000    // tarefa do motor
+#define LARGURA_FAIXA_M  0.019    // fita isolante
+
+// --- SIMULAÇÃO ---
+#define PASSO_US         1000
+_Static_assert(PASSO_US == MOTOR_RAMPA_US, "um passo da simulação = um tique da rampa");
+#define TEMPO_MAX_S      150.0    // por volta
+#define PERDIDO_M        0.05     // mais longe do centro da faixa que isso: saiu
+#define PERDIDO_ABORTA_S 2.0
+#define PENALIDADE_PERDA_S 2.0    // por saída da faixa, na nota
+#define VEL_MIN_FRACAO   0.6      // --valida sinteticas: média da volta / velocidade em reta
+
+// --- PISTA EM GRADE ---
+#define CELULA_M         0.002
+#define RAIO_CARIMBO_M   0.06
+#define MARGEM_M         0.3
+#define MAX_PONTOS       4096
+#define MAX_RAMOS        16
+#define MAX_PISTAS       16
+
+typedef struct {
+    int n;
+    double x[MAX_PONTOS], y[MAX_PONTOS];
+    uint8_t cor[MAX_PONTOS];
+} Polilinha;
+
+typedef struct {
+    char nome[64];
+    double x0, y0;                // canto da grade
+    int w, h;
+    uint8_t *cor;                 // cor pintada na célula
+    uint8_t *dist_mm;             // distância ao centro do laço (255 = longe)
+    uint16_t *progresso_cm;       // posição no laço do ponto mais perto
+    double comprimento_m;
+    double inicio_x, inicio_y, inicio_th;
+    uint32_t semente;
+} Pista;
+
+typedef struct {
+    double media[4][4];           // [cor][r, g, b, c]
+    double desvio[4][4];
+} Assinaturas;
+
+typedef struct {
+    SeguidorParams p;
+    int voltas;
+    double tempo_total_s;         // só das pistas completas
+    double progresso;             // soma das frações de volta
+    int perdas;
+    double nota;
+    double primeira_s;            // 1a volta, somada nas pistas completas
+    double seguintes_s;           // média das outras voltas, somada idem
+    int divergencias;             // do mapa da volta
+} Resultado;
+
+static Pista pistas[MAX_PISTAS];
+static int n_pistas = 0;
+static Assinaturas assinaturas;
+static MotorRampa rampa = MOTOR_RAMPA_PADRAO;
+static int voltas_por_pista = 1;
+static bool memoria = false;
+static MapaVoltaParams mapa_params = MAPA_VOLTA_PARAMS_PADRAO;
+static double volta_real_s = 0;       // --valida: tempo de volta medido no robô
+static bool valida_sinteticas = false;
+static double tolerancia = 0.2;
+
+// --- ALEATÓRIO (determinístico por pista: todas as combinações veem o mesmo ruído) ---
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static double uniforme(uint32_t *s) {
+    return (xorshift(s) >> 8) * (1.0 / 16777216.0);
+}
+
+static double gauss(uint32_t *s) {
+    return (uniforme(s) + uniforme(s) + uniforme(s) + uniforme(s) - 2.0) * 1.7320508;
+}
+
+// --- CONSTRUÇÃO DAS PISTAS ---
+
+static void carimba(Pista *pt, double px, double py, uint8_t cor, double s_m, bool no_laco) {
+    int r = (int) (RAIO_CARIMBO_M / CELULA_M);
+    int cx = (int) ((px - pt->x0) / CELULA_M), cy = (int) ((py - pt->y0) / CELULA_M);
+    for (int j = cy - r; j <= cy + r; j++) {
+        if (j < 0 || j >= pt->h) continue;
+        for (int i = cx - r; i <= cx + r; i++) {
+            if (i < 0 || i >= pt->w) continue;
+            double dx = pt->x0 + (i + 0.5) * CELULA_M - px, dy = pt->y0 + (j + 0.5) * CELULA_M - py;
+            double d = sqrt(dx * dx + dy * dy);
+            size_t k = (size_t) j * pt->w + i;
+            if (d <= LARGURA_FAIXA_M / 2 && cor > pt->cor[k]) pt->cor[k] = cor;
+            if (no_laco && d * 1000 < pt->dist_mm[k]) {
+                pt->dist_mm[k] = (uint8_t) (d * 1000);
+                pt->progresso_cm[k] = (uint16_t) (s_m * 100);
+            }
+        }
+    }
+}
+
+static void percorre(Pista *pt, const Polilinha *l, bool fechada, bool no_laco) {
+    double s = 0;
+    int segmentos = fechada ? l->n : l->n - 1;
+    for (int i = 0; i < segmentos; i++) {
+        int k = (i + 1) % l->n;
+        double dx = l->x[k] - l->x[i], dy = l->y[k] - l->y[i];
+        double len = sqrt(dx * dx + dy * dy);
+        int passos = (int) (len / CELULA_M) + 1;
+        for (int p = 0; p < passos; p++) {
+            double f = (double) p / passos;
+            carimba(pt, l->x[i] + f * dx, l->y[i] + f * dy, l->cor[i], s + f * len, no_laco);
+        }
+        s += len;
+    }
+}
+
+static void monta_pista(Pista *pt, const Polilinha *laco, const Polilinha *ramos, int n_ramos) {
+    double xmin = 1e9, ymin = 1e9, xmax = -1e9, ymax = -1e9;
+    for (int r = -1; r < n_ramos; r++) {
+        const Polilinha *l = r < 0 ? laco : &ramos[r];
+        for (int i = 0; i < l->n; i++) {
+            if (l->x[i] < xmin) xmin = l->x[i];
+            if (l->x[i] > xmax) xmax = l->x[i];
+            if (l->y[i] < ymin) ymin = l->y[i];
+            if (l->y[i] > ymax) ymax = l->y[i];
+        }
+    }
+    pt->x0 = xmin - MARGEM_M;
+    pt->y0 = ymin - MARGEM_M;
+    pt->w = (int) ((xmax - xmin + 2 * MARGEM_M) / CELULA_M) + 1;
+    pt->h = (int) ((ymax - ymin + 2 * MARGEM_M) / CELULA_M) + 1;
+    size_t n = (size_t) pt->w * pt->h;
+    pt->cor = calloc(n, 1);
+    pt->dist_mm = malloc(n);
+    pt->progresso_cm = calloc(n, sizeof(uint16_t));
+    memset(pt->dist_mm, 255, n);
+
+    pt->comprimento_m = 0;
+    for (int i = 0; i < laco->n; i++) {
+        int k = (i + 1) % laco->n;
+        pt->comprimento_m += hypot(laco->x[k] - laco->x[i], laco->y[k] - laco->y[i]);
+    }
+    percorre(pt, laco, true, true);
+    for (int r = 0; r < n_ramos; r++) percorre(pt, &ramos[r], false, false);
+
+    pt->inicio_x = laco->x[0];
+    pt->inicio_y = laco->y[0];
+    pt->inicio_th = atan2(laco->y[1] - laco->y[0], laco->x[1] - laco->x[0]);
+}
+
+// Laço com raio variando (harmônicos aleatórios), trechos coloridos e desvios
+static void pista_sintetica(Pista *pt, uint32_t semente) {
+    static Polilinha laco, ramos[2];
+    uint32_t s = semente;
+    double a2 = 0.05 + 0.15 * uniforme(&s), a3 = 0.03 + 0.10 * uniforme(&s), a5 = 0.04 * uniforme(&s);
+    double f2 = 6.28 * uniforme(&s), f3 = 6.28 * uniforme(&s), f5 = 6.28 * uniforme(&s);
+    double raio = 0.7 + 0.3 * uniforme(&s);
+
+    laco.n = 720;
+    for (int i = 0; i < laco.n; i++) {
+        double th = 6.283185 * i / laco.n;
+        double r = raio * (1 + a2 * sin(2 * th + f2) + a3 * sin(3 * th + f3) + a5 * sin(5 * th + f5));
+        double f = (double) i / laco.n;
+        laco.x[i] = r * cos(th);
+        laco.y[i] = r * sin(th);
+        laco.cor[i] = (f >= 0.40 && f < 0.58) ? COR_VERMELHA :
+                      (f >= 0.75 && f < 0.88) ? COR_AMARELA : COR_AZUL;
+    }
+
+    // Na entrada de cada trecho prioritário sai um desvio azul de 25 cm para fora
+    int entradas[2] = { (int) (0.40 * laco.n), (int) (0.75 * laco.n) };
+    for (int b = 0; b < 2; b++) {
+        int i = entradas[b];
+        double th = atan2(laco.y[i + 1] - laco.y[i - 1], laco.x[i + 1] - laco.x[i - 1]);
+        double lado = uniforme(&s) < 0.5 ? -1 : 1;
+        double dir = th + lado * (0.35 + 0.25 * uniforme(&s));
+        ramos[b].n = 26;
+        for (int k = 0; k < ramos[b].n; k++) {
+            ramos[b].x[k] = laco.x[i] + 0.01 * k * cos(dir);
+            ramos[b].y[k] = laco.y[i] + 0.01 * k * sin(dir);
+            ramos[b].cor[k] = COR_AZUL;
+        }
+    }
+
+    snprintf(pt->nome, sizeof(pt->nome), "sintetica_%u", semente);
+    pt->semente = semente;
+    monta_pista(pt, &laco, ramos, 2);
+}
+
+static int pista_arquivo(Pista *pt, const char *caminho) {
+    static Polilinha laco, ramos[MAX_RAMOS];
+    int n_ramos = 0;
+    char linha[4096];
+    FILE *f = fopen(caminho, "r");
+    if (!f) { perror(caminho); return -1; }
+
+    laco.n = 0;
+    while (fgets(linha, sizeof(linha), f)) {
+        double x, y;
+        int cor;
+        if (linha[0] == 'p' && sscanf(linha + 1, "%lf %lf %d", &x, &y, &cor) == 3 && laco.n < MAX_PONTOS) {
+            laco.x[laco.n] = x / 1000;
+            laco.y[laco.n] = y / 1000;
+            laco.cor[laco.n++] = (uint8_t) cor;
+        } else if (linha[0] == 'r' && n_ramos < MAX_RAMOS) {
+            Polilinha *r = &ramos[n_ramos];
+            char *p = linha + 1;
+            int usados;
+            if (sscanf(p, "%d%n", &cor, &usados) != 1) continue;
+            p += usados;
+            r->n = 0;
+            while (r->n < MAX_PONTOS && sscanf(p, "%lf %lf%n", &x, &y, &usados) == 2) {
+                r->x[r->n] = x / 1000;
+                r->y[r->n] = y / 1000;
+                r->cor[r->n++] = (uint8_t) cor;
+                p += usados;
+            }
+            if (r->n >= 2) n_ramos++;
+        }
+    }
+    fclose(f);
+    if (laco.n < 3) {
+        fprintf(stderr, "%s: laço com menos de 3 pontos\n", caminho);
+        return -1;
+    }
+
+    snprintf(pt->nome, sizeof(pt->nome), "%.63s", caminho);
+    pt->semente = 0x9E3779B9u ^ (uint32_t) laco.n;
+    monta_pista(pt, &laco, ramos, n_ramos);
+    return 0;
+}
+
+// --- LEITURAS DOS SENSORES ---
+
+// Mesmas assinaturas do treina_modelo_direcao.py (ATIME 0xF6, ganho 4x)
+static void assinaturas_padrao(Assinaturas *a) {
+    static const double tab[4][4] = {
+        { 0.36, 0.34, 0.30, 900 },    // nenhuma (chão)
+        { 0.20, 0.30, 0.50, 300 },    // azul
+        { 0.60, 0.20, 0.20, 350 },    // vermelha
+        { 0.45, 0.40, 0.15, 700 },    // amarela
+    };
+    for (int c = 0; c < 4; c++) {
+        for (int k = 0; k < 3; k++) a->media[c][k] = tab[c][k] * tab[c][3];
+        a->media[c][3] = tab[c][3];
+        for (int k = 0; k < 4; k++) a->desvio[c][k] = 0.05 * a->media[c][k];
+    }
+}
+
+// Média e desvio por cor a partir do CSV do registro de voo (cor_esq/cor_dir)
+static int calibra(Assinaturas *a, const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) { perror(caminho); return -1; }
+    char linha[1024];
+    int col[16], n_col = 0;
+    const char *nomes[] = { "esq_r", "esq_g", "esq_b", "esq_c", "dir_r", "dir_g", "dir_b", "dir_c",
+                            "cor_esq", "cor_dir" };
+    if (!fgets(linha, sizeof(linha), f)) { fclose(f); return -1; }
+    for (int k = 0; k < 10; k++) col[k] = -1;
+    for (char *tok = strtok(linha, ",\r\n"); tok; tok = strtok(NULL, ",\r\n"), n_col++) {
+        for (int k = 0; k < 10; k++) if (strcmp(tok, nomes[k]) == 0) col[k] = n_col;
+    }
+    for (int k = 0; k < 10; k++) {
+        if (col[k] < 0) {
+            fprintf(stderr, "%s: falta a coluna %s\n", caminho, nomes[k]);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    double soma[4][4] = { { 0 } }, soma2[4][4] = { { 0 } };
+    long n[4] = { 0 };
+    while (fgets(linha, sizeof(linha), f)) {
+        double v[16];
+        int i = 0;
+        for (char *tok = strtok(linha, ",\r\n"); tok && i < 16; tok = strtok(NULL, ",\r\n")) v[i++] = atof(tok);
+        for (int lado = 0; lado < 2; lado++) {
+            int cor = (int) v[col[8 + lado]] & 3;
+            for (int k = 0; k < 4; k++) {
+                double x = v[col[lado * 4 + k]];
+                soma[cor][k] += x;
+                soma2[cor][k] += x * x;
+            }
+            n[cor]++;
+        }
+    }
+    fclose(f);
+
+    for (int c = 0; c < 4; c++) {
+        if (n[c] < 20) {
+            fprintf(stderr, "calibracao: cor %d com %ld leituras, mantendo a assinatura padrao\n", c, n[c]);
+            continue;
+        }
+        for (int k = 0; k < 4; k++) {
+            a->media[c][k] = soma[c][k] / n[c];
+            a->desvio[c][k] = sqrt(fmax(0, soma2[c][k] / n[c] - a->media[c][k] * a->media[c][k]));
+        }
+        fprintf(stderr, "calibracao: cor %d, %ld leituras, rgbc medio %.0f %.0f %.0f %.0f\n", c, n[c],
+                a->media[c][0], a->media[c][1], a->media[c][2], a->media[c][3]);
+    }
+    return 0;
+}
+
+static TipoCor le_sensor(const Pista *pt, const SeguidorParams *p, double x, double y, uint32_t *rng) {
+    int i = (int) ((x - pt->x0) / CELULA_M), j = (int) ((y - pt->y0) / CELULA_M);
+    uint8_t cor = (i >= 0 && i < pt->w && j >= 0 && j < pt->h) ? pt->cor[(size_t) j * pt->w + i] : 0;
+    uint16_t v[4];
+    for (int k = 0; k < 4; k++) {
+        double x = assinaturas.media[cor][k] + assinaturas.desvio[cor][k] * gauss(rng);
+        v[k] = (uint16_t) (x < 0 ? 0 : x > 65535 ? 65535 : x);
+    }
+    return seguidor_identifica_cor(p, v[0], v[1], v[2], v[3]);
+}
+
+// --- SIMULAÇÃO DE UMA VOLTA ---
+
+// Comando com sinal -> ciclo útil (mesmo mapa do robô) -> velocidade da roda
+static double roda_mps(int32_t comando) {
+    uint32_t ciclo = motor_ciclo_q16(motor_modulo(comando));
+    if (ciclo <= PWM_MORTO) return 0;
+    return (comando < 0 ? -1 : 1) * VMAX_MPS * (ciclo - PWM_MORTO) / (65536.0 - PWM_MORTO);
+}
+
+typedef struct {
+    bool completou;               // todas as voltas
+    double tempo_s;
+    double progresso;             // fração das voltas
+    int perdas;
+    double primeira_s;
+    double seguintes_s;           // média das voltas depois da primeira
+    int divergencias;
+} Volta;
+
+static Volta simula(const Pista *pt, const SeguidorParams *p) {
+    Volta v = { 0 };
+    uint32_t rng = pt->semente | 1;
+    SeguidorEstado estado = { .prioridade_ativa = COR_NENHUMA };
+    TipoCor cor_esq = COR_NENHUMA, cor_dir = COR_NENHUMA;
+    MlDirecao comando = ML_DIRECAO_RETO;
+    bool ler_esquerdo = true;
+    int32_t cmd_l = 0, cmd_r = 0, rampa_l = 0, rampa_r = 0;
+    MapaVolta mapa;
+    mapa_volta_inicia(&mapa);
+    int32_t base = p->base_speed;
+    int voltas = 0;
+    uint32_t fim_volta = 0;
+
+    double x = pt->inicio_x, y = pt->inicio_y, th = pt->inicio_th;
+    double vl = 0, vr = 0;
+    const double dt = PASSO_US * 1e-6, ganho = dt / TAU_MOTOR_S;
+    const uint32_t periodo_leitura_us = (uint32_t) p->periodo_ms * 1000u;
+    uint32_t prox_leitura = 0, prox_motor = 0;
+
+    int prog_anterior = -1;
+    double avancado_m = 0;
+    bool perdido = false;
+    uint32_t perdido_desde = 0;
+
+    for (uint32_t t = 0; t < (uint32_t) (TEMPO_MAX_S * voltas_por_pista * 1e6); t += PASSO_US) {
+        if (t >= prox_leitura) {
+            double fx = x + SENSOR_FRENTE_M * cos(th), fy = y + SENSOR_FRENTE_M * sin(th);
+            double lado = ler_esquerdo ? SENSOR_LADO_M : -SENSOR_LADO_M;
+            TipoCor cor = le_sensor(pt, p, fx - lado * sin(th), fy + lado * cos(th), &rng);
+            if (ler_esquerdo) cor_esq = cor; else cor_dir = cor;
+            ler_esquerdo = !ler_esquerdo;
+            comando = seguidor_decide(p, &estado, cor_esq, cor_dir, t / 1000);
+            if (memoria) {
+                base = mapa_volta_passo(&mapa, &mapa_params, comando, cor_esq > cor_dir ? cor_esq : cor_dir,
+                                        t / 1000, p->base_speed, p->spin_speed);
+            }
+            prox_leitura += periodo_leitura_us;
+        }
+        if (t >= prox_motor) {
+            // Mesmos sentidos de rumo_malha_aberta
+            cmd_l = comando == ML_DIRECAO_ESQUERDA ? -base : base;
+            cmd_r = comando == ML_DIRECAO_RETO    ? base :
+                    comando == ML_DIRECAO_DIREITA ? -p->spin_speed : p->spin_speed;
+            prox_motor += PERIODO_MOTOR_US;
+        }
+        rampa_l = motor_rampa_passo(rampa_l, cmd_l, rampa.passo[0]);
+        rampa_r = motor_rampa_passo(rampa_r, cmd_r, rampa.passo[1]);
+
+        vl += (roda_mps(rampa_l) - vl) * ganho;
+        vr += (roda_mps(rampa_r) - vr) * ganho;
+        double vel = (vl + vr) / 2, w = (vr - vl) / ENTRE_RODAS_M;
+        x += vel * cos(th) * dt;
+        y += vel * sin(th) * dt;
+        th += w * dt;
+
+        // Onde o carrinho está em relação ao laço (centro do eixo)
+        int i = (int) ((x - pt->x0) / CELULA_M), j = (int) ((y - pt->y0) / CELULA_M);
+        if (i < 0 || i >= pt->w || j < 0 || j >= pt->h) break;
+        size_t k = (size_t) j * pt->w + i;
+
+        if (pt->dist_mm[k] > PERDIDO_M * 1000) {
+            if (!perdido) {
+                perdido = true;
+                perdido_desde = t;
+                v.perdas++;
+            } else if (t - perdido_desde > PERDIDO_ABORTA_S * 1e6) {
+                break;
+            }
+            continue;
+        }
+        perdido = false;
+
+        int prog = pt->progresso_cm[k];
+        if (prog_anterior >= 0) {
+            int comp_cm = (int) (pt->comprimento_m * 100);
+            int d = prog - prog_anterior;
+            if (d > comp_cm / 2) d -= comp_cm;
+            if (d < -comp_cm / 2) d += comp_cm;
+            avancado_m += d / 100.0;
+        }
+        prog_anterior = prog;
+
+        if (avancado_m >= (voltas + 1) * pt->comprimento_m) {
+            double volta_s = (t - fim_volta) * 1e-6;
+            if (voltas == 0) v.primeira_s = volta_s;
+            else v.seguintes_s += volta_s;
+            fim_volta = t;
+            if (++voltas == voltas_por_pista) {
+                v.completou = true;
+                v.tempo_s = t * 1e-6;
+                break;
+            }
+        }
+    }
+
+    if (voltas > 1) v.seguintes_s /= voltas - 1;
+    v.divergencias = (int) mapa.divergencias;
+    v.progresso = avancado_m < 0 ? 0 : avancado_m / (pt->comprimento_m * voltas_por_pista);
+    if (v.progresso > 1) v.progresso = 1;
+    return v;
+}
+
+static void avalia(Resultado *r) {
+    r->voltas = 0;
+    r->tempo_total_s = 0;
+    r->progresso = 0;
+    r->perdas = 0;
+    r->primeira_s = 0;
+    r->seguintes_s = 0;
+    r->divergencias = 0;
+    for (int i = 0; i < n_pistas; i++) {
+        Volta v = simula(&pistas[i], &r->p);
+        r->voltas += v.completou;
+        r->tempo_total_s += v.completou ? v.tempo_s : 0;
+        r->primeira_s += v.completou ? v.primeira_s : 0;
+        r->seguintes_s += v.completou ? v.seguintes_s : 0;
+        r->progresso += v.progresso;
+        r->perdas += v.perdas;
+        r->divergencias += v.divergencias;
+    }
+    // Volta incompleta custa o tempo máximo mais o que faltou andar
+    r->nota = r->tempo_total_s + PENALIDADE_PERDA_S * r->perdas +
+              ((n_pistas - r->voltas) + (n_pistas - r->progresso)) * TEMPO_MAX_S * voltas_por_pista;
+}
+
+// --- GRADE E THREADS ---
+
+typedef struct {
+    double ini, fim, passo;
+} Faixa;
+
+static Faixa f_base = { 11000, 23000, 2000 };
+static Faixa f_spin = { 9000, 19000, 2000 };
+static Faixa f_trava = { 500, 2500, 500 };
+static Faixa f_periodo = { 10, 40, 10 };
+static Faixa f_brilho = { 25, 100, 25 };
+static Faixa f_razao_am = { 1.5, 1.5, 0.1 };
+static Faixa f_razao_vm = { 1.5, 1.5, 0.1 };
+static Faixa f_razao_az = { 1.4, 1.4, 0.1 };
+static int classificadores = 3;   // bit 0 = LUT, bit 1 = razões
+
+static int conta(const Faixa *f) {
+    return (int) floor((f->fim - f->ini) / f->passo + 1e-6) + 1;
+}
+
+static double valor(const Faixa *f, int i) {
+    return f->ini + i * f->passo;
+}
+
+static Resultado *resultados;
+static int n_resultados = 0;
+static atomic_int proximo;
+
+static void *trabalhador(void *arg) {
+    (void) arg;
+    for (;;) {
+        int i = atomic_fetch_add(&proximo, 1);
+        if (i >= n_resultados) return NULL;
+        avalia(&resultados[i]);
+    }
+}
+
+static int compara(const void *a, const void *b) {
+    const Resultado *ra = a, *rb = b;
+    return (ra->nota > rb->nota) - (ra->nota < rb->nota);
+}
+
+static int le_faixa(const char *s, Faixa *f) {
+    if (sscanf(s, "%lf:%lf:%lf", &f->ini, &f->fim, &f->passo) == 3 && f->passo > 0 && f->fim >= f->ini) return 0;
+    if (sscanf(s, "%lf", &f->ini) == 1) {
+        f->fim = f->ini;
+        f->passo = 1;
+        return 0;
+    }
+    fprintf(stderr, "faixa invalida: %s (use ini:fim:passo ou um valor)\n", s);
+    return -1;
+}
+
+static void imprime(const char *marca, int pos, const Resultado *r) {
+    printf("%s%4d  base=%5u spin=%5u trava=%4u periodo=%2u brilho=%3u %-6s",
+           marca, pos, r->p.base_speed, r->p.spin_speed, r->p.trava_ms, r->p.periodo_ms, r->p.brilho_min,
+           r->p.classificador == SEGUIDOR_CLASSIFICA_RAZOES ? "razoes" : "lut");
+    if (r->p.classificador == SEGUIDOR_CLASSIFICA_RAZOES) {
+        printf(" (%.2f %.2f %.2f)", r->p.razao_amarela_q8 / 256.0, r->p.razao_vermelha_q8 / 256.0,
+               r->p.razao_azul_q8 / 256.0);
+    }
+    printf(" | voltas %d/%d tempo %6.1f s perdas %3d nota %7.1f",
+           r->voltas, n_pistas, r->tempo_total_s, r->perdas, r->nota);
+    if (voltas_por_pista > 1) {
+        printf(" | 1a %5.1f s seguintes %5.1f s", r->primeira_s, r->seguintes_s);
+        if (memoria) printf(" divergencias %d", r->divergencias);
+    }
+    printf("\n");
+}
+
+// Parâmetros do robô contra a volta medida; devolve o código de saída
+static int valida(void) {
+    Resultado r = { .p = SEGUIDOR_PARAMS_PADRAO };
+    avalia(&r);
+    imprime("robo", 1, &r);
+
+    if (r.voltas < n_pistas) {
+        printf("VALIDACAO FALHOU: parametros do robo fecham %d/%d pistas (o robo real fecha)\n",
+               r.voltas, n_pistas);
+        return 1;
+    }
+    if (valida_sinteticas) {
+        double comprimento_m = 0;
+        for (int i = 0; i < n_pistas; i++) comprimento_m += pistas[i].comprimento_m;
+        double media = comprimento_m * voltas_por_pista / r.tempo_total_s;
+        double reta = roda_mps(r.p.base_speed);
+        printf("media %.3f m/s, reta %.3f m/s: %.0f%% (minimo %.0f%%), %d saidas da faixa\n",
+               media, reta, media / reta * 100, VEL_MIN_FRACAO * 100, r.perdas);
+        if (r.perdas || media < VEL_MIN_FRACAO * reta) {
+            printf("VALIDACAO FALHOU: o carrinho simulado sai da faixa ou anda devagar demais\n");
+            return 1;
+        }
+        printf("VALIDACAO OK\n");
+        return 0;
+    }
+    double volta_sim_s = r.tempo_total_s / (n_pistas * voltas_por_pista);
+    double erro = (volta_sim_s - volta_real_s) / volta_real_s;
+    printf("volta simulada %.2f s, medida %.2f s: erro %+.1f%% (tolerancia %.0f%%)\n",
+           volta_sim_s, volta_real_s, erro * 100, tolerancia * 100);
+    if (fabs(erro) > tolerancia) {
+        printf("VALIDACAO FALHOU: tempo de volta fora da tolerancia\n");
+        return 1;
+    }
+    printf("VALIDACAO OK\n");
+    return 0;
+}
+
+static double agora_s(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    int n_sinteticas = 3, top = 10;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *saida = NULL;
+    assinaturas_padrao(&assinaturas);
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i], *v = i + 1 < argc ? argv[i + 1] : NULL;
+        int erro = 0;
+        if (!v && strcmp(a, "-h") != 0) { fprintf(stderr, "%s sem valor\n", a); return 1; }
+        if      (!strcmp(a, "--base"))     erro = le_faixa(v, &f_base);
+        else if (!strcmp(a, "--spin"))     erro = le_faixa(v, &f_spin);
+        else if (!strcmp(a, "--trava"))    erro = le_faixa(v, &f_trava);
+        else if (!strcmp(a, "--periodo"))  erro = le_faixa(v, &f_periodo);
+        else if (!strcmp(a, "--brilho"))   erro = le_faixa(v, &f_brilho);
+        else if (!strcmp(a, "--razao-am")) erro = le_faixa(v, &f_razao_am);
+        else if (!strcmp(a, "--razao-vm")) erro = le_faixa(v, &f_razao_vm);
+        else if (!strcmp(a, "--razao-az")) erro = le_faixa(v, &f_razao_az);
+        else if (!strcmp(a, "--classificador")) {
+            classificadores = (strstr(v, "lut") ? 1 : 0) | (strstr(v, "razoes") ? 2 : 0);
+        }
+        else if (!strcmp(a, "--pistas"))   n_sinteticas = atoi(v);
+        else if (!strcmp(a, "--pista"))    erro = n_pistas < MAX_PISTAS ? pista_arquivo(&pistas[n_pistas++], v) : -1;
+        else if (!strcmp(a, "--calibra"))  erro = calibra(&assinaturas, v);
+        else if (!strcmp(a, "--rampa"))    rampa.passo[0] = rampa.passo[1] = (uint16_t) atoi(v);
+        else if (!strcmp(a, "--voltas"))   voltas_por_pista = atoi(v) > 0 ? atoi(v) : 1;
+        else if (!strcmp(a, "--memoria"))  memoria = atoi(v) != 0;
+        else if (!strcmp(a, "--rapido"))   mapa_params.rapido_q8 = (uint16_t) lround(atof(v) * 256);
+        else if (!strcmp(a, "--antecipa")) mapa_params.antecipa = (uint16_t) atoi(v);
+        else if (!strcmp(a, "--reta"))     mapa_params.reta_q8 = (uint8_t) lround(atof(v) * 256);
+        else if (!strcmp(a, "--confirma")) mapa_params.confirma_avanco = (uint16_t) atoi(v);
+        else if (!strcmp(a, "--valida")) {
+            if (!strcmp(v, "sinteticas")) valida_sinteticas = true;
+            else volta_real_s = atof(v);
+        }
+        else if (!strcmp(a, "--tolerancia")) tolerancia = atof(v);
+        else if (!strcmp(a, "--threads")) threads = atol(v);
+        else if (!strcmp(a, "--top"))      top = atoi(v);
+        else if (!strcmp(a, "-o"))         saida = v;
+        else {
+            fprintf(stderr, "uso: %s [--base|--spin|--trava|--periodo|--brilho|--razao-am|--razao-vm|--razao-az ini:fim:passo]\n"
+                            "          [--classificador lut,razoes] [--pistas N] [--pista arq] [--calibra volta.csv]\n"
+                            "          [--rampa passo] [--voltas N] [--memoria 0|1] [--rapido x] [--antecipa avanco]\n"
+                            "          [--reta fracao] [--confirma avanco] [--valida volta_s|sinteticas] [--tolerancia fracao]\n"
+                            "          [--threads N] [--top N] [-o resultados.csv]\n", argv[0]);
+            return 1;
+        }
+        if (erro) return 1;
+        i++;
+    }
+    if (threads < 1) threads = 1;
+
+    if (volta_real_s > 0) {
+        if (n_pistas == 0) { fprintf(stderr, "--valida precisa da pista real (--pista)\n"); return 1; }
+        n_sinteticas = 0;
+    }
+
+    double t0 = agora_s();
+    for (int i = 0; i < n_sinteticas && n_pistas < MAX_PISTAS; i++) {
+        pista_sintetica(&pistas[n_pistas++], 1000u + 7919u * (uint32_t) i);
+    }
+    if (n_pistas == 0) { fprintf(stderr, "nenhuma pista\n"); return 1; }
+    for (int i = 0; i < n_pistas; i++) {
+        printf("pista %-24s %.2f m, grade %dx%d\n", pistas[i].nome, pistas[i].comprimento_m, pistas[i].w, pistas[i].h);
+    }
+    if (volta_real_s > 0 || valida_sinteticas) return valida();
+
+    // Grade completa (as razões só variam com o classificador de razões)
+    int n_razoes = conta(&f_razao_am) * conta(&f_razao_vm) * conta(&f_razao_az);
+    int por_classificador = conta(&f_base) * conta(&f_spin) * conta(&f_trava) * conta(&f_periodo) * conta(&f_brilho);
+    int total = por_classificador * (((classificadores & 1) ? 1 : 0) + ((classificadores & 2) ? n_razoes : 0));
+    resultados = calloc((size_t) total + 1, sizeof(Resultado));
+
+    for (int cl = 0; cl < 2; cl++) {
+        if (!(classificadores & (1 << cl))) continue;
+        int razoes = cl ? n_razoes : 1;
+        for (int ib = 0; ib < conta(&f_base); ib++)
+        for (int is = 0; is < conta(&f_spin); is++)
+        for (int it = 0; it < conta(&f_trava); it++)
+        for (int ip = 0; ip < conta(&f_periodo); ip++)
+        for (int il = 0; il < conta(&f_brilho); il++)
+        for (int ir = 0; ir < razoes; ir++) {
+            SeguidorParams p = SEGUIDOR_PARAMS_PADRAO;
+            p.base_speed = (uint16_t) valor(&f_base, ib);
+            p.spin_speed = (uint16_t) valor(&f_spin, is);
+            p.trava_ms = (uint16_t) valor(&f_trava, it);
+            p.periodo_ms = (uint16_t) valor(&f_periodo, ip);
+            p.brilho_min = (uint16_t) valor(&f_brilho, il);
+            p.classificador = (uint8_t) cl;
+            if (cl) {
+                int n_vm = conta(&f_razao_vm), n_az = conta(&f_razao_az);
+                p.razao_amarela_q8 = (uint16_t) lround(valor(&f_razao_am, ir / (n_vm * n_az)) * 256);
+                p.razao_vermelha_q8 = (uint16_t) lround(valor(&f_razao_vm, (ir / n_az) % n_vm) * 256);
+                p.razao_azul_q8 = (uint16_t) lround(valor(&f_razao_az, ir % n_az) * 256);
+            }
+            resultados[n_resultados++].p = p;
+        }
+    }
+    // Referência: os parâmetros que estão no robô hoje
+    Resultado atual = { .p = SEGUIDOR_PARAMS_PADRAO };
+    avalia(&atual);
+
+    double t1 = agora_s();
+    printf("%d combinacoes x %d pistas em %ld threads...\n", n_resultados, n_pistas, threads);
+    fflush(stdout);
+    pthread_t *th = calloc((size_t) threads, sizeof(pthread_t));
+    atomic_init(&proximo, 0);
+    for (long i = 0; i < threads; i++) pthread_create(&th[i], NULL, trabalhador, NULL);
+    for (long i = 0; i < threads; i++) pthread_join(th[i], NULL);
+    double t2 = agora_s();
+
+    qsort(resultados, (size_t) n_resultados, sizeof(Resultado), compara);
+    int pos_atual = 0;
+    while (pos_atual < n_resultados && resultados[pos_atual].nota <= atual.nota) pos_atual++;
+
+    printf("pistas em %.2f s, varredura em %.2f s: %.0f us por combinacao e pista (%.0f us de CPU)\n",
+           t1 - t0, t2 - t1, (t2 - t1) * 1e6 / ((double) n_resultados * n_pistas),
+           (t2 - t1) * 1e6 * threads / ((double) n_resultados * n_pistas));
+    for (int i = 0; i < top && i < n_resultados; i++) imprime("  ", i + 1, &resultados[i]);
+    imprime("robo", pos_atual + 1, &atual);
+    if (PERFIL_ATIVO) perfil_relatorio();
+
+    if (saida) {
+        FILE *f = fopen(saida, "w");
+        if (!f) { perror(saida); return 1; }
+        fprintf(f, "posicao,base_speed,spin_speed,trava_ms,periodo_ms,brilho_min,classificador,"
+                   "razao_amarela,razao_vermelha,razao_azul,voltas,tempo_s,progresso,perdas,nota\n");
+        for (int i = 0; i < n_resultados; i++) {
+            const Resultado *r = &resultados[i];
+            fprintf(f, "%d,%u,%u,%u,%u,%u,%s,%.3f,%.3f,%.3f,%d,%.3f,%.3f,%d,%.2f\n", i + 1,
+                    r->p.base_speed, r->p.spin_speed, r->p.trava_ms, r->p.periodo_ms, r->p.brilho_min,
+                    r->p.classificador == SEGUIDOR_CLASSIFICA_RAZOES ? "razoes" : "lut",
+                    r->p.razao_amarela_q8 / 256.0, r->p.razao_vermelha_q8 / 256.0, r->p.razao_azul_q8 / 256.0,
+                    r->voltas, r->tempo_total_s, r->progresso, r->perdas, r->nota);
+        }
+        fclose(f);
+        printf("resultados em %s\n", saida);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * verifica_modelo_direcao.c - Teste bit-exato do modelo de direção no host
+ *
+ * Compara, byte a byte, as saídas de src/ml_direcao.c com as calculadas por
+ * treina_modelo_direcao.py. Também confere a extração de características e a
+ * janela de histórico. Os dois caminhos do robô passam pelo mesmo teste:
+ *
+ * Referência em C (a aritmética inteira do CMSIS-NN reescrita):
+ *   gcc -std=c11 -O2 -I../../inc -I. -o verifica_modelo_direcao verifica_modelo_direcao.c ../ml_direcao.c
+ *
+ * CMSIS-NN: os mesmos fontes do CMakeLists (CMSIS_NN_SRCS) compilados para o
+ * host, que sem as extensões DSP/MVE do Arm usam o código C puro dos kernels:
+ *   NN=../../edge-impulse-sdk/third_party/cmsis/CMSIS/NN
+ *   gcc -std=c11 -O2 -DCMSIS_NN=1 -I../../inc -I. -I$NN/Include \
+ *       -I$NN/../Core/Include -I$NN/../DSP/Include \
+ *       -o verifica_modelo_direcao_cmsis verifica_modelo_direcao.c ../ml_direcao.c \
+ *       $NN/Source/FullyConnectedFunctions/arm_fully_connected_s8.c \
+ *       $NN/Source/NNSupportFunctions/arm_nn_vec_mat_mult_t_s8.c
+ *
+ * A primeira linha da saída diz qual caminho foi compilado; as duas versões
+ * têm de terminar em "OK". Uma diferença só no CMSIS-NN aponta arredondamento
+ * do requantize (CMSIS_NN_USE_SINGLE_ROUNDING) ou parâmetros trocados em
+ * densa().
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ml_direcao.h"
+#include "modelo_direcao_vetores.h"
+
+int main(void) {
+    int falhas = 0;
+    int8_t logits[MODELO_DIRECAO_CLASSES];
+
+    printf("caminho: %s\n", ML_DIRECAO_CMSIS ? "CMSIS-NN (arm_fully_connected_s8)" : "referencia em C");
+    ml_direcao_init();
+
+    for (int i = 0; i < MODELO_DIRECAO_N_VETORES; i++) {
+        ml_direcao_infere_vetor(vetores_entrada[i], logits);
+        if (memcmp(logits, vetores_saida[i], MODELO_DIRECAO_CLASSES) != 0) {
+            printf("[FALHA] vetor %d: obtido {%d, %d, %d} esperado {%d, %d, %d}\n", i,
+                   logits[0], logits[1], logits[2],
+                   vetores_saida[i][0], vetores_saida[i][1], vetores_saida[i][2]);
+            falhas++;
+        }
+    }
+
+    // Janela: a leitura mais recente entra no início do vetor de entrada
+    const uint16_t branco[4] = { 320, 300, 280, 900 };
+    const uint16_t azul[4]   = { 60, 90, 150, 300 };
+    ml_direcao_init();
+    for (int i = 0; i < MODELO_DIRECAO_HISTORICO - 1; i++) {
+        ml_direcao_amostra(branco, branco);
+        if (ml_direcao_pronto()) {
+            printf("[FALHA] janela pronta antes de %d leituras\n", MODELO_DIRECAO_HISTORICO);
+            falhas++;
+        }
+    }
+    ml_direcao_amostra(branco, azul);
+    if (!ml_direcao_pronto()) {
+        printf("[FALHA] janela incompleta apos %d leituras\n", MODELO_DIRECAO_HISTORICO);
+        falhas++;
+    }
+    MlDirecao d = ml_direcao_infere(logits);
+
+    int8_t esperado[MODELO_DIRECAO_POR_SENSOR];
+    ml_direcao_caracteristicas(60, 90, 150, 300, esperado);
+    if (esperado[0] != 25 || esperado[1] != 38 || esperado[2] != 63 || esperado[3] != 18) {
+        printf("[FALHA] caracteristicas {%d, %d, %d, %d}\n", esperado[0], esperado[1], esperado[2], esperado[3]);
+        falhas++;
+    }
+
+    const MlDirecaoEstatisticas *e = ml_direcao_estatisticas();
+    printf("%d vetores, arena %d bytes, pesos %d bytes\n", MODELO_DIRECAO_N_VETORES, ML_DIRECAO_ARENA_BYTES,
+           (int) (sizeof(modelo_direcao_w1) + sizeof(modelo_direcao_b1) +
+                  sizeof(modelo_direcao_w2) + sizeof(modelo_direcao_b2)));
+    printf("Azul sob o sensor direito -> classe %d (logits %d %d %d), %u ns\n",
+           d, logits[0], logits[1], logits[2], e->ciclos_ultimo);
+
+    if (falhas) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+    printf("OK: saidas bit-exatas (%s)\n", ML_DIRECAO_CMSIS ? "CMSIS-NN" : "referencia");
+    return 0;
+}
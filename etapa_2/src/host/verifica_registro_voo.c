@@ -0,0 +1,109 @@
+/**
+ * verifica_registro_voo.c - Ida e volta da codificação do gravador de bordo
+ *
+ * Gera uma volta sintética (leituras com ruído, saltos de cor, um intervalo
+ * longo e valores extremos), codifica em páginas como o robô faz e imprime
+ * o despejo ("REG <hex>") na saída padrão; com -e grava o CSV esperado.
+ * O decodificador tem que devolver exatamente esse CSV:
+ *
+ *   ./verifica_registro_voo -e esperado.csv > despejo.txt
+ *   python3 registro_voo_decodifica.py despejo.txt -o saida.csv && diff esperado.csv saida.csv
+ *
+ * Compilação (a partir desta pasta):
+ *   gcc -std=c11 -O2 -I../../inc -o verifica_registro_voo verifica_registro_voo.c ../registro_voo.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "registro_voo.h"
+
+#define N_REGISTROS 2000
+#define SESSAO      7
+
+static uint32_t semente = 12345;
+
+static uint32_t aleatorio(void) {
+    semente = semente * 1103515245u + 12345u;
+    return semente >> 8;
+}
+
+static uint16_t passeia(uint16_t v, int passo) {
+    int32_t n = (int32_t) v + (int32_t) (aleatorio() % (2 * passo + 1)) - passo;
+    return (uint16_t) (n < 0 ? 0 : n > 65535 ? 65535 : n);
+}
+
+static void despeja(const RegistroVooPagina *p) {
+    printf("REG ");
+    for (int i = 0; i < REGISTRO_VOO_PAGINA; i++) printf("%02x", p->dados[i]);
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    FILE *esperado = NULL;
+    if (argc == 3 && strcmp(argv[1], "-e") == 0) {
+        esperado = fopen(argv[2], "w");
+        if (!esperado) { perror(argv[2]); return 1; }
+        fprintf(esperado, "sessao,seq,t_us,atraso_us,esq_r,esq_g,esq_b,esq_c,"
+                          "dir_r,dir_g,dir_b,dir_c,cor_esq,cor_dir,prioridade,movimento\r\n");
+    }
+
+    RegistroVooPagina pagina;
+    RegistroVoo r = { .esq = { 300, 280, 250, 900 }, .dir = { 310, 270, 240, 880 },
+                      .captura_us = 0xFFFF0000u };   // dá a volta nos 32 bits no meio
+    uint32_t seq = 100, paginas = 0, bytes = 0;
+    int falhas = 0;
+
+    registro_voo_pagina_inicia(&pagina, SESSAO);
+    for (int i = 0; i < N_REGISTROS; i++) {
+        r.captura_us += 30000 + aleatorio() % 500;
+        if (i == 700) r.captura_us += 5000000;          // robô parado por 5 s
+        r.decisao_us = r.captura_us + 200 + aleatorio() % 3000;
+        for (int k = 0; k < 4; k++) {
+            r.esq[k] = passeia(r.esq[k], 20);
+            r.dir[k] = passeia(r.dir[k], 20);
+        }
+        if (i % 97 == 0) r.esq[3] = (uint16_t) (aleatorio() & 0xFFFF);   // salto de cor
+        if (i == 1500) r.dir[0] = 65535, r.dir[1] = 0;
+        r.cor_esq = (uint8_t) (aleatorio() % 4);
+        r.cor_dir = (uint8_t) (aleatorio() % 4);
+        r.prioridade = (uint8_t) (aleatorio() % 4);
+        r.movimento = (uint8_t) (aleatorio() % 3);
+
+        if (!registro_voo_pagina_anota(&pagina, &r)) {
+            registro_voo_pagina_fecha(&pagina, seq, 0);
+            if (!registro_voo_pagina_valida(pagina.dados)) falhas++;
+            despeja(&pagina);
+            bytes += pagina.usados;
+            paginas++;
+            seq++;
+            registro_voo_pagina_inicia(&pagina, SESSAO);
+            if (!registro_voo_pagina_anota(&pagina, &r)) falhas++;
+        }
+        if (esperado) {
+            fprintf(esperado, "%d,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n",
+                    SESSAO, (unsigned long) seq, (unsigned long) r.captura_us,
+                    (unsigned long) (r.decisao_us - r.captura_us),
+                    r.esq[0], r.esq[1], r.esq[2], r.esq[3], r.dir[0], r.dir[1], r.dir[2], r.dir[3],
+                    r.cor_esq, r.cor_dir, r.prioridade, r.movimento);
+        }
+    }
+    registro_voo_pagina_fecha(&pagina, seq, 0);
+    despeja(&pagina);
+    bytes += pagina.usados;
+    paginas++;
+
+    // Um bit trocado tem que invalidar a página
+    pagina.dados[REGISTRO_VOO_CABECALHO + 3] ^= 0x10;
+    if (registro_voo_pagina_valida(pagina.dados)) falhas++;
+
+    if (esperado) fclose(esperado);
+    fprintf(stderr, "%d registros em %lu paginas, %.1f bytes/registro\n", N_REGISTROS,
+            (unsigned long) paginas, (double) bytes / N_REGISTROS);
+    if (falhas) {
+        fprintf(stderr, "%d falha(s)\n", falhas);
+        return 1;
+    }
+    fprintf(stderr, "OK: paginas do registro de voo\n");
+    return 0;
+}
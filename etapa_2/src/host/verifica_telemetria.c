@@ -0,0 +1,131 @@
+/**
+ * verifica_telemetria.c - Teste do anel e dos lotes de telemetria no host
+ *
+ * Confere o descarte da amostra mais antiga com o anel cheio, o corte do lote
+ * quando dt passa de 16 bits, a confirmação depois de o anel dar a volta e o
+ * formato do cabeçalho. Com -o <pasta>, grava também uma sequência de lotes
+ * (lote_000.bin, ...) para publicar num mosquitto local:
+ *
+ *   mosquitto_sub -h localhost -t robo/telemetria -F %x | python3 telemetria_decodifica.py &
+ *   for f in /tmp/lotes/lote_*; do mosquitto_pub -h localhost -t robo/telemetria -f $f; done
+ *
+ * Compilação (a partir desta pasta):
+ *   gcc -std=c11 -O2 -I../../inc -o verifica_telemetria verifica_telemetria.c ../telemetria.c
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetria.h"
+
+static int falhas = 0;
+
+#define CONFERE(cond, ...) do { if (!(cond)) { printf("[FALHA] " __VA_ARGS__); printf("\n"); falhas++; } } while (0)
+
+static uint16_t le_u16(const uint8_t *p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+static uint32_t le_u32(const uint8_t *p) { return le_u16(p) | ((uint32_t) le_u16(p + 2) << 16); }
+
+static void registra_n(uint32_t n, uint32_t t0, uint32_t passo) {
+    for (uint32_t i = 0; i < n; i++) {
+        telemetria_registra_em(t0 + i * passo, TELEMETRIA_SENSOR, (uint8_t) (i & 1),
+                               (uint16_t) i, (uint16_t) (i >> 16), 0, UINT16_MAX);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint8_t buf[TELEMETRIA_LOTE_BYTES(TELEMETRIA_LOTE_MAX)];
+    TelemetriaLote lote;
+
+    // Cabeçalho e conteúdo
+    telemetria_init();
+    registra_n(10, 1000, 30);
+    size_t n = telemetria_monta_lote(buf, sizeof(buf), 8, &lote);
+    CONFERE(n == TELEMETRIA_LOTE_BYTES(8), "lote de 8: %zu bytes", n);
+    CONFERE(le_u16(buf) == TELEMETRIA_MAGIC && buf[2] == TELEMETRIA_VERSAO && buf[3] == 8, "cabecalho");
+    CONFERE(le_u32(buf + 8) == 1000, "t0 = %u", le_u32(buf + 8));
+    CONFERE(le_u16(buf + TELEMETRIA_CABECALHO_BYTES + 7 * TELEMETRIA_AMOSTRA_BYTES) == 7 * 30, "dt da 8a amostra");
+    CONFERE(telemetria_pendentes() == 10, "montar nao remove do anel");
+    telemetria_confirma_lote(&lote, n);
+    CONFERE(telemetria_pendentes() == 2, "confirmar remove o lote");
+    n = telemetria_monta_lote(buf, sizeof(buf), 8, &lote);
+    CONFERE(n == TELEMETRIA_LOTE_BYTES(2) && le_u16(buf + 4) == 1, "segundo lote com seq 1");
+    telemetria_confirma_lote(&lote, n);
+
+    // Buffer pequeno limita o lote
+    registra_n(5, 0, 1);
+    n = telemetria_monta_lote(buf, TELEMETRIA_LOTE_BYTES(3) + 5, 8, &lote);
+    CONFERE(n == TELEMETRIA_LOTE_BYTES(3), "lote limitado pelo buffer: %zu", n);
+    telemetria_confirma_lote(&lote, n);
+    n = telemetria_monta_lote(buf, sizeof(buf), 8, &lote);
+    telemetria_confirma_lote(&lote, n);
+
+    // dt acima de 16 bits fecha o lote
+    registra_n(3, 0, 40000);
+    n = telemetria_monta_lote(buf, sizeof(buf), 8, &lote);
+    CONFERE(buf[3] == 2, "corte por dt: %u amostras", buf[3]);
+    telemetria_confirma_lote(&lote, n);
+    n = telemetria_monta_lote(buf, sizeof(buf), 8, &lote);
+    telemetria_confirma_lote(&lote, n);
+
+    // Anel cheio: descarta as mais antigas e informa no próximo lote
+    telemetria_init();
+    registra_n(TELEMETRIA_RING + 50, 0, 1);
+    CONFERE(telemetria_pendentes() == TELEMETRIA_RING, "pendentes = %u", telemetria_pendentes());
+    CONFERE(telemetria_estatisticas()->perdidas == 50, "perdidas = %u", telemetria_estatisticas()->perdidas);
+    n = telemetria_monta_lote(buf, sizeof(buf), 4, &lote);
+    CONFERE(le_u16(buf + 6) == 50, "perdidas no cabecalho = %u", le_u16(buf + 6));
+    CONFERE(le_u32(buf + 8) == 50, "primeira amostra apos o descarte: t0 = %u", le_u32(buf + 8));
+
+    // O anel dá a volta durante a "publicação": a confirmação não pode recuar a cauda
+    registra_n(TELEMETRIA_RING, 100000, 1);
+    telemetria_confirma_lote(&lote, n);
+    CONFERE(telemetria_pendentes() == TELEMETRIA_RING, "confirmacao atrasada: pendentes = %u", telemetria_pendentes());
+    n = telemetria_monta_lote(buf, sizeof(buf), 4, &lote);
+    CONFERE(le_u16(buf + 6) == TELEMETRIA_RING, "perdidas durante a publicacao = %u", le_u16(buf + 6));
+
+    // Faixa dos campos: RGBC acima de 32767 passa inteiro, PWM de ±65535 cabe escalado
+    telemetria_init();
+    telemetria_registra_em(0, TELEMETRIA_SENSOR, 0, 40960, 65535, 0, 32768);
+    telemetria_registra_em(1, TELEMETRIA_MOTOR, 3, telemetria_s(-65535 / TELEMETRIA_PWM_DIV),
+                           telemetria_s(65535 / TELEMETRIA_PWM_DIV), 0, telemetria_u(70000));
+    telemetria_registra_em(2, TELEMETRIA_ML, 0, telemetria_s(-128), telemetria_s(-40000), telemetria_s(127), 0);
+    n = telemetria_monta_lote(buf, sizeof(buf), 4, &lote);
+    const uint8_t *a = buf + TELEMETRIA_CABECALHO_BYTES + 4;
+    CONFERE(le_u16(a) == 40960 && le_u16(a + 2) == 65535 && le_u16(a + 6) == 32768, "rgbc u16");
+    a += TELEMETRIA_AMOSTRA_BYTES;
+    CONFERE((int16_t) le_u16(a) == -32767 && (int16_t) le_u16(a + 2) == 32767, "pwm escalado: %d %d",
+            (int16_t) le_u16(a), (int16_t) le_u16(a + 2));
+    CONFERE(le_u16(a + 6) == UINT16_MAX, "distancia satura em 65535");
+    a += TELEMETRIA_AMOSTRA_BYTES;
+    CONFERE((int16_t) le_u16(a) == -128 && (int16_t) le_u16(a + 2) == INT16_MIN && le_u16(a + 4) == 127,
+            "logits com sinal");
+    telemetria_confirma_lote(&lote, n);
+
+    // Lotes para o teste com mosquitto
+    if (argc == 3 && strcmp(argv[1], "-o") == 0) {
+        telemetria_init();
+        for (int i = 0; i < 200; i++) {
+            telemetria_registra_em(i * 30, TELEMETRIA_SENSOR, (uint8_t) ((i & 1) | (1 << 4)), 120, 80, 300, 520);
+            telemetria_registra_em(i * 30 + 1, TELEMETRIA_DECISAO, 0, 1, 0, 1, 850);
+            if (i % 10 == 0) telemetria_registra_em(i * 30 + 2, TELEMETRIA_MOTOR, 1, telemetria_s(17000 / TELEMETRIA_PWM_DIV),
+                                                 telemetria_s(-17000 / TELEMETRIA_PWM_DIV), 0, 42);
+        }
+        int arquivos = 0;
+        while ((n = telemetria_monta_lote(buf, sizeof(buf), 32, &lote)) > 0) {
+            char nome[512];
+            snprintf(nome, sizeof(nome), "%s/lote_%03d.bin", argv[2], arquivos++);
+            FILE *f = fopen(nome, "wb");
+            if (!f) { perror(nome); return 1; }
+            fwrite(buf, 1, n, f);
+            fclose(f);
+            telemetria_confirma_lote(&lote, n);
+        }
+        printf("%d lotes gravados em %s\n", arquivos, argv[2]);
+    }
+
+    if (falhas) {
+        printf("%d falha(s)\n", falhas);
+        return 1;
+    }
+    printf("OK: anel e lotes de telemetria\n");
+    return 0;
+}
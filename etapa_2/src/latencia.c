@@ -0,0 +1,90 @@
+/**
+ * latencia.c - Histogramas log-lineares dos trechos sensor -> PWM
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "latencia.h"
+
+static const char *const nomes[LATENCIA_N_TRECHOS] = {
+    "i2c->classifica",
+    "classifica->decisao",
+    "decisao->pwm",
+    "i2c->pwm",
+    "cor->pwm",
+};
+
+// Início e fim de cada trecho
+static const uint8_t marcas[LATENCIA_N_TRECHOS][2] = {
+    { LATENCIA_I2C,        LATENCIA_CLASSIFICA },
+    { LATENCIA_CLASSIFICA, LATENCIA_DECISAO },
+    { LATENCIA_DECISAO,    LATENCIA_PWM },
+    { LATENCIA_I2C,        LATENCIA_PWM },
+    { LATENCIA_COR,        LATENCIA_PWM },
+};
+
+// Abaixo de 8 us a faixa é o próprio valor; acima, oitava k (2^k .. 2^(k+1))
+// dividida em 8
+static int faixa(uint32_t us) {
+    if (us < LATENCIA_SUB_FAIXAS) return (int) us;
+    int k = 31 - __builtin_clz(us);
+    int i = LATENCIA_SUB_FAIXAS + (k - 3) * LATENCIA_SUB_FAIXAS + (int) ((us >> (k - 3)) & 7u);
+    return i < LATENCIA_FAIXAS ? i : LATENCIA_FAIXAS - 1;
+}
+
+static uint32_t limite_superior(int i) {
+    if (i < LATENCIA_SUB_FAIXAS) return (uint32_t) i;
+    int k = (i - LATENCIA_SUB_FAIXAS) / LATENCIA_SUB_FAIXAS + 3;
+    uint32_t sub = (uint32_t) ((i - LATENCIA_SUB_FAIXAS) % LATENCIA_SUB_FAIXAS);
+    return ((8u + sub + 1u) << (k - 3)) - 1u;
+}
+
+void latencia_zera(Latencia *l) {
+    memset(l, 0, sizeof(*l));
+}
+
+void latencia_registra(LatenciaHistograma *h, uint32_t us) {
+    h->n++;
+    h->soma += us;
+    if (us > h->max) h->max = us;
+    h->faixas[faixa(us)]++;
+}
+
+void latencia_amostra(Latencia *l, const LatenciaMarcas *m) {
+    for (int t = 0; t < LATENCIA_N_TRECHOS; t++) {
+        uint8_t a = marcas[t][0], b = marcas[t][1];
+        if (!(m->tem & (1u << a)) || !(m->tem & (1u << b))) continue;
+        latencia_registra(&l->trecho[t], m->us[b] - m->us[a]);
+    }
+}
+
+uint32_t latencia_percentil(const LatenciaHistograma *h, uint32_t milesimos) {
+    if (!h->n) return 0;
+    // Posição da amostra pedida (1..n), arredondada para cima
+    uint64_t alvo = ((uint64_t) h->n * milesimos + 999u) / 1000u;
+    if (alvo == 0) alvo = 1;
+    uint64_t acumulado = 0;
+    for (int i = 0; i < LATENCIA_FAIXAS; i++) {
+        acumulado += h->faixas[i];
+        if (acumulado >= alvo) {
+            uint32_t v = limite_superior(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+const char *latencia_nome(LatenciaTrecho t) {
+    return nomes[t];
+}
+
+void latencia_relatorio(const Latencia *l) {
+    for (int t = 0; t < LATENCIA_N_TRECHOS; t++) {
+        const LatenciaHistograma *h = &l->trecho[t];
+        if (!h->n) continue;
+        printf("[LAT] %-19s n=%lu us med=%lu p50=%lu p90=%lu p99=%lu max=%lu\n",
+               nomes[t], (unsigned long) h->n, (unsigned long) (h->soma / h->n),
+               (unsigned long) latencia_percentil(h, 500), (unsigned long) latencia_percentil(h, 900),
+               (unsigned long) latencia_percentil(h, 990), (unsigned long) h->max);
+    }
+}
@@ -0,0 +1,202 @@
+/**
+ * mapa_volta.c - Marcos de cor, fatias de curva e base por posição (robô e host)
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "mapa_volta.h"
+
+// Folga absoluta na posição de um marco: a troca de cor só é confirmada
+// algumas leituras depois de começar
+#define FOLGA 128
+
+void mapa_volta_inicia(MapaVolta *m) {
+    memset(m, 0, sizeof(*m));
+    m->escala_q8 = 256;
+}
+
+// Fração de giros da fatia em gravação; fatias puladas (sem decisão) copiam
+static void fecha_fatia(MapaVolta *m, uint16_t ate) {
+    uint8_t q8 = m->decisoes ? (uint8_t) (m->giros * 255u / m->decisoes)
+                             : m->fatia ? m->curva[m->fatia - 1] : 0;
+    while (m->fatia < ate) m->curva[m->fatia++] = q8;
+    m->decisoes = 0;
+    m->giros = 0;
+}
+
+// Marco 0 de uma gravação nova
+static void grava_desde(MapaVolta *m, uint8_t de, uint8_t para) {
+    m->modo = MAPA_APRENDE;
+    m->gravando = true;
+    m->marco[0] = (MapaMarco) { de, para, 0 };
+    m->n_marcos = 1;
+    m->fatia = 0;
+    m->decisoes = 0;
+    m->giros = 0;
+    m->inicio = m->avanco;
+    m->marco_pos = 0;
+    m->escala_q8 = 256;
+}
+
+static void diverge(MapaVolta *m, uint8_t de, uint8_t para) {
+    m->divergencias++;
+    grava_desde(m, de, para);
+}
+
+static void aprende_marco(MapaVolta *m, const MapaVoltaParams *p, uint8_t de, uint8_t para, uint32_t pos) {
+    if (!m->gravando) {
+        grava_desde(m, de, para);
+        return;
+    }
+    // Ida e volta curta (desvio de outra cor numa bifurcação): não é marco
+    const MapaMarco *u = &m->marco[m->n_marcos - 1];
+    if (u->de == para && u->para == de && pos - u->posicao < 4u * p->confirma_avanco) {
+        if (--m->n_marcos == 0) m->gravando = false;
+        return;
+    }
+    if (m->marco[0].de == de && m->marco[0].para == para && m->n_marcos >= 2) {
+        // Volta fechada: pos é o comprimento, a fatia em curso é a última
+        fecha_fatia(m, m->fatia + 1);
+        m->n_fatias = m->fatia;
+        m->comprimento = (uint16_t) pos;
+        m->modo = MAPA_SEGUE;
+        m->gravando = false;
+        m->proximo = 1;
+        m->inicio = m->avanco;
+        m->marco_pos = 0;
+        return;
+    }
+    if (m->n_marcos == MAPA_MAX_MARCOS) {
+        grava_desde(m, de, para);       // pista com marcos demais: recomeça
+        return;
+    }
+    m->marco[m->n_marcos++] = (MapaMarco) { de, para, (uint16_t) pos };
+}
+
+// Posição no mapa: a do último marco mais o avanço desde ele, na escala
+static uint32_t posicao(const MapaVolta *m) {
+    return m->marco_pos + (m->avanco - m->inicio) * 256u / m->escala_q8;
+}
+
+// Posição esperada do próximo marco e tamanho do trecho até ele
+static uint32_t alvo(const MapaVolta *m, uint32_t *trecho) {
+    uint32_t fim = m->proximo ? m->marco[m->proximo].posicao : m->comprimento;
+    *trecho = fim - m->marco[m->proximo ? m->proximo - 1 : m->n_marcos - 1].posicao;
+    return fim;
+}
+
+static void segue_marco(MapaVolta *m, const MapaVoltaParams *p, uint8_t de, uint8_t para, uint32_t pos) {
+    uint32_t trecho, fim = alvo(m, &trecho);
+    uint32_t erro = pos > fim ? pos - fim : fim - pos;
+    const MapaMarco *e = &m->marco[m->proximo];
+    if (e->de != de || e->para != para || erro * 100u > trecho * p->tolerancia_pct + FOLGA * 100u) {
+        diverge(m, de, para);
+        return;
+    }
+    // Ressincroniza no marco e corrige a escala com o trecho que acabou: mais
+    // zigue-zague (base rápida) gasta mais comando no mesmo pedaço de pista
+    uint32_t razao = (m->avanco - m->inicio) * 256u / (trecho ? trecho : 1u);
+    razao = (m->escala_q8 * 3u + razao) / 4u;
+    m->escala_q8 = (uint16_t) (razao < 128u ? 128u : razao > 512u ? 512u : razao);
+    m->inicio = m->avanco;
+    m->marco_pos = (uint16_t) (m->proximo ? fim : 0);
+    if (m->proximo == 0) m->voltas++;
+    if (++m->proximo == m->n_marcos) m->proximo = 0;
+}
+
+// Nenhuma fatia com curva de pos até pos + antecipa (dando a volta no fim)
+static bool reta_a_frente(const MapaVolta *m, const MapaVoltaParams *p, uint32_t pos) {
+    uint32_t de = pos / MAPA_FATIA, ate = (pos + p->antecipa) / MAPA_FATIA;
+    for (uint32_t f = de; f <= ate; f++) {
+        if (m->curva[f % m->n_fatias] >= p->reta_q8) return false;
+    }
+    return true;
+}
+
+uint16_t mapa_volta_passo(MapaVolta *m, const MapaVoltaParams *p, MlDirecao direcao, TipoCor cor,
+                          uint32_t agora_ms, uint16_t base, uint16_t giro) {
+    // Avanço desde a decisão anterior, com o comando que valeu até agora
+    if (m->iniciado && m->comando_avanco > 0) {
+        uint64_t soma = (uint64_t) m->comando_avanco * (agora_ms - m->ultimo_ms) + m->resto;
+        m->avanco += (uint32_t) (soma >> MAPA_AVANCO_SHIFT);
+        m->resto = (uint32_t) (soma & ((1u << MAPA_AVANCO_SHIFT) - 1));
+    }
+    m->ultimo_ms = agora_ms;
+    m->iniciado = true;
+
+    // Troca de cor: a nova N vezes e a atual sumida por confirma_avanco
+    bool marco = false;
+    uint8_t de = m->cor;
+    if (cor == m->cor) {
+        m->antiga_vista = m->avanco;
+        m->n_cor_nova = 0;
+    } else if (cor != COR_NENHUMA) {
+        if (cor != m->cor_nova) {
+            m->cor_nova = (uint8_t) cor;
+            m->n_cor_nova = 0;
+        }
+        if (m->n_cor_nova < MAPA_CONFIRMA_COR) m->n_cor_nova++;
+    }
+    if (m->n_cor_nova >= MAPA_CONFIRMA_COR &&
+        (m->cor == COR_NENHUMA || m->avanco - m->antiga_vista >= p->confirma_avanco)) {
+        marco = m->cor != COR_NENHUMA;      // a primeira cor da partida não é troca
+        m->cor = m->cor_nova;
+        m->antiga_vista = m->avanco;
+        m->n_cor_nova = 0;
+    }
+
+    uint32_t pos = posicao(m);
+    if (m->modo == MAPA_APRENDE) {
+        if (m->gravando) {
+            if (pos >= (uint32_t) MAPA_MAX_FATIAS * MAPA_FATIA) {
+                m->gravando = false;        // volta longa demais para o mapa
+                m->n_marcos = 0;
+            } else {
+                if (pos / MAPA_FATIA != m->fatia) fecha_fatia(m, (uint16_t) (pos / MAPA_FATIA));
+                m->decisoes++;
+                m->giros += direcao != ML_DIRECAO_RETO;
+            }
+        }
+        if (marco) aprende_marco(m, p, de, m->cor, pos);
+    } else if (marco) {
+        segue_marco(m, p, de, m->cor, pos);
+    } else {
+        uint32_t trecho, fim = alvo(m, &trecho);
+        if (pos * 100u > fim * 100u + trecho * p->tolerancia_pct + FOLGA * 100u) {
+            m->divergencias++;              // o próximo marco não chegou
+            m->modo = MAPA_APRENDE;
+            m->gravando = false;
+            m->n_marcos = 0;
+        }
+    }
+
+    uint16_t usada = base;
+    if (m->modo == MAPA_SEGUE && reta_a_frente(m, p, posicao(m))) {
+        uint32_t rapida = (uint32_t) base * p->rapido_q8 >> 8;
+        usada = (uint16_t) (rapida > 65535u ? 65535u : rapida);
+    }
+
+    // Avanço até a próxima decisão: média das rodas de rumo_malha_aberta (a
+    // esquerda leva a base nos dois giros, então à esquerda o avanço é ré)
+    m->comando_avanco = direcao == ML_DIRECAO_RETO    ? usada :
+                        direcao == ML_DIRECAO_DIREITA ? ((int32_t) usada - giro) / 2
+                                                      : ((int32_t) giro - usada) / 2;
+    return usada;
+}
+
+void mapa_volta_relatorio(const MapaVolta *m) {
+    static const char cores[] = "-avm";
+
+    printf("[MAPA] %s, %u marcos, %u fatias, %lu voltas, %lu divergencias\n",
+           m->modo == MAPA_SEGUE ? "seguindo" : m->gravando ? "aprendendo" : "esperando marco",
+           m->n_marcos, m->modo == MAPA_SEGUE ? m->n_fatias : m->fatia,
+           (unsigned long) m->voltas, (unsigned long) m->divergencias);
+    if (m->modo != MAPA_SEGUE) return;
+    printf("[MAPA] marcos");
+    for (int i = 0; i < m->n_marcos; i++) {
+        printf(" %c%c@%u", cores[m->marco[i].de & 3], cores[m->marco[i].para & 3], m->marco[i].posicao);
+    }
+    printf(" | volta %u\n[MAPA] curvas ", m->comprimento);
+    for (int f = 0; f < m->n_fatias; f++) putchar(" .:-=+*#%@"[m->curva[f] * 10u / 256u]);
+    putchar('\n');
+}
@@ -0,0 +1,111 @@
+/**
+ * memoria.c - Trava de alocação no caminho de inferência e relatório de RAM
+ *
+ * As funções de alocação são interceptadas no link (-Wl,--wrap):
+ *   _malloc_r/_calloc_r/_realloc_r  -> todo malloc da newlib e o new do C++
+ *                                      (PICO_CXX_DISABLE_ALLOCATION_OVERRIDES=1
+ *                                      faz o new cair no malloc)
+ *   pvPortMalloc                    -> heap_4 do FreeRTOS
+ * O malloc/calloc do Pico SDK já usam --wrap=malloc; por isso a interceptação
+ * é um nível abaixo, nas funções reentrantes da newlib.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <reent.h>
+
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "memoria.h"
+
+#if __has_include("arena_tflm.h")
+uint8_t arena_tflm[ARENA_TFLM_BYTES] MEMORIA_ARENA(tflm);
+#endif
+
+// Símbolos do linker script do Pico SDK (início e fim do heap da newlib)
+extern char __end__;
+extern char __HeapLimit;
+
+// Tarefa que está no caminho de inferência (NULL = nenhuma)
+static TaskHandle_t volatile tarefa_inferindo = NULL;
+
+static void verifica_alocacao(const char *origem, size_t bytes) {
+    if (tarefa_inferindo == NULL || xTaskGetCurrentTaskHandle() != tarefa_inferindo) {
+        return;
+    }
+    // Solta a trava antes: o printf do panic pode alocar
+    tarefa_inferindo = NULL;
+    panic("%s(%u) no caminho de inferencia (tarefa %s)", origem, (unsigned) bytes,
+          pcTaskGetName(NULL));
+}
+
+// --- INTERCEPTAÇÃO (-Wl,--wrap) ---
+
+void *__real__malloc_r(struct _reent *r, size_t bytes);
+void *__real__calloc_r(struct _reent *r, size_t n, size_t bytes);
+void *__real__realloc_r(struct _reent *r, void *p, size_t bytes);
+void *__real_pvPortMalloc(size_t bytes);
+
+void *__wrap__malloc_r(struct _reent *r, size_t bytes) {
+    verifica_alocacao("malloc", bytes);
+    return __real__malloc_r(r, bytes);
+}
+
+void *__wrap__calloc_r(struct _reent *r, size_t n, size_t bytes) {
+    verifica_alocacao("calloc", n * bytes);
+    return __real__calloc_r(r, n, bytes);
+}
+
+void *__wrap__realloc_r(struct _reent *r, void *p, size_t bytes) {
+    verifica_alocacao("realloc", bytes);
+    return __real__realloc_r(r, p, bytes);
+}
+
+void *__wrap_pvPortMalloc(size_t bytes) {
+    verifica_alocacao("pvPortMalloc", bytes);
+    return __real_pvPortMalloc(bytes);
+}
+
+// --- API ---
+
+void memoria_inferencia_inicio(void) {
+    tarefa_inferindo = xTaskGetCurrentTaskHandle();
+}
+
+void memoria_inferencia_fim(void) {
+    tarefa_inferindo = NULL;
+}
+
+size_t memoria_heap_pico(void) {
+    // A newlib só aumenta o break (sbrk) e não devolve: o break é o pico
+    return (size_t) ((char *) sbrk(0) - &__end__);
+}
+
+void memoria_relatorio(void) {
+    printf("[MEM] heap_newlib pico=%u limite=%u\n", (unsigned) memoria_heap_pico(),
+           (unsigned) (&__HeapLimit - &__end__));
+    printf("[MEM] heap_freertos total=%u livre=%u livre_min=%u\n",
+           (unsigned) configTOTAL_HEAP_SIZE, (unsigned) xPortGetFreeHeapSize(),
+           (unsigned) xPortGetMinimumEverFreeHeapSize());
+
+#if configUSE_TRACE_FACILITY
+    UBaseType_t n = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tarefas = pvPortMalloc(n * sizeof(TaskStatus_t));
+    if (tarefas == NULL) {
+        printf("[MEM] sem heap para listar %u tarefas\n", (unsigned) n);
+        return;
+    }
+    n = uxTaskGetSystemState(tarefas, n, NULL);
+    for (UBaseType_t i = 0; i < n; i++) {
+        printf("[MEM] pilha tarefa=%s livre_min=%u\n", tarefas[i].pcTaskName,
+               (unsigned) (tarefas[i].usStackHighWaterMark * sizeof(StackType_t)));
+    }
+    vPortFree(tarefas);
+#else
+    printf("[MEM] pilha tarefa=%s livre_min=%u\n", pcTaskGetName(NULL),
+           (unsigned) (uxTaskGetStackHighWaterMark(NULL) * sizeof(StackType_t)));
+#endif
+}
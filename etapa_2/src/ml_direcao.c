@@ -0,0 +1,157 @@
+/**
+ * ml_direcao.c - Classificador de direção int8 (arena estática, sem alocação)
+ */
+#include <string.h>
+
+#include "ml_direcao.h"
+#include "ciclos.h"
+#include "memoria.h"
+
+#if ML_DIRECAO_CMSIS
+#include "arm_nnfunctions.h"
+#endif
+
+#define CARACTERISTICAS_POR_LEITURA (2 * MODELO_DIRECAO_POR_SENSOR)
+
+// Arena: [entrada (janela de histórico, mais recente primeiro) | oculta | saída]
+static int8_t arena[ML_DIRECAO_ARENA_BYTES] MEMORIA_ARENA(ml_direcao);
+static int8_t *const entrada = arena;
+static int8_t *const oculta  = arena + MODELO_DIRECAO_ENTRADAS;
+static int8_t *const saida   = arena + MODELO_DIRECAO_ENTRADAS + MODELO_DIRECAO_OCULTA;
+
+static uint8_t leituras = 0;
+static MlDirecaoEstatisticas estat;
+
+// --- ARITMÉTICA INTEIRA (igual ao arm_nn_requantize do CMSIS-NN) ---
+#if !ML_DIRECAO_CMSIS
+
+static int32_t mult_alta_arredondada(int32_t a, int32_t b) {
+    int64_t ab = (int64_t) a * b;
+    int64_t ajuste = ab >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+    return (int32_t) ((ab + ajuste) / (1ll << 31));
+}
+
+static int32_t divide_pot2_arredondada(int32_t x, int32_t expoente) {
+    int32_t mascara = (1 << expoente) - 1;
+    int32_t resto = x & mascara;
+    int32_t limite = (mascara >> 1) + (x < 0 ? 1 : 0);
+    return (x >> expoente) + (resto > limite ? 1 : 0);
+}
+
+static int32_t requantiza(int32_t acc, int32_t mult, int32_t shift) {
+    int32_t esquerda = shift > 0 ? shift : 0;
+    int32_t direita  = shift > 0 ? 0 : -shift;
+    return divide_pot2_arredondada(mult_alta_arredondada(acc * (1 << esquerda), mult), direita);
+}
+
+#endif
+
+// Camada densa int8 com pesos [saída][entrada]; ReLU vem do clamp em -128
+// quando o zero point da saída é -128
+static void densa(const int8_t *x, int n_entradas, const int8_t *w, const int32_t *b, int n_saidas,
+                  int32_t zp_entrada, int32_t mult, int32_t shift, int32_t zp_saida, int8_t *y) {
+#if ML_DIRECAO_CMSIS
+    cmsis_nn_context ctx = { .buf = NULL, .size = 0 };
+    cmsis_nn_fc_params fc = {
+        .input_offset = -zp_entrada,
+        .filter_offset = 0,
+        .output_offset = zp_saida,
+        .activation = { .min = -128, .max = 127 },
+    };
+    cmsis_nn_per_tensor_quant_params quant = { .multiplier = mult, .shift = shift };
+    cmsis_nn_dims dim_entrada = { .n = 1, .h = 1, .w = 1, .c = n_entradas };
+    cmsis_nn_dims dim_filtro  = { .n = n_entradas, .h = 1, .w = 1, .c = n_saidas };
+    cmsis_nn_dims dim_bias    = { .n = 1, .h = 1, .w = 1, .c = n_saidas };
+    cmsis_nn_dims dim_saida   = { .n = 1, .h = 1, .w = 1, .c = n_saidas };
+
+    arm_fully_connected_s8(&ctx, &fc, &quant, &dim_entrada, x, &dim_filtro, w,
+                           &dim_bias, b, &dim_saida, y);
+#else
+    for (int o = 0; o < n_saidas; o++) {
+        const int8_t *linha = w + o * n_entradas;
+        int32_t acc = b[o];
+        for (int i = 0; i < n_entradas; i++) {
+            acc += ((int32_t) x[i] - zp_entrada) * linha[i];
+        }
+        int32_t v = requantiza(acc, mult, shift) + zp_saida;
+        if (v < -128) v = -128;
+        if (v > 127) v = 127;
+        y[o] = (int8_t) v;
+    }
+#endif
+}
+
+// --- API ---
+
+void ml_direcao_init(void) {
+    memset(arena, 0, sizeof(arena));
+    memset(&estat, 0, sizeof(estat));
+    estat.ciclos_min = UINT32_MAX;
+    leituras = 0;
+    ciclos_init();
+}
+
+void ml_direcao_caracteristicas(uint16_t r, uint16_t g, uint16_t b, uint16_t c, int8_t *out) {
+    if (c == 0) {
+        out[0] = out[1] = out[2] = out[3] = 0;
+        return;
+    }
+    uint32_t rq = (r * 127u) / c;
+    uint32_t gq = (g * 127u) / c;
+    uint32_t bq = (b * 127u) / c;
+    uint32_t cq = c >> 4;
+    out[0] = (int8_t) (rq > 127 ? 127 : rq);
+    out[1] = (int8_t) (gq > 127 ? 127 : gq);
+    out[2] = (int8_t) (bq > 127 ? 127 : bq);
+    out[3] = (int8_t) (cq > 127 ? 127 : cq);
+}
+
+void ml_direcao_amostra(const uint16_t esq_rgbc[4], const uint16_t dir_rgbc[4]) {
+    // Desloca a janela uma leitura para trás; a mais recente fica no início
+    memmove(entrada + CARACTERISTICAS_POR_LEITURA, entrada,
+            MODELO_DIRECAO_ENTRADAS - CARACTERISTICAS_POR_LEITURA);
+    ml_direcao_caracteristicas(esq_rgbc[0], esq_rgbc[1], esq_rgbc[2], esq_rgbc[3], entrada);
+    ml_direcao_caracteristicas(dir_rgbc[0], dir_rgbc[1], dir_rgbc[2], dir_rgbc[3],
+                               entrada + MODELO_DIRECAO_POR_SENSOR);
+    if (leituras < MODELO_DIRECAO_HISTORICO) leituras++;
+}
+
+bool ml_direcao_pronto(void) {
+    return leituras >= MODELO_DIRECAO_HISTORICO;
+}
+
+void ml_direcao_infere_vetor(const int8_t x[MODELO_DIRECAO_ENTRADAS],
+                             int8_t logits[MODELO_DIRECAO_CLASSES]) {
+    uint32_t inicio = ciclos_le();
+
+    densa(x, MODELO_DIRECAO_ENTRADAS, modelo_direcao_w1, modelo_direcao_b1, MODELO_DIRECAO_OCULTA,
+          MODELO_DIRECAO_ENTRADA_ZP, MODELO_DIRECAO_OCULTA_MULT, MODELO_DIRECAO_OCULTA_SHIFT,
+          MODELO_DIRECAO_OCULTA_ZP, oculta);
+    densa(oculta, MODELO_DIRECAO_OCULTA, modelo_direcao_w2, modelo_direcao_b2, MODELO_DIRECAO_CLASSES,
+          MODELO_DIRECAO_OCULTA_ZP, MODELO_DIRECAO_SAIDA_MULT, MODELO_DIRECAO_SAIDA_SHIFT,
+          MODELO_DIRECAO_SAIDA_ZP, saida);
+
+    uint32_t ciclos = ciclos_decorridos(inicio, ciclos_le());
+    estat.inferencias++;
+    estat.ciclos_ultimo = ciclos;
+    estat.ciclos_soma += ciclos;
+    if (ciclos < estat.ciclos_min) estat.ciclos_min = ciclos;
+    if (ciclos > estat.ciclos_max) estat.ciclos_max = ciclos;
+
+    if (logits) memcpy(logits, saida, MODELO_DIRECAO_CLASSES);
+}
+
+MlDirecao ml_direcao_infere(int8_t logits[MODELO_DIRECAO_CLASSES]) {
+    ml_direcao_infere_vetor(entrada, logits);
+
+    // Softmax é monotônica: a classe é o maior logit
+    int melhor = 0;
+    for (int i = 1; i < MODELO_DIRECAO_CLASSES; i++) {
+        if (saida[i] > saida[melhor]) melhor = i;
+    }
+    return (MlDirecao) melhor;
+}
+
+const MlDirecaoEstatisticas *ml_direcao_estatisticas(void) {
+    return &estat;
+}
@@ -0,0 +1,81 @@
+/**
+ * motor.c - Inicialização da ponte H, fatias de PWM em fase e rampa por timer
+ */
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+#include "motor.h"
+
+static MotorRampa rampa;
+static spin_lock_t *trava;              // alvo e atual (tarefa do motor x timer, qualquer núcleo)
+static int32_t alvo[2], atual[2];
+static uint32_t n_alvo, n_no_sentido, no_sentido_us;    // motor_no_sentido()
+static repeating_timer_t timer_rampa;
+
+// A escrita da ponte fica dentro da trava: um motor_para() no outro núcleo
+// nunca é desfeito por um tique que já tinha lido o valor antigo
+static bool tique_rampa(repeating_timer_t *t) {
+    uint32_t estado = spin_lock_blocking(trava);
+    for (int i = 0; i < 2; i++) atual[i] = motor_rampa_passo(atual[i], alvo[i], rampa.passo[i]);
+    motor_aplica(atual[0], atual[1]);
+    if (n_no_sentido != n_alvo && motor_mesmo_sentido(atual[0], alvo[0]) &&
+        motor_mesmo_sentido(atual[1], alvo[1])) {
+        n_no_sentido = n_alvo;
+        no_sentido_us = time_us_32();
+    }
+    spin_unlock(trava, estado);
+    return true;
+}
+
+bool motor_inicia(const MotorRampa *r) {
+    rampa = *r;
+    trava = spin_lock_init(spin_lock_claim_unused(true));
+
+    const uint32_t saidas = MOTOR_MASCARA_SENTIDO | MOTOR_BIT(MOTOR_STBY);
+    gpio_init_mask(saidas);
+    gpio_set_dir_out_masked(saidas);
+    gpio_put_masked(saidas, MOTOR_BIT(MOTOR_STBY));
+
+    // pwm_init zera contador e CC; as duas ficam paradas até o fim
+    pwm_config cfg = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&cfg, 1);
+    pwm_config_set_phase_correct(&cfg, MOTOR_FASE_CORRETA);
+    pwm_config_set_wrap(&cfg, MOTOR_PWM_TOPO);
+    pwm_init(MOTOR_FATIA(MOTOR_ESQ_PWM), &cfg, false);
+    pwm_init(MOTOR_FATIA(MOTOR_DIR_PWM), &cfg, false);
+    gpio_set_function(MOTOR_ESQ_PWM, GPIO_FUNC_PWM);
+    gpio_set_function(MOTOR_DIR_PWM, GPIO_FUNC_PWM);
+
+    // Um store no EN liga as duas juntas (sem mexer nas outras fatias)
+    hw_set_bits(&pwm_hw->en, MOTOR_BIT(MOTOR_FATIA(MOTOR_ESQ_PWM)) | MOTOR_BIT(MOTOR_FATIA(MOTOR_DIR_PWM)));
+
+    // Negativo: período entre inícios, não entre fins de callback
+    return add_repeating_timer_us(-MOTOR_RAMPA_US, tique_rampa, NULL, &timer_rampa);
+}
+
+uint32_t motor_alvo(int32_t esq, int32_t dir) {
+    uint32_t estado = spin_lock_blocking(trava);
+    alvo[0] = esq;
+    alvo[1] = dir;
+    uint32_t n = ++n_alvo;
+    spin_unlock(trava, estado);
+    return n;
+}
+
+bool motor_no_sentido(uint32_t n, uint32_t *us) {
+    uint32_t estado = spin_lock_blocking(trava);
+    bool chegou = (int32_t) (n_no_sentido - n) >= 0;
+    if (chegou) *us = no_sentido_us;
+    spin_unlock(trava, estado);
+    return chegou;
+}
+
+void motor_para(void) {
+    uint32_t estado = spin_lock_blocking(trava);
+    alvo[0] = alvo[1] = 0;
+    atual[0] = atual[1] = 0;
+    motor_aplica(0, 0);
+    spin_unlock(trava, estado);
+}
@@ -0,0 +1,127 @@
+/**
+ * mpu6050_fifo.c - Configuração da FIFO e leitura em rajada do giroscópio Z
+ */
+#include "pico/stdlib.h"
+
+#include "mpu6050_fifo.h"
+
+// Registradores usados
+#define REG_SMPLRT_DIV   0x19
+#define REG_CONFIG       0x1A
+#define REG_GYRO_CONFIG  0x1B
+#define REG_FIFO_EN      0x23
+#define REG_INT_STATUS   0x3A
+#define REG_USER_CTRL    0x6A
+#define REG_PWR_MGMT_1   0x6B
+#define REG_FIFO_COUNTH  0x72
+#define REG_FIFO_R_W     0x74
+#define REG_WHO_AM_I     0x75
+
+#define FIFO_EN_ZG       0x10
+#define USER_FIFO_EN     0x40
+#define USER_FIFO_RESET  0x04
+#define INT_FIFO_OFLOW   0x10
+#define FIFO_BYTES       1024
+#define AMOSTRA_BYTES    2
+
+#define I2C_TIMEOUT_US   2000
+
+static BarramentoDispositivo *dispositivo;
+static Mpu6050Estatisticas estat;
+
+static bool escreve8(uint8_t reg, uint8_t valor) {
+    uint8_t buf[2] = { reg, valor };
+    return barramento_escreve(dispositivo, buf, 2) == 2;
+}
+
+bool mpu6050_init(BarramentoDispositivo *disp) {
+    dispositivo = disp;
+
+    uint8_t quem = 0;
+    if (barramento_le_reg(dispositivo, REG_WHO_AM_I, &quem, 1) != 1 || quem != 0x68) return false;
+
+    escreve8(REG_PWR_MGMT_1, 0x01);                  // acorda, relógio do PLL do giro X
+    sleep_ms(10);
+    escreve8(REG_CONFIG, 0x03);                      // DLPF 44 Hz: giro interno a 1 kHz
+    escreve8(REG_SMPLRT_DIV, 1000 / MPU6050_TAXA_HZ - 1);
+    escreve8(REG_GYRO_CONFIG, 0x00);                 // ±250 °/s
+
+    mpu6050_zera_fifo();
+    return escreve8(REG_FIFO_EN, FIFO_EN_ZG);
+}
+
+void mpu6050_zera_fifo(void) {
+    escreve8(REG_USER_CTRL, USER_FIFO_RESET);
+    escreve8(REG_USER_CTRL, USER_FIFO_EN);
+}
+
+static bool le(i2c_inst_t *i2c, uint8_t endereco, uint8_t reg, uint8_t *dados, size_t n) {
+    if (i2c_write_timeout_us(i2c, endereco, &reg, 1, true, I2C_TIMEOUT_US) != 1) return false;
+    return i2c_read_timeout_us(i2c, endereco, dados, n, false,
+                               I2C_TIMEOUT_US + (uint32_t) n * 25u) == (int) n;
+}
+
+static bool escreve8_direto(i2c_inst_t *i2c, uint8_t endereco, uint8_t reg, uint8_t valor) {
+    uint8_t buf[2] = { reg, valor };
+    return i2c_write_timeout_us(i2c, endereco, buf, 2, false, I2C_TIMEOUT_US) == 2;
+}
+
+typedef struct {
+    uint8_t buf[MPU6050_FIFO_MAX * AMOSTRA_BYTES];
+    int max;
+    int n;
+} LeituraFifo;
+
+// Roda na tarefa do barramento: contador e rajada sem soltar o I2C
+static int le_fifo_no_barramento(i2c_inst_t *i2c, uint8_t endereco, BarramentoPedido *p) {
+    LeituraFifo *l = p->contexto;
+    uint8_t contador[2];
+    uint32_t t0 = time_us_32();
+
+    l->n = 0;
+    if (!le(i2c, endereco, REG_FIFO_COUNTH, contador, 2)) return PICO_ERROR_GENERIC;
+    uint32_t bytes = (uint32_t) (contador[0] << 8 | contador[1]);
+
+    // Cheia, a FIFO sobrescreve e perde o alinhamento das amostras: recomeça
+    if (bytes >= FIFO_BYTES) {
+        uint8_t status;
+        le(i2c, endereco, REG_INT_STATUS, &status, 1);     // limpa o FIFO_OFLOW_INT
+        escreve8_direto(i2c, endereco, REG_USER_CTRL, USER_FIFO_RESET);
+        escreve8_direto(i2c, endereco, REG_USER_CTRL, USER_FIFO_EN);
+        estat.transbordos++;
+        return 0;
+    }
+
+    uint32_t n = bytes / AMOSTRA_BYTES;
+    if (n > (uint32_t) l->max) n = (uint32_t) l->max;      // o resto fica para o próximo período
+    if (n > 0 && !le(i2c, endereco, REG_FIFO_R_W, l->buf, n * AMOSTRA_BYTES)) return PICO_ERROR_GENERIC;
+
+    uint32_t dt = time_us_32() - t0;
+    estat.barramento_ultimo_us = dt;
+    estat.barramento_soma_us += dt;
+    if (dt > estat.barramento_max_us) estat.barramento_max_us = dt;
+
+    l->n = (int) n;
+    return (int) (n * AMOSTRA_BYTES);
+}
+
+int mpu6050_le_fifo(int16_t *gz, int max) {
+    LeituraFifo l = { .max = max > MPU6050_FIFO_MAX ? MPU6050_FIFO_MAX : max };
+    BarramentoPedido p = { .funcao = le_fifo_no_barramento, .contexto = &l };
+
+    estat.leituras++;
+    if (barramento_executa(dispositivo, &p) < 0) {
+        estat.falhas++;
+        return -1;
+    }
+
+    for (int i = 0; i < l.n; i++) {
+        gz[i] = (int16_t) (l.buf[2 * i] << 8 | l.buf[2 * i + 1]);
+    }
+    estat.amostras += (uint32_t) l.n;
+    return l.n;
+}
+
+const Mpu6050Estatisticas *mpu6050_estatisticas(void) {
+    return &estat;
+}
@@ -0,0 +1,321 @@
+/**
+ * oled.c - Quadro do SSD1306, regiões sujas e envio em blocos por DMA
+ */
+#include <string.h>
+
+#include "oled.h"
+
+// --- QUADRO ---
+
+// Fonte 5x7 (colunas, bit 0 em cima) de ' ' a 'Z'
+#define FONTE_PRIMEIRO ' '
+#define FONTE_ULTIMO   'Z'
+
+static const uint8_t fonte[][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, // ' ' '!'
+    { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, // '"' '#'
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // '$' '%'
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, // '&' '''
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, // '(' ')'
+    { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // '*' '+'
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, // ',' '-'
+    { 0x00, 0x00, 0x60, 0x60, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 }, // '.' '/'
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // '0' '1'
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, // '2' '3'
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, // '4' '5'
+    { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 }, // '6' '7'
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, // '8' '9'
+    { 0x00, 0x00, 0x14, 0x00, 0x00 }, { 0x00, 0x40, 0x34, 0x00, 0x00 }, // ':' ';'
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // '<' '='
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, // '>' '?'
+    { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, { 0x7C, 0x12, 0x11, 0x12, 0x7C }, // '@' 'A'
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // 'B' 'C'
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, // 'D' 'E'
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x73 }, // 'F' 'G'
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // 'H' 'I'
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // 'J' 'K'
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, // 'L' 'M'
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // 'N' 'O'
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, // 'P' 'Q'
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x26, 0x49, 0x49, 0x49, 0x32 }, // 'R' 'S'
+    { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // 'T' 'U'
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, // 'V' 'W'
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, // 'X' 'Y'
+    { 0x61, 0x59, 0x49, 0x4D, 0x43 },                                   // 'Z'
+};
+
+_Static_assert(sizeof(fonte) / sizeof(fonte[0]) == FONTE_ULTIMO - FONTE_PRIMEIRO + 1,
+               "fonte incompleta");
+
+void oled_quadro_inicia(OledQuadro *q) {
+    memset(q->quadro, 0, sizeof(q->quadro));
+    memset(q->suja_ini, 0, sizeof(q->suja_ini));
+    memset(q->suja_fim, OLED_LARGURA - 1, sizeof(q->suja_fim));
+}
+
+static void marca_suja(OledQuadro *q, int pagina, int coluna) {
+    if (q->suja_ini[pagina] > q->suja_fim[pagina]) {
+        q->suja_ini[pagina] = q->suja_fim[pagina] = (uint8_t) coluna;
+    } else if (coluna < q->suja_ini[pagina]) {
+        q->suja_ini[pagina] = (uint8_t) coluna;
+    } else if (coluna > q->suja_fim[pagina]) {
+        q->suja_fim[pagina] = (uint8_t) coluna;
+    }
+}
+
+static void poe_byte(OledQuadro *q, int pagina, int coluna, uint8_t v) {
+    if (q->quadro[pagina][coluna] == v) return;
+    q->quadro[pagina][coluna] = v;
+    marca_suja(q, pagina, coluna);
+}
+
+static void poe_caractere(OledQuadro *q, int linha, int x, char c) {
+    if (c >= 'a' && c <= 'z') c = (char) (c - 'a' + 'A');
+    if (c < FONTE_PRIMEIRO || c > FONTE_ULTIMO) c = ' ';
+    const uint8_t *g = fonte[c - FONTE_PRIMEIRO];
+    for (int i = 0; i < 5; i++) poe_byte(q, linha, x + i, g[i]);
+    poe_byte(q, linha, x + 5, 0);
+}
+
+void oled_quadro_texto(OledQuadro *q, int linha, int coluna, const char *s) {
+    if (linha < 0 || linha >= OLED_PAGINAS) return;
+    for (; *s && coluna < OLED_COLUNAS_TEXTO; s++, coluna++) {
+        poe_caractere(q, linha, coluna * 6, *s);
+    }
+}
+
+void oled_quadro_campo(OledQuadro *q, int linha, int coluna, int largura, const char *s) {
+    if (linha < 0 || linha >= OLED_PAGINAS) return;
+    for (int i = 0; i < largura && coluna < OLED_COLUNAS_TEXTO; i++, coluna++) {
+        poe_caractere(q, linha, coluna * 6, *s ? *s++ : ' ');
+    }
+}
+
+bool oled_quadro_sujo(const OledQuadro *q) {
+    for (int p = 0; p < OLED_PAGINAS; p++) {
+        if (q->suja_ini[p] <= q->suja_fim[p]) return true;
+    }
+    return false;
+}
+
+int oled_quadro_proximo_bloco(OledQuadro *q, uint8_t bloco[OLED_BLOCO_MAX]) {
+    int p = 0;
+    while (p < OLED_PAGINAS && q->suja_ini[p] > q->suja_fim[p]) p++;
+    if (p == OLED_PAGINAS) return 0;
+
+    int ini = q->suja_ini[p];
+    int fim = q->suja_fim[p];
+    if (fim - ini + 1 > OLED_BLOCO_COLUNAS) fim = ini + OLED_BLOCO_COLUNAS - 1;
+
+    // O resto da faixa (se houver) fica para o próximo bloco
+    if (fim == q->suja_fim[p]) {
+        q->suja_ini[p] = 1;
+        q->suja_fim[p] = 0;
+    } else {
+        q->suja_ini[p] = (uint8_t) (fim + 1);
+    }
+
+    // Co=1 (0x80) antes de cada comando; 0x40 abre os dados até o STOP
+    const uint8_t cabecalho[OLED_BLOCO_CABECALHO] = {
+        0x80, 0x21, 0x80, (uint8_t) ini, 0x80, (uint8_t) fim,   // faixa de colunas
+        0x80, 0x22, 0x80, (uint8_t) p, 0x80, (uint8_t) p,       // uma página (OLED_BLOCO_PAGINA)
+        0x40,
+    };
+    memcpy(bloco, cabecalho, sizeof(cabecalho));
+    memcpy(bloco + OLED_BLOCO_CABECALHO, &q->quadro[p][ini], (size_t) (fim - ini + 1));
+    return OLED_BLOCO_CABECALHO + fim - ini + 1;
+}
+
+// --- DISPLAY ---
+
+#if PICO_ON_DEVICE
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#include "task.h"
+#include "ciclos.h"
+
+#define BLOCO_TIMEOUT_MS 5        // 45 bytes a 400 kHz levam ~1 ms
+
+static OledConfig config;
+static void (*desenha_cb)(OledQuadro *q);
+static OledQuadro quadro;
+static TaskHandle_t tarefa;
+static int canal_dma;
+static dma_channel_config dma_cfg;
+static uint16_t palavras[OLED_BLOCO_MAX];    // DATA_CMD: byte + STOP no último
+// Fim do bloco (interrupção -> tarefa do barramento). Semáforo, não
+// notificação: a tarefa do barramento já usa a dela para pedidos novos
+static SemaphoreHandle_t bloco_fim;
+
+static OledEstatisticas estat;
+
+typedef struct {
+    const uint8_t *bytes;
+    int n;
+} Bloco;
+
+// STOP ou abort do bloco: a máscara só fica ligada durante um bloco, então os
+// pedidos do sensor no mesmo controlador (por varredura) não chegam aqui
+static void irq_i2c(void) {
+    i2c_get_hw(config.disp->barramento->i2c)->intr_mask = 0;
+    BaseType_t acordou = pdFALSE;
+    xSemaphoreGiveFromISR(bloco_fim, &acordou);
+    portYIELD_FROM_ISR(acordou);
+}
+
+// Roda na tarefa do barramento: uma transação por DMA, dormindo até a
+// interrupção de STOP (a CPU fica livre e o barramento volta logo ao sensor)
+static int envia_bloco(i2c_inst_t *i2c, uint8_t endereco, BarramentoPedido *p) {
+    const Bloco *bloco = p->contexto;
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    int n = bloco->n;
+
+    for (int i = 0; i < n; i++) palavras[i] = bloco->bytes[i];
+    palavras[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // O SDK também reprograma o TAR a cada transação bloqueante
+    hw->enable = 0;
+    hw->tar = endereco;
+    hw->enable = 1;
+    (void) hw->clr_stop_det;
+    xSemaphoreTake(bloco_fim, 0);             // descarta aviso atrasado de um bloco perdido
+
+    uint32_t t0 = time_us_32();
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    dma_channel_configure(canal_dma, &dma_cfg, &hw->data_cmd, palavras, (uint) n, true);
+
+    // Timeout deixa o escalonador destravar e reiniciar o controlador
+    int resultado = n;
+    if (xSemaphoreTake(bloco_fim, pdMS_TO_TICKS(BLOCO_TIMEOUT_MS)) != pdTRUE) {
+        hw->intr_mask = 0;
+        resultado = PICO_ERROR_TIMEOUT;
+    }
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) resultado = PICO_ERROR_GENERIC;
+    if (resultado < 0) {
+        dma_channel_abort(canal_dma);
+        (void) hw->clr_tx_abrt;
+        estat.falhas++;
+    }
+    (void) hw->clr_stop_det;
+
+    uint32_t dt = time_us_32() - t0;
+    if (dt > estat.bloco_max_us) estat.bloco_max_us = dt;
+    estat.blocos++;
+    estat.bytes += (uint32_t) n;
+    return resultado;
+}
+
+static void tarefa_oled(void *arg) {
+    uint8_t bloco[OLED_BLOCO_MAX];
+    uint32_t ultimo_desenho = time_us_32();
+
+    for (;;) {
+        // Sem sensor rodando a janela não abre: desenha no período mesmo assim
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(config.periodo_desenho_ms));
+        uint32_t inicio = time_us_32();
+        uint32_t ciclos = 0;
+        bool atualizou = false;
+        estat.janelas++;
+
+        if (inicio - ultimo_desenho >= config.periodo_desenho_ms * 1000u) {
+            ultimo_desenho = inicio;
+            uint32_t c0 = ciclos_le();
+            desenha_cb(&quadro);
+            ciclos += ciclos_decorridos(c0, ciclos_le());
+            atualizou = true;
+        }
+
+        while (oled_quadro_sujo(&quadro) && time_us_32() - inicio < config.janela_us) {
+            uint32_t c0 = ciclos_le();
+            Bloco b = { .bytes = bloco, .n = oled_quadro_proximo_bloco(&quadro, bloco) };
+            ciclos += ciclos_decorridos(c0, ciclos_le());
+
+            BarramentoPedido p = { .funcao = envia_bloco, .contexto = &b };
+            int r = barramento_executa(config.disp, &p);
+            atualizou = true;
+
+            // Bloco perdido: reenviar a página inteira na próxima janela
+            if (r < 0) {
+                uint8_t pagina = bloco[OLED_BLOCO_PAGINA];
+                quadro.suja_ini[pagina] = 0;
+                quadro.suja_fim[pagina] = OLED_LARGURA - 1;
+                break;
+            }
+        }
+        if (oled_quadro_sujo(&quadro)) estat.janelas_curtas++;
+
+        if (atualizou) {
+            estat.atualizacoes++;
+            estat.ciclos_soma += ciclos;
+            if (ciclos > estat.ciclos_max) estat.ciclos_max = ciclos;
+        }
+    }
+}
+
+bool oled_inicia(const OledConfig *cfg, UBaseType_t prioridade, void (*desenha)(OledQuadro *q)) {
+    static const uint8_t init[] = {
+        0x00,                      // Co=0, D/C=0: só comandos
+        0xAE,                      // desliga
+        0xD5, 0x80,                // clock
+        0xA8, 0x3F,                // 64 linhas
+        0xD3, 0x00,                // sem deslocamento
+        0x40,                      // linha inicial 0
+        0x8D, 0x14,                // bomba de carga
+        0x20, 0x00,                // endereçamento horizontal
+        0xA1, 0xC8,                // espelha colunas e linhas (montagem da placa)
+        0xDA, 0x12,
+        0x81, 0xCF,                // contraste
+        0xD9, 0xF1,
+        0xDB, 0x40,
+        0xA4, 0xA6,                // mostra a RAM, sem inverter
+        0xAF,                      // liga
+    };
+
+    config = *cfg;
+    desenha_cb = desenha;
+    oled_quadro_inicia(&quadro);
+
+    if (barramento_escreve(config.disp, init, sizeof(init)) != (int) sizeof(init)) return false;
+
+    bloco_fim = xSemaphoreCreateBinary();
+    if (!bloco_fim) return false;
+    uint irq = i2c_hw_index(config.disp->barramento->i2c) ? I2C1_IRQ : I2C0_IRQ;
+    irq_set_exclusive_handler(irq, irq_i2c);
+    irq_set_enabled(irq, true);
+
+    canal_dma = dma_claim_unused_channel(false);
+    if (canal_dma < 0) return false;
+    dma_cfg = dma_channel_get_default_config((uint) canal_dma);
+    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&dma_cfg, true);
+    channel_config_set_write_increment(&dma_cfg, false);
+    channel_config_set_dreq(&dma_cfg, i2c_get_dreq(config.disp->barramento->i2c, true));
+
+    return xTaskCreate(tarefa_oled, "oled", 384, NULL, prioridade, &tarefa) == pdPASS;
+}
+
+void oled_janela(void) {
+    if (tarefa) xTaskNotifyGive(tarefa);
+}
+
+const OledEstatisticas *oled_estatisticas(void) {
+    return &estat;
+}
+
+void oled_relatorio(void) {
+    if (estat.atualizacoes == 0) return;
+    printf("[OLED] atualizacoes=%lu ciclos med=%lu max=%lu | blocos=%lu bytes=%lu bloco max=%luus"
+           " | janelas=%lu curtas=%lu falhas=%lu\n",
+           (unsigned long) estat.atualizacoes,
+           (unsigned long) (estat.ciclos_soma / estat.atualizacoes),
+           (unsigned long) estat.ciclos_max,
+           (unsigned long) estat.blocos, (unsigned long) estat.bytes,
+           (unsigned long) estat.bloco_max_us,
+           (unsigned long) estat.janelas, (unsigned long) estat.janelas_curtas,
+           (unsigned long) estat.falhas);
+}
+#endif
@@ -0,0 +1,184 @@
+/**
+ * perfil.c - Tabela das zonas de tempo, relatório e serialização
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "perfil.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/gpio.h"
+#include "hardware/clocks.h"
+#define PERFIL_UNIDADE 0
+#else
+#define PERFIL_UNIDADE 1
+#endif
+
+static const char *const nomes[PERFIL_N_ZONAS] = {
+#define PERFIL_NOME(id, nome, relogio) nome,
+    PERFIL_ZONAS(PERFIL_NOME)
+#undef PERFIL_NOME
+};
+
+static PerfilEstatistica tabela[PERFIL_N_ZONAS] = {
+#define PERFIL_VAZIA(id, nome, relogio) { .min = UINT32_MAX },
+    PERFIL_ZONAS(PERFIL_VAZIA)
+#undef PERFIL_VAZIA
+};
+
+// floor(log2(c)) - 4, limitado a [0, PERFIL_FAIXAS - 1]: abaixo de 32
+// ciclos (ou us) é tudo a faixa 0
+static int faixa(uint32_t c) {
+    int k = c ? 31 - __builtin_clz(c) : 0;
+    k -= 4;
+    if (k < 0) return 0;
+    if (k >= PERFIL_FAIXAS) return PERFIL_FAIXAS - 1;
+    return k;
+}
+
+// --- ATUALIZAÇÃO ---
+
+#if PICO_ON_DEVICE
+
+// Uma tarefa por zona: sem trava, e um relatório no meio de uma atualização
+// no máximo erra uma amostra
+void perfil_registra(PerfilZona zona, uint32_t c) {
+    PerfilEstatistica *e = &tabela[zona];
+    e->n++;
+    e->soma += c;
+    if (c < e->min) e->min = c;
+    if (c > e->max) e->max = c;
+    e->faixas[faixa(c)]++;
+}
+
+#else
+
+void perfil_registra(PerfilZona zona, uint32_t c) {
+    PerfilEstatistica *e = &tabela[zona];
+    __atomic_fetch_add(&e->n, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&e->soma, c, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&e->faixas[faixa(c)], 1, __ATOMIC_RELAXED);
+
+    uint32_t v = __atomic_load_n(&e->min, __ATOMIC_RELAXED);
+    while (c < v && !__atomic_compare_exchange_n(&e->min, &v, c, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    v = __atomic_load_n(&e->max, __ATOMIC_RELAXED);
+    while (c > v && !__atomic_compare_exchange_n(&e->max, &v, c, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+#endif
+
+void perfil_zera(void) {
+    for (int z = 0; z < PERFIL_N_ZONAS; z++) {
+        memset(&tabela[z], 0, sizeof tabela[z]);
+        tabela[z].min = UINT32_MAX;
+    }
+}
+
+const PerfilEstatistica *perfil_zona(PerfilZona zona) {
+    return &tabela[zona];
+}
+
+const char *perfil_nome(PerfilZona zona) {
+    return nomes[zona];
+}
+
+// --- PINO DO ANALISADOR ---
+
+#if PICO_ON_DEVICE
+
+static int8_t pinos[PERFIL_N_ZONAS] = {
+#define PERFIL_SEM_PINO(id, nome, relogio) -1,
+    PERFIL_ZONAS(PERFIL_SEM_PINO)
+#undef PERFIL_SEM_PINO
+};
+
+void perfil_gpio(PerfilZona zona, int pino) {
+    int antigo = pinos[zona];
+    pinos[zona] = -1;
+    if (antigo >= 0) gpio_put((uint) antigo, 0);
+    if (pino >= 0) {
+        gpio_init((uint) pino);
+        gpio_set_dir((uint) pino, GPIO_OUT);
+        gpio_put((uint) pino, 0);
+    }
+    pinos[zona] = (int8_t) pino;
+}
+
+void perfil_gpio_abre(PerfilZona zona) {
+    if (pinos[zona] >= 0) gpio_put((uint) pinos[zona], 1);
+}
+
+void perfil_gpio_fecha(PerfilZona zona) {
+    if (pinos[zona] >= 0) gpio_put((uint) pinos[zona], 0);
+}
+
+#endif
+
+// --- SAÍDA ---
+
+void perfil_relatorio(void) {
+#if PICO_ON_DEVICE
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000u;
+#endif
+    if (!PERFIL_ATIVO) {
+        printf("[PERF] compilado sem PERFIL_ATIVO\n");
+        return;
+    }
+    for (int z = 0; z < PERFIL_N_ZONAS; z++) {
+        const PerfilEstatistica *e = &tabela[z];
+        if (!e->n) continue;
+        uint32_t med = (uint32_t) (e->soma / e->n);
+#if PICO_ON_DEVICE
+        bool us = perfil_em_us((PerfilZona) z);
+        const char *unidade = us ? "us" : "ciclos";
+#else
+        const char *unidade = "ns";
+#endif
+        printf("[PERF] %-10s n=%lu %s min=%lu med=%lu max=%lu",
+               nomes[z], (unsigned long) e->n, unidade,
+               (unsigned long) e->min, (unsigned long) med, (unsigned long) e->max);
+#if PICO_ON_DEVICE
+        if (!us) printf(" (max %lu us)", (unsigned long) (e->max / mhz));
+#endif
+        printf(" | hist");
+        for (int k = 0; k < PERFIL_FAIXAS; k++) printf(" %lu", (unsigned long) e->faixas[k]);
+        printf("\n");
+    }
+}
+
+static uint8_t *poe32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+    p[3] = (uint8_t) (v >> 24);
+    return p + 4;
+}
+
+size_t perfil_serializa(uint8_t *buf, size_t max) {
+    if (max < PERFIL_SERIAL_BYTES) return 0;
+    uint8_t *p = buf;
+    *p++ = PERFIL_VERSAO;
+    *p++ = PERFIL_N_ZONAS;
+    *p++ = PERFIL_UNIDADE;
+    uint8_t zonas_us = 0;
+#if PICO_ON_DEVICE
+    for (int z = 0; z < PERFIL_N_ZONAS; z++) {
+        if (perfil_em_us((PerfilZona) z)) zonas_us |= (uint8_t) (1u << z);
+    }
+#endif
+    *p++ = zonas_us;
+    for (int z = 0; z < PERFIL_N_ZONAS; z++) {
+        const PerfilEstatistica *e = &tabela[z];
+        p = poe32(p, e->n);
+        p = poe32(p, e->n ? e->min : 0);
+        p = poe32(p, e->n ? (uint32_t) (e->soma / e->n) : 0);
+        p = poe32(p, e->max);
+        for (int k = 0; k < PERFIL_FAIXAS; k++) {
+            uint32_t v = e->faixas[k] > 0xFFFFu ? 0xFFFFu : e->faixas[k];
+            *p++ = (uint8_t) v;
+            *p++ = (uint8_t) (v >> 8);
+        }
+    }
+    return (size_t) (p - buf);
+}
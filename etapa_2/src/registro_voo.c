@@ -0,0 +1,367 @@
+/**
+ * registro_voo.c - Codificação das páginas e gravação do log na flash
+ *
+ * Posições no log são índices absolutos de página (escrita, apagado_ate);
+ * a página física é índice % N_PAGINAS. Páginas abaixo de apagado_ate já
+ * foram apagadas (ou gravadas); escrita < apagado_ate quer dizer que há
+ * onde gravar.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "registro_voo.h"
+
+// --- CODIFICAÇÃO ---
+
+static void poe_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static void poe_u32(uint8_t *p, uint32_t v) {
+    poe_u16(p, (uint16_t) v);
+    poe_u16(p + 2, (uint16_t) (v >> 16));
+}
+
+static uint16_t le_u16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint8_t *poe_varint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t) (v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t) v;
+    return p;
+}
+
+static uint8_t *poe_delta(uint8_t *p, uint16_t atual, uint16_t anterior) {
+    int32_t d = (int32_t) atual - (int32_t) anterior;
+    return poe_varint(p, ((uint32_t) d << 1) ^ (uint32_t) (d >> 31));   // zigzag
+}
+
+static uint16_t crc16(const uint8_t *p, uint32_t n) {
+    uint16_t crc = 0xFFFF;
+    while (n--) {
+        crc ^= (uint16_t) (*p++ << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+void registro_voo_pagina_inicia(RegistroVooPagina *p, uint16_t sessao) {
+    memset(p->dados, 0xFF, sizeof(p->dados));     // igual à flash apagada
+    memset(&p->anterior, 0, sizeof(p->anterior));
+    poe_u16(p->dados + 8, sessao);
+    p->usados = REGISTRO_VOO_CABECALHO;
+    p->n = 0;
+}
+
+bool registro_voo_pagina_anota(RegistroVooPagina *p, const RegistroVoo *r) {
+    if (p->n == UINT8_MAX || p->usados + REGISTRO_VOO_MAX_BYTES > REGISTRO_VOO_PAGINA) {
+        return false;
+    }
+    if (p->n == 0) {
+        poe_u32(p->dados + 12, r->captura_us);
+        p->anterior.captura_us = r->captura_us;
+    }
+
+    uint8_t *q = p->dados + p->usados;
+    *q++ = (uint8_t) ((r->cor_esq & 3) | (r->cor_dir & 3) << 2 |
+                      (r->prioridade & 3) << 4 | (r->movimento & 3) << 6);
+    q = poe_varint(q, r->captura_us - p->anterior.captura_us);
+    q = poe_varint(q, r->decisao_us - r->captura_us);
+    for (int i = 0; i < 4; i++) q = poe_delta(q, r->esq[i], p->anterior.esq[i]);
+    for (int i = 0; i < 4; i++) q = poe_delta(q, r->dir[i], p->anterior.dir[i]);
+
+    p->usados = (uint16_t) (q - p->dados);
+    p->n++;
+    p->anterior = *r;
+    return true;
+}
+
+void registro_voo_pagina_fecha(RegistroVooPagina *p, uint32_t seq, uint32_t descartados) {
+    uint8_t *d = p->dados;
+    poe_u16(d, REGISTRO_VOO_MAGIC);
+    d[2] = REGISTRO_VOO_VERSAO;
+    d[3] = p->n;
+    poe_u32(d + 4, seq);
+    poe_u16(d + 10, p->usados);
+    poe_u16(d + 16, (uint16_t) (descartados > UINT16_MAX ? UINT16_MAX : descartados));
+    poe_u16(d + 18, 0);
+    poe_u16(d + 18, crc16(d, p->usados));
+}
+
+bool registro_voo_pagina_valida(const uint8_t *pagina) {
+    uint16_t usados = le_u16(pagina + 10);
+    if (le_u16(pagina) != REGISTRO_VOO_MAGIC || pagina[2] != REGISTRO_VOO_VERSAO ||
+        usados < REGISTRO_VOO_CABECALHO || usados > REGISTRO_VOO_PAGINA) {
+        return false;
+    }
+    uint8_t copia[REGISTRO_VOO_PAGINA];
+    memcpy(copia, pagina, usados);
+    poe_u16(copia + 18, 0);
+    return crc16(copia, usados) == le_u16(pagina + 18);
+}
+
+// --- GRAVADOR ---
+
+#if PICO_ON_DEVICE
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+#include "queue.h"
+#include "task.h"
+
+#include "boot.h"
+
+// Abaixo da região do BTstack (pico_btstack_flash_bank, 2 setores no fim)
+#define REGIAO_OFFSET     (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE - REGISTRO_VOO_BYTES)
+#define PAGINAS_POR_SETOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define N_SETORES         (REGISTRO_VOO_BYTES / FLASH_SECTOR_SIZE)
+#define N_PAGINAS         (N_SETORES * PAGINAS_POR_SETOR)
+
+#define N_PAGINAS_RAM     4       // ~1,5 s de decisões até a tarefa gravar
+#define MARGEM_SETORES    16      // ~100 s de registro sem precisar apagar
+#define ESPERA_MS         100
+#define FLASH_TIMEOUT_MS  10
+
+_Static_assert(REGISTRO_VOO_PAGINA == FLASH_PAGE_SIZE, "pagina do registro != pagina da flash");
+_Static_assert(REGISTRO_VOO_BYTES % FLASH_SECTOR_SIZE == 0, "regiao do registro fora do setor");
+_Static_assert(N_SETORES > MARGEM_SETORES, "regiao do registro menor que a margem");
+
+// Fim do binário na flash (linker script do Pico SDK)
+extern char __flash_binary_end;
+
+static RegistroVooPagina paginas[N_PAGINAS_RAM];
+static QueueHandle_t fila_livres;    // uint8_t índice em paginas[]
+static QueueHandle_t fila_cheias;
+static RegistroVooPagina *atual = NULL;
+static uint8_t atual_idx;
+
+static uint32_t escrita;             // próxima página a gravar (absoluto)
+static uint32_t apagado_ate;
+static uint32_t seq;
+static uint16_t sessao;
+static bool (*pode_apagar)(void);
+
+static RegistroVooEstatisticas estat;
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *dados;
+} OperacaoFlash;
+
+static const uint8_t *pagina_flash(uint32_t fisica) {
+    return (const uint8_t *) (XIP_BASE + REGIAO_OFFSET + fisica * FLASH_PAGE_SIZE);
+}
+
+static void programa(void *arg) {
+    const OperacaoFlash *op = arg;
+    flash_range_program(op->offset, op->dados, FLASH_PAGE_SIZE);
+}
+
+static void apaga(void *arg) {
+    const OperacaoFlash *op = arg;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static bool setor_em_branco(uint32_t setor) {
+    const uint32_t *p = (const uint32_t *) pagina_flash(setor * PAGINAS_POR_SETOR);
+    for (uint32_t i = 0; i < FLASH_SECTOR_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+// Apaga o setor de apagado_ate (o mais antigo do log) e avança a margem;
+// false se a flash não pôde ser parada
+static bool apaga_proximo(void) {
+    uint32_t setor = (apagado_ate / PAGINAS_POR_SETOR) % N_SETORES;
+    if (!setor_em_branco(setor)) {
+        OperacaoFlash op = { .offset = REGIAO_OFFSET + setor * FLASH_SECTOR_SIZE };
+        uint32_t t0 = time_us_32();
+        if (flash_safe_execute(apaga, &op, FLASH_TIMEOUT_MS) != PICO_OK) return false;
+        uint32_t dt = time_us_32() - t0;
+        if (dt > estat.apagamento_max_us) estat.apagamento_max_us = dt;
+        estat.setores_apagados++;
+    }
+    apagado_ate += PAGINAS_POR_SETOR;
+    return true;
+}
+
+static bool margem_cheia(void) {
+    return apagado_ate - escrita >= MARGEM_SETORES * PAGINAS_POR_SETOR;
+}
+
+static bool deixa_apagar(void) {
+    return pode_apagar == NULL || pode_apagar();
+}
+
+// Último seq gravado e onde continuar: maior seq entre as primeiras páginas
+// dos setores, depois a primeira página em branco dentro desse setor
+static void acha_fim_do_log(void) {
+    int32_t setor_recente = -1;
+    uint32_t seq_recente = 0;
+    for (uint32_t s = 0; s < N_SETORES; s++) {
+        const uint8_t *p = pagina_flash(s * PAGINAS_POR_SETOR);
+        if (!registro_voo_pagina_valida(p)) continue;
+        uint32_t seq_setor = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t) p[7] << 24;
+        if (setor_recente < 0 || (int32_t) (seq_setor - seq_recente) > 0) {
+            setor_recente = (int32_t) s;
+            seq_recente = seq_setor;
+        }
+    }
+
+    if (setor_recente < 0) {                  // região nova ou toda corrompida
+        escrita = apagado_ate = 0;
+        seq = 0;
+        sessao = 1;
+        return;
+    }
+
+    uint32_t i = 0;
+    const uint8_t *ultima = NULL;
+    for (; i < PAGINAS_POR_SETOR; i++) {
+        const uint8_t *p = pagina_flash((uint32_t) setor_recente * PAGINAS_POR_SETOR + i);
+        if (le_u16(p) == 0xFFFF) break;       // em branco: o log parou aqui
+        if (registro_voo_pagina_valida(p)) ultima = p;
+    }
+    seq = (ultima[4] | ultima[5] << 8 | ultima[6] << 16 | (uint32_t) ultima[7] << 24) + 1;
+    sessao = (uint16_t) (le_u16(ultima + 8) + 1);
+
+    escrita = (uint32_t) setor_recente * PAGINAS_POR_SETOR + i;
+    if (i == PAGINAS_POR_SETOR) escrita %= N_PAGINAS;
+    // O resto do setor atual já está em branco; o próximo ainda tem log antigo
+    apagado_ate = (escrita + PAGINAS_POR_SETOR - 1) / PAGINAS_POR_SETOR * PAGINAS_POR_SETOR;
+}
+
+static uint32_t descartados(void) {
+    return estat.registros_descartados + estat.registros_sem_setor;
+}
+
+static void tarefa_registro(void *arg) {
+    uint8_t idx;
+
+    // Margem do boot: até 16 setores (~45 ms cada, até 400 ms) seguidos,
+    // aqui e não em main(), e só enquanto o robô deixa parar a flash. O que
+    // faltar é apagado um setor por volta do laço abaixo
+    while (!margem_cheia() && deixa_apagar()) {
+        if (!apaga_proximo()) break;
+    }
+    if (margem_cheia()) boot_marca(BOOT_REGISTRO, time_us_32());
+
+    for (;;) {
+        if (xQueueReceive(fila_cheias, &idx, pdMS_TO_TICKS(ESPERA_MS)) == pdTRUE) {
+            RegistroVooPagina *p = &paginas[idx];
+            if (escrita < apagado_ate) {
+                registro_voo_pagina_fecha(p, seq, descartados());
+                OperacaoFlash op = {
+                    .offset = REGIAO_OFFSET + (escrita % N_PAGINAS) * FLASH_PAGE_SIZE,
+                    .dados = p->dados,
+                };
+                uint32_t t0 = time_us_32();
+                if (flash_safe_execute(programa, &op, FLASH_TIMEOUT_MS) == PICO_OK) {
+                    uint32_t dt = time_us_32() - t0;
+                    if (dt > estat.gravacao_max_us) estat.gravacao_max_us = dt;
+                    estat.paginas_gravadas++;
+                    escrita++;
+                    seq++;
+                } else {
+                    estat.registros_sem_setor += p->n;
+                }
+            } else {
+                estat.registros_sem_setor += p->n;
+            }
+            xQueueSend(fila_livres, &idx, 0);
+        }
+
+        // Um setor por volta, e só quando o dono do robô deixa parar a flash
+        if (!margem_cheia() && deixa_apagar() && apaga_proximo() && margem_cheia()) {
+            boot_marca(BOOT_REGISTRO, time_us_32());
+        }
+    }
+}
+
+bool registro_voo_init(UBaseType_t prioridade, bool (*pode_apagar_cb)(void)) {
+    if ((uintptr_t) &__flash_binary_end > XIP_BASE + REGIAO_OFFSET) {
+        printf("[REG] binario invade a regiao do registro (0x%08lx)\n",
+               (unsigned long) REGIAO_OFFSET);
+        return false;
+    }
+
+    pode_apagar = pode_apagar_cb;
+    acha_fim_do_log();
+
+    fila_livres = xQueueCreate(N_PAGINAS_RAM, sizeof(uint8_t));
+    fila_cheias = xQueueCreate(N_PAGINAS_RAM, sizeof(uint8_t));
+    if (fila_livres == NULL || fila_cheias == NULL) return false;
+    for (uint8_t i = 0; i < N_PAGINAS_RAM; i++) {
+        xQueueSend(fila_livres, &i, 0);
+    }
+
+    printf("[REG] sessao %u, pagina %lu, seq %lu, margem %lu paginas\n", sessao,
+           (unsigned long) (escrita % N_PAGINAS), (unsigned long) seq,
+           (unsigned long) (apagado_ate - escrita));
+    return xTaskCreate(tarefa_registro, "registro", 384, NULL, prioridade, NULL) == pdPASS;
+}
+
+void registro_voo_anota(const RegistroVoo *r) {
+    if (fila_livres == NULL) return;
+
+    for (int tentativa = 0; tentativa < 2; tentativa++) {
+        if (atual == NULL) {
+            if (xQueueReceive(fila_livres, &atual_idx, 0) != pdTRUE) break;
+            atual = &paginas[atual_idx];
+            registro_voo_pagina_inicia(atual, sessao);
+        }
+        if (registro_voo_pagina_anota(atual, r)) {
+            estat.registros++;
+            return;
+        }
+        // Página cheia: vai para a gravação e o registro entra na próxima
+        xQueueSend(fila_cheias, &atual_idx, 0);
+        atual = NULL;
+    }
+    estat.registros_descartados++;
+}
+
+void registro_voo_despeja(void) {
+    static const char hex[] = "0123456789abcdef";
+    static char linha[2 * FLASH_PAGE_SIZE + 1];
+    uint32_t validas = 0;
+
+    printf("REG INICIO sessao=%u seq=%lu\n", sessao, (unsigned long) seq);
+    // Da página depois da escrita (a mais antiga) dando a volta na região
+    for (uint32_t i = 0; i < N_PAGINAS; i++) {
+        const uint8_t *p = pagina_flash((escrita + i) % N_PAGINAS);
+        if (!registro_voo_pagina_valida(p)) continue;
+        for (uint32_t j = 0; j < FLASH_PAGE_SIZE; j++) {
+            linha[2 * j] = hex[p[j] >> 4];
+            linha[2 * j + 1] = hex[p[j] & 0xF];
+        }
+        linha[2 * FLASH_PAGE_SIZE] = '\0';
+        printf("REG %s\n", linha);
+        validas++;
+    }
+    printf("REG FIM paginas=%lu\n", (unsigned long) validas);
+}
+
+const RegistroVooEstatisticas *registro_voo_estatisticas(void) {
+    return &estat;
+}
+
+void registro_voo_relatorio(void) {
+    printf("[REG] registros=%lu paginas=%lu margem=%lu | descartados ram=%lu setor=%lu | "
+           "grava max=%luus apaga max=%luus setores=%lu\n",
+           (unsigned long) estat.registros, (unsigned long) estat.paginas_gravadas,
+           (unsigned long) (apagado_ate - escrita),
+           (unsigned long) estat.registros_descartados, (unsigned long) estat.registros_sem_setor,
+           (unsigned long) estat.gravacao_max_us, (unsigned long) estat.apagamento_max_us,
+           (unsigned long) estat.setores_apagados);
+}
+#endif
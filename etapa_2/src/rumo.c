@@ -0,0 +1,111 @@
+/**
+ * rumo.c - Integração do giroscópio, viés e controle de rumo (robô e host)
+ */
+#include "rumo.h"
+
+// Acumulado (LSB em Q8 por amostra) correspondente a uma volta e a 0,01°
+#define Q8_POR_GRAU   ((int64_t) 256 * RUMO_LSB_DPS * RUMO_TAXA_HZ)
+#define Q8_POR_VOLTA  (360 * Q8_POR_GRAU)
+
+// Passa-baixas do viés: 1/64 por amostra parada (~0,3 s a 200 Hz)
+#define VIES_DESLOCAMENTO 6
+
+void rumo_init(Rumo *r) {
+    *r = (Rumo) { 0 };
+}
+
+static int32_t cdps_de_q8(int32_t x_q8) {
+    return (int32_t) ((int64_t) x_q8 * 100 / (256 * RUMO_LSB_DPS));
+}
+
+void rumo_amostras(const RumoParams *p, Rumo *r, const int16_t *gz, int n, bool parado) {
+    if (n <= 0) return;
+
+    // Viés inicial: média simples das primeiras amostras com o robô parado
+    if (!r->calibrado) {
+        if (!parado) {
+            r->n_calibra = 0;
+            r->soma_calibra = 0;
+            return;
+        }
+        for (int i = 0; i < n && r->n_calibra < RUMO_CALIBRA_AMOSTRAS; i++) {
+            r->soma_calibra += p->sinal * gz[i];
+            r->n_calibra++;
+        }
+        if (r->n_calibra == RUMO_CALIBRA_AMOSTRAS) {
+            r->vies_q8 = (r->soma_calibra << 8) / RUMO_CALIBRA_AMOSTRAS;
+            r->calibrado = true;
+        }
+        return;
+    }
+
+    int32_t soma = 0;
+    for (int i = 0; i < n; i++) {
+        int32_t x = ((int32_t) (p->sinal * gz[i]) << 8) - r->vies_q8;
+        r->acumulado += x;
+        soma += x;
+
+        // Complementar: o que sobra parado e devagar é viés, não rotação
+        if (parado && cdps_de_q8(x) < p->taxa_parado_cdps && cdps_de_q8(x) > -p->taxa_parado_cdps) {
+            r->vies_q8 += x >> VIES_DESLOCAMENTO;
+        }
+    }
+    r->taxa_cdps = cdps_de_q8(soma / n);
+
+    // Mantém a guinada em (-180°, 180°]
+    if (r->acumulado > Q8_POR_VOLTA / 2)        r->acumulado -= Q8_POR_VOLTA;
+    else if (r->acumulado <= -Q8_POR_VOLTA / 2) r->acumulado += Q8_POR_VOLTA;
+}
+
+int32_t rumo_guinada_cdeg(const Rumo *r) {
+    return (int32_t) (r->acumulado * 100 / Q8_POR_GRAU);
+}
+
+static int32_t limita(int32_t x, int32_t lim) {
+    return x > lim ? lim : x < -lim ? -lim : x;
+}
+
+void rumo_malha_aberta(MlDirecao direcao, int32_t base, int32_t spin,
+                       int32_t *pwm_esq, int32_t *pwm_dir) {
+    if (direcao == ML_DIRECAO_DIREITA)       { *pwm_esq = base;  *pwm_dir = -spin; }
+    else if (direcao == ML_DIRECAO_ESQUERDA) { *pwm_esq = -base; *pwm_dir = spin; }
+    else                                     { *pwm_esq = base;  *pwm_dir = base; }
+}
+
+void rumo_controla(const RumoParams *p, Rumo *r, MlDirecao direcao,
+                   int32_t base, int32_t spin, int32_t *pwm_esq, int32_t *pwm_dir) {
+    rumo_malha_aberta(direcao, base, spin, pwm_esq, pwm_dir);
+    if (!r->calibrado) return;
+
+    int32_t guinada = rumo_guinada_cdeg(r);
+
+    if (direcao != ML_DIRECAO_RETO) {
+        // Giro: a referência é recapturada quando o giro acabar
+        r->referencia_valida = false;
+        int32_t taxa = r->taxa_cdps < 0 ? -r->taxa_cdps : r->taxa_cdps;
+        if (taxa > p->giro_max_cdps) {
+            // Escala as duas rodas por giro_max/taxa (no mínimo metade)
+            int32_t escala_q8 = (int32_t) ((int64_t) p->giro_max_cdps * 256 / taxa);
+            if (escala_q8 < 128) escala_q8 = 128;
+            *pwm_esq = *pwm_esq * escala_q8 / 256;
+            *pwm_dir = *pwm_dir * escala_q8 / 256;
+        }
+        return;
+    }
+
+    if (!r->referencia_valida) {
+        r->referencia_cdeg = guinada;
+        r->referencia_valida = true;
+    }
+
+    // Erro > 0: desviou para a esquerda; a taxa entra como amortecimento
+    int32_t erro = guinada - r->referencia_cdeg;
+    if (erro > 18000)        erro -= 36000;
+    else if (erro <= -18000) erro += 36000;
+
+    int32_t correcao = (int32_t) (((int64_t) p->kp_q8 * erro + (int64_t) p->kd_q8 * r->taxa_cdps) >> 8);
+    correcao = limita(correcao, p->correcao_max);
+
+    *pwm_esq = limita(base + correcao, 65535);
+    *pwm_dir = limita(base - correcao, 65535);
+}
@@ -0,0 +1,81 @@
+/**
+ * seguidor.c - Classificação de cor e regra de decisão (robô e simulador)
+ */
+#include "seguidor.h"
+#include "lut_cor.h"
+#include "perfil.h"
+
+// A LUT usa a mesma numeração do TipoCor
+_Static_assert(LUT_COR_AZUL == COR_AZUL && LUT_COR_VERMELHA == COR_VERMELHA &&
+               LUT_COR_AMARELA == COR_AMARELA, "lut_cor.h fora de sincronia com TipoCor");
+
+static TipoCor classifica_razoes(const SeguidorParams *p, uint32_t r, uint32_t g, uint32_t b) {
+    // x > y * razão, com a razão em Q8
+    if ((r << 8) > b * p->razao_amarela_q8 && (g << 8) > b * p->razao_amarela_q8) return COR_AMARELA;
+    if ((r << 8) > g * p->razao_vermelha_q8 && (r << 8) > b * p->razao_vermelha_q8) return COR_VERMELHA;
+    if ((b << 8) > r * p->razao_azul_q8) return COR_AZUL;
+    return COR_NENHUMA;
+}
+
+static TipoCor classifica_lut(const SeguidorParams *p, uint16_t r, uint16_t g, uint16_t b) {
+    // Normaliza pelo maior canal (só a cromaticidade importa) e consulta a LUT
+    uint16_t maior = r > g ? r : g;
+    if (b > maior) maior = b;
+    if (maior == 0) return COR_NENHUMA;
+
+    uint8_t cor = lut_cor_classifica((uint8_t) ((r * 255u) / maior),
+                                     (uint8_t) ((g * 255u) / maior),
+                                     (uint8_t) ((b * 255u) / maior));
+
+    // Fora do que as fotos cobriram, a regra de razões decide
+    if (cor == LUT_COR_SEM_AMOSTRA) return classifica_razoes(p, r, g, b);
+    // Verde só existe na visão; para o robô é fundo
+    return cor == LUT_COR_VERDE ? COR_NENHUMA : (TipoCor) cor;
+}
+
+static TipoCor identifica(const SeguidorParams *p, uint16_t r, uint16_t g, uint16_t b, uint16_t c) {
+    if (c < p->brilho_min) return COR_NENHUMA;
+    return p->classificador == SEGUIDOR_CLASSIFICA_RAZOES ? classifica_razoes(p, r, g, b)
+                                                          : classifica_lut(p, r, g, b);
+}
+
+TipoCor seguidor_identifica_cor(const SeguidorParams *p, uint16_t r, uint16_t g, uint16_t b, uint16_t c) {
+    PERFIL_INICIO(CLASSIFICA);
+    TipoCor cor = identifica(p, r, g, b, c);
+    PERFIL_FIM(CLASSIFICA);
+    return cor;
+}
+
+static MlDirecao decide(const SeguidorParams *p, SeguidorEstado *e,
+                        TipoCor cor_esq, TipoCor cor_dir, uint32_t agora_ms) {
+    // Lógica de prioridade
+    TipoCor maior_cor_agora = (cor_dir > cor_esq) ? cor_dir : cor_esq;
+
+    if (maior_cor_agora > e->prioridade_ativa) {
+        e->prioridade_ativa = maior_cor_agora;
+        e->fim_do_bloqueio_ms = agora_ms + p->trava_ms;
+    }
+
+    if ((int32_t) (agora_ms - e->fim_do_bloqueio_ms) > 0) {
+        e->prioridade_ativa = COR_NENHUMA;
+    }
+
+    // Aplica filtro de bloqueio
+    TipoCor cor_esq_final = cor_esq < e->prioridade_ativa ? COR_NENHUMA : cor_esq;
+    TipoCor cor_dir_final = cor_dir < e->prioridade_ativa ? COR_NENHUMA : cor_dir;
+
+    // Decisão de movimento
+    e->sem_faixa = false;
+    if (cor_dir_final > cor_esq_final) return ML_DIRECAO_DIREITA;
+    if (cor_esq_final > cor_dir_final) return ML_DIRECAO_ESQUERDA;
+    e->sem_faixa = cor_esq_final == COR_NENHUMA;
+    return ML_DIRECAO_RETO;
+}
+
+MlDirecao seguidor_decide(const SeguidorParams *p, SeguidorEstado *e,
+                          TipoCor cor_esq, TipoCor cor_dir, uint32_t agora_ms) {
+    PERFIL_INICIO(DECISAO);
+    MlDirecao dir = decide(p, e, cor_esq, cor_dir, agora_ms);
+    PERFIL_FIM(DECISAO);
+    return dir;
+}
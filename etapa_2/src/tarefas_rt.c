@@ -0,0 +1,108 @@
+/**
+ * tarefas_rt.c - Períodos, deadlines e uso de CPU das tarefas do robô
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+
+#include "tarefas_rt.h"
+
+static TarefaRt *tarefas[TAREFAS_RT_MAX];
+static int n_tarefas = 0;
+static uint32_t janela_inicio_us = 0;
+
+#if configGENERATE_RUN_TIME_STATS
+static uint32_t contador_anterior[TAREFAS_RT_MAX];
+static uint32_t total_anterior = 0;
+#endif
+
+bool tarefa_rt_cria(TarefaRt *t, TaskFunction_t funcao, const char *nome, uint32_t pilha_palavras,
+                    UBaseType_t prioridade, uint32_t periodo_ms, uint32_t deadline_us) {
+    if (n_tarefas >= TAREFAS_RT_MAX) return false;
+
+    *t = (TarefaRt) {
+        .nome = nome,
+        .periodo_us = periodo_ms * 1000u,
+        .deadline_us = deadline_us,
+        .prioridade = prioridade,
+    };
+    if (xTaskCreate(funcao, nome, pilha_palavras, t, prioridade, &t->handle) != pdPASS) {
+        return false;
+    }
+    tarefas[n_tarefas++] = t;
+    return true;
+}
+
+void tarefa_rt_espera_periodo(TarefaRt *t) {
+    if (t->ativacoes == 0) {
+        // Primeira execução: o período conta a partir daqui
+        t->proximo_tick = xTaskGetTickCount();
+        t->liberacao_us = time_us_32();
+    } else {
+        vTaskDelayUntil(&t->proximo_tick, pdMS_TO_TICKS(t->periodo_us / 1000u));
+        t->liberacao_us += t->periodo_us;
+    }
+    t->inicio_us = time_us_32();
+}
+
+void tarefa_rt_inicio(TarefaRt *t, uint32_t liberacao_us) {
+    t->liberacao_us = liberacao_us;
+    t->inicio_us = time_us_32();
+}
+
+bool tarefa_rt_fim(TarefaRt *t) {
+    uint32_t agora = time_us_32();
+    uint32_t exec = agora - t->inicio_us;
+    uint32_t resposta = agora - t->liberacao_us;
+
+    t->ativacoes++;
+    t->exec_ultimo_us = exec;
+    t->exec_janela_us += exec;
+    if (exec > t->exec_max_us) t->exec_max_us = exec;
+    if (resposta > t->resposta_max_us) t->resposta_max_us = resposta;
+
+    if (resposta > t->deadline_us) {
+        t->perdas++;
+        return false;
+    }
+    return true;
+}
+
+void tarefas_rt_relatorio(void) {
+    uint32_t agora = time_us_32();
+    uint32_t janela = agora - janela_inicio_us;
+    if (janela == 0) janela = 1;
+
+#if configGENERATE_RUN_TIME_STATS
+    TaskStatus_t estado;
+    uint32_t total = portGET_RUN_TIME_COUNTER_VALUE();
+    uint32_t total_janela = total - total_anterior;
+    if (total_janela == 0) total_janela = 1;
+#endif
+
+    for (int i = 0; i < n_tarefas; i++) {
+        TarefaRt *t = tarefas[i];
+
+#if configGENERATE_RUN_TIME_STATS
+        vTaskGetInfo(t->handle, &estado, pdFALSE, eRunning);
+        uint32_t cpu_milesimos = (uint32_t) (((uint64_t) (estado.ulRunTimeCounter - contador_anterior[i]) * 1000u) / total_janela);
+        contador_anterior[i] = estado.ulRunTimeCounter;
+#else
+        uint32_t cpu_milesimos = (uint32_t) ((t->exec_janela_us * 1000u) / janela);
+#endif
+        t->exec_janela_us = 0;
+
+        printf("[RT] %-10s P%u T=%lums D=%luus | ativ=%lu perdas=%lu | exec ult/max=%lu/%lu us | resp max=%lu us | cpu=%lu.%lu%%\n",
+               t->nome, (unsigned) t->prioridade,
+               (unsigned long) (t->periodo_us / 1000u), (unsigned long) t->deadline_us,
+               (unsigned long) t->ativacoes, (unsigned long) t->perdas,
+               (unsigned long) t->exec_ultimo_us, (unsigned long) t->exec_max_us,
+               (unsigned long) t->resposta_max_us,
+               (unsigned long) (cpu_milesimos / 10u), (unsigned long) (cpu_milesimos % 10u));
+    }
+
+#if configGENERATE_RUN_TIME_STATS
+    total_anterior = total;
+#endif
+    janela_inicio_us = agora;
+}
@@ -0,0 +1,173 @@
+/**
+ * telemetria.c - Anel de amostras e montagem dos lotes binários
+ *
+ * Índices absolutos de 32 bits (cabeca/cauda) e posição = índice % TELEMETRIA_RING:
+ * cabeca - cauda é sempre o número de amostras no anel, mesmo depois da volta.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "telemetria.h"
+#include "memoria.h"
+
+#if PICO_ON_DEVICE
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+// Um núcleo só (port ARM_CM0): o risco é uma tarefa de prioridade maior
+// preemptar outra no meio de cabeca/cauda, já que motor, sensores, decisão e
+// ML registram e a publicação esvazia o anel. A seção crítica mascara as
+// interrupções e com elas o tique. Não registrar de ISR (ali seria a versão
+// FromISR da seção crítica)
+#define TRAVA()    taskENTER_CRITICAL()
+#define DESTRAVA() taskEXIT_CRITICAL()
+static uint32_t agora_ms(void) { return to_ms_since_boot(get_absolute_time()); }
+#else
+#include <time.h>
+#define TRAVA()
+#define DESTRAVA()
+static uint32_t agora_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t) (ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+#endif
+
+static TelemetriaAmostra anel[TELEMETRIA_RING] MEMORIA_ARENA(telemetria);
+static volatile uint32_t cabeca = 0;
+static volatile uint32_t cauda = 0;
+
+static uint16_t seq = 0;
+static uint32_t perdidas_reportadas = 0;
+static TelemetriaEstatisticas estat;
+
+static uint32_t relatorio_ms = 0;
+static uint32_t relatorio_publicadas = 0;
+static uint32_t relatorio_bytes = 0;
+
+static void poe_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static void poe_u32(uint8_t *p, uint32_t v) {
+    poe_u16(p, (uint16_t) v);
+    poe_u16(p + 2, (uint16_t) (v >> 16));
+}
+
+void telemetria_init(void) {
+    cabeca = cauda = 0;
+    seq = 0;
+    perdidas_reportadas = 0;
+    memset(&estat, 0, sizeof(estat));
+    relatorio_ms = agora_ms();
+    relatorio_publicadas = relatorio_bytes = 0;
+}
+
+void telemetria_registra_em(uint32_t t_ms, TelemetriaTipo tipo, uint8_t aux,
+                            uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3) {
+    TRAVA();
+    if (cabeca - cauda >= TELEMETRIA_RING) {
+        cauda++;                                  // descarta a mais antiga
+        estat.perdidas++;
+    }
+    TelemetriaAmostra *a = &anel[cabeca % TELEMETRIA_RING];
+    a->t_ms = t_ms;
+    a->tipo = (uint8_t) tipo;
+    a->aux = aux;
+    a->v[0] = v0;
+    a->v[1] = v1;
+    a->v[2] = v2;
+    a->v[3] = v3;
+    cabeca++;
+    estat.registradas++;
+    DESTRAVA();
+}
+
+uint32_t telemetria_pendentes(void) {
+    return cabeca - cauda;
+}
+
+size_t telemetria_monta_lote(uint8_t *buf, size_t tamanho, uint16_t max, TelemetriaLote *lote) {
+    if (max > TELEMETRIA_LOTE_MAX) max = TELEMETRIA_LOTE_MAX;
+    while (max > 0 && (size_t) TELEMETRIA_LOTE_BYTES(max) > tamanho) max--;
+
+    uint8_t *p = buf + TELEMETRIA_CABECALHO_BYTES;
+    uint32_t t0 = 0;
+    uint16_t n = 0;
+
+    // Copia sob a trava: um produtor pode sobrescrever a cauda enquanto isso
+    TRAVA();
+    lote->inicio = cauda;
+    lote->perdidas = estat.perdidas;
+    uint32_t disponiveis = cabeca - cauda;
+    while (n < max && n < disponiveis) {
+        const TelemetriaAmostra *a = &anel[(lote->inicio + n) % TELEMETRIA_RING];
+        if (n == 0) t0 = a->t_ms;
+        uint32_t dt = a->t_ms - t0;
+        if (dt > UINT16_MAX) break;               // fecha o lote: dt não cabe em 16 bits
+        poe_u16(p, (uint16_t) dt);
+        p[2] = a->tipo;
+        p[3] = a->aux;
+        for (int i = 0; i < 4; i++) poe_u16(p + 4 + 2 * i, a->v[i]);
+        p += TELEMETRIA_AMOSTRA_BYTES;
+        n++;
+    }
+    DESTRAVA();
+
+    if (n == 0) return 0;
+
+    uint32_t perdidas = lote->perdidas - perdidas_reportadas;
+    lote->n = n;
+    lote->seq = seq;
+    poe_u16(buf, TELEMETRIA_MAGIC);
+    buf[2] = TELEMETRIA_VERSAO;
+    buf[3] = (uint8_t) n;
+    poe_u16(buf + 4, seq);
+    poe_u16(buf + 6, (uint16_t) (perdidas > UINT16_MAX ? UINT16_MAX : perdidas));
+    poe_u32(buf + 8, t0);
+    return TELEMETRIA_LOTE_BYTES(n);
+}
+
+void telemetria_confirma_lote(const TelemetriaLote *lote, size_t bytes) {
+    TRAVA();
+    // Se o anel deu a volta durante a publicação, a cauda já passou do lote
+    uint32_t fim = lote->inicio + lote->n;
+    if ((int32_t) (fim - cauda) > 0) cauda = fim;
+    DESTRAVA();
+
+    seq++;
+    perdidas_reportadas = lote->perdidas;
+    estat.publicadas += lote->n;
+    estat.lotes++;
+    estat.bytes += (uint32_t) bytes;
+}
+
+void telemetria_conta_falha(void) {
+    estat.falhas++;
+}
+
+void telemetria_conta_reconexao(void) {
+    estat.reconexoes++;
+}
+
+const TelemetriaEstatisticas *telemetria_estatisticas(void) {
+    return &estat;
+}
+
+void telemetria_relatorio(void) {
+    uint32_t agora = agora_ms();
+    uint32_t janela = agora - relatorio_ms;
+    if (janela == 0) janela = 1;
+
+    printf("[TEL] %lu amostras/s %lu B/s | publicadas=%lu lotes=%lu pendentes=%lu | perdidas=%lu falhas=%lu reconexoes=%lu\n",
+           (unsigned long) ((estat.publicadas - relatorio_publicadas) * 1000u / janela),
+           (unsigned long) ((estat.bytes - relatorio_bytes) * 1000u / janela),
+           (unsigned long) estat.publicadas, (unsigned long) estat.lotes,
+           (unsigned long) telemetria_pendentes(), (unsigned long) estat.perdidas,
+           (unsigned long) estat.falhas, (unsigned long) estat.reconexoes);
+
+    relatorio_ms = agora;
+    relatorio_publicadas = estat.publicadas;
+    relatorio_bytes = estat.bytes;
+}
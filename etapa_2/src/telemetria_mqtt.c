@@ -0,0 +1,146 @@
+/**
+ * telemetria_mqtt.c - Publicação dos lotes de telemetria (paho MQTT sobre lwIP)
+ */
+#include <stdio.h>
+
+#include "pico/cyw43_arch.h"
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Rede e timer do paho implementados em src/paho_network.c e src/paho_timer.c
+#include "paho_network.h"
+#include "MQTTClient.h"
+
+#include "telemetria_mqtt.h"
+
+// Definidos pelo CMake (cache WIFI_SSID, WIFI_PASSWORD, MQTT_BROKER...)
+#ifndef WIFI_SSID
+#define WIFI_SSID ""
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD ""
+#endif
+#ifndef MQTT_BROKER
+#define MQTT_BROKER "192.168.0.10"
+#endif
+#ifndef MQTT_PORTA
+#define MQTT_PORTA 1883
+#endif
+#ifndef TELEMETRIA_TOPICO
+#define TELEMETRIA_TOPICO "robo/telemetria"
+#endif
+
+#define WIFI_TIMEOUT_MS     10000
+#define MQTT_TIMEOUT_MS     2000
+#define ESPERA_MIN_MS       500
+#define ESPERA_MAX_MS       16000
+#define YIELD_MS            10       // keepalive/ACKs do paho e ritmo do laço
+
+static TelemetriaConfig config;
+
+static Network rede;
+static MQTTClient cliente;
+static uint8_t buf_envio[TELEMETRIA_LOTE_BYTES(TELEMETRIA_LOTE_MAX) + 64];
+static uint8_t buf_leitura[64];
+static uint8_t lote_buf[TELEMETRIA_LOTE_BYTES(TELEMETRIA_LOTE_MAX)];
+
+static bool wifi_conectado(void) {
+    return cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA) == CYW43_LINK_UP;
+}
+
+static bool conecta(void) {
+    if (!wifi_conectado() &&
+        cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, WIFI_TIMEOUT_MS)) {
+        printf("[TEL] Wi-Fi indisponivel\n");
+        return false;
+    }
+
+    NetworkInit(&rede);
+    if (NetworkConnect(&rede, MQTT_BROKER, MQTT_PORTA) != 0) {
+        printf("[TEL] broker %s:%d inacessivel\n", MQTT_BROKER, MQTT_PORTA);
+        return false;
+    }
+
+    MQTTClientInit(&cliente, &rede, MQTT_TIMEOUT_MS, buf_envio, sizeof(buf_envio),
+                   buf_leitura, sizeof(buf_leitura));
+
+    MQTTPacket_connectData dados = MQTTPacket_connectData_initializer;
+    dados.MQTTVersion = 4;
+    dados.clientID.cstring = "robo-telemetria";
+    dados.keepAliveInterval = 20;
+    dados.cleansession = 1;
+
+    if (MQTTConnect(&cliente, &dados) != SUCCESS) {
+        NetworkDisconnect(&rede);
+        printf("[TEL] CONNECT recusado\n");
+        return false;
+    }
+    printf("[TEL] conectado em %s:%d, topico %s\n", MQTT_BROKER, MQTT_PORTA, TELEMETRIA_TOPICO);
+    return true;
+}
+
+static void desconecta(void) {
+    if (MQTTIsConnected(&cliente)) MQTTDisconnect(&cliente);
+    NetworkDisconnect(&rede);
+}
+
+static void tarefa_telemetria(void *arg) {
+    uint32_t espera_ms = ESPERA_MIN_MS;
+    bool conectado = false;
+    uint32_t ultimo_envio_ms = 0;
+
+    cyw43_arch_enable_sta_mode();
+
+    for (;;) {
+        if (!conectado) {
+            conectado = conecta();
+            if (!conectado) {
+                vTaskDelay(pdMS_TO_TICKS(espera_ms));
+                espera_ms = espera_ms * 2 > ESPERA_MAX_MS ? ESPERA_MAX_MS : espera_ms * 2;
+                continue;
+            }
+            telemetria_conta_reconexao();
+            espera_ms = ESPERA_MIN_MS;
+        }
+
+        // Espera um lote cheio ou o fim do intervalo; o yield atende o keepalive
+        uint32_t agora = to_ms_since_boot(get_absolute_time());
+        if (telemetria_pendentes() < config.lote && agora - ultimo_envio_ms < config.intervalo_ms) {
+            if (MQTTYield(&cliente, YIELD_MS) != SUCCESS || !MQTTIsConnected(&cliente)) {
+                desconecta();
+                conectado = false;
+            }
+            continue;
+        }
+        ultimo_envio_ms = agora;
+
+        TelemetriaLote lote;
+        size_t bytes = telemetria_monta_lote(lote_buf, sizeof(lote_buf), config.lote, &lote);
+        if (bytes == 0) continue;
+
+        MQTTMessage msg = {
+            .qos = config.qos ? QOS1 : QOS0,
+            .retained = 0,
+            .payload = lote_buf,
+            .payloadlen = bytes,
+        };
+        if (MQTTPublish(&cliente, TELEMETRIA_TOPICO, &msg) == SUCCESS) {
+            telemetria_confirma_lote(&lote, bytes);
+        } else {
+            // O lote continua no anel e vai de novo (mesma seq) após reconectar
+            telemetria_conta_falha();
+            desconecta();
+            conectado = false;
+        }
+    }
+}
+
+bool telemetria_mqtt_inicia(const TelemetriaConfig *cfg, UBaseType_t prioridade) {
+    config = *cfg;
+    if (config.lote == 0) config.lote = 1;
+    if (config.lote > TELEMETRIA_LOTE_MAX) config.lote = TELEMETRIA_LOTE_MAX;
+
+    return xTaskCreate(tarefa_telemetria, "telemetria", 1024, NULL, prioridade, NULL) == pdPASS;
+}
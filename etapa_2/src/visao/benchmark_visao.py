@@ -0,0 +1,437 @@
+"""
+benchmark_visao.py - Benchmark e golden outputs do pipeline de visão clássica
+
+Roda todas as fotos de etapa_2/docs/fotosPiZero e fotosCelular pelas mesmas
+etapas de processaImagem() (AbordagemClassica_rev3.ipynb), sem os desenhos:
+
+  hsv        -> cv2.cvtColor BGR->HSV (uma vez por imagem)
+  segmenta   -> cv2.inRange com as faixas tomClaro_*/tomEscuro_*
+  fecha      -> MORPH_CLOSE 3x3
+  abre       -> MORPH_OPEN 3x3
+  contornos  -> findContours + maior contorno + boundingRect
+  centroide  -> moments do maior contorno
+
+Para cada imagem registra os nanossegundos de cada etapa (mediana de N
+repetições), a memória e, por cor, a caixa e o centroide detectados. Memória
+são dois números:
+  heap Python -> pico do tracemalloc: objetos Python e arrays numpy (as
+                 saídas do OpenCV), mas não os buffers internos do OpenCV
+                 (temporários da morfologia, do findContours);
+  RSS         -> pico do processo inteiro na passada (VmHWM do Linux, zerado
+                 antes dela): vê os buffers nativos, mas inclui o
+                 interpretador e as bibliotecas (~50 MB). É absoluto: o
+                 alocador reaproveita a memória das repetições, então a
+                 diferença para o RSS de antes dá ~0. Fora do Linux
+                 fica n/d.
+
+A detecção é comparada com os golden JSON em golden/<pasta>.json e o tempo,
+opcionalmente, com um resultado anterior (--base). Sai com código 1 se houver
+regressão de detecção ou de tempo.
+
+Com --rastreio cada foto vira uma sequência curta de quadros sintéticos (a
+imagem deslocada aos poucos, como a câmera andando e balançando) e uma cor
+passa pelo pipeline inteiro e pelo RastreadorFaixa (rastreador_faixa.py).
+Sai o tempo médio por quadro dos dois, quanto do quadro o rastreador
+processou e o tremor da saída: quanto o centroide anda entre quadros além do
+deslocamento que foi aplicado.
+
+Uso:
+  python3 benchmark_visao.py -o resultados.json                  # compara com golden
+  python3 benchmark_visao.py -o novo.json --base antigo.json     # + regressão de tempo
+  python3 benchmark_visao.py --atualiza-golden                   # regrava os golden
+  python3 benchmark_visao.py --rastreio azul --pastas fotosPiZero # janela prevista x quadro inteiro
+"""
+import argparse
+import glob
+import json
+import math
+import os
+import platform
+import statistics
+import subprocess
+import sys
+import time
+import tracemalloc
+
+import cv2
+import numpy as np
+
+from rastreador_faixa import RastreadorFaixa
+
+AQUI = os.path.dirname(os.path.abspath(__file__))
+DOCS = os.path.normpath(os.path.join(AQUI, "..", "..", "docs"))
+PASTAS = ["fotosPiZero", "fotosCelular"]
+PASTA_GOLDEN = os.path.join(AQUI, "golden")
+
+# Mesmas faixas do notebook (HSV do OpenCV: H 0..179)
+FAIXAS = {
+    "verde":    (np.array([40, 100, 100]),  np.array([80, 255, 255])),
+    "azul":     (np.array([100, 100, 100]), np.array([140, 255, 255])),
+    "vermelho": (np.array([160, 100, 100]), np.array([200, 255, 255])),
+}
+KERNEL = np.ones((3, 3), np.uint8)
+ETAPAS = ["hsv", "segmenta", "fecha", "abre", "contornos", "centroide"]
+
+# Tolerâncias da comparação com o golden
+TOL_CENTROIDE_PX = 2
+TOL_IOU_CAIXA = 0.9
+
+QUADROS_SEQUENCIA = 12
+RUIDO_SIGMA = 12
+
+
+def processa(img):
+    """Uma passada do pipeline. Retorna (tempos_ns por etapa, deteccoes por cor)."""
+    ns = dict.fromkeys(ETAPAS, 0)
+    deteccoes = {}
+
+    t = time.perf_counter_ns()
+    hsv = cv2.cvtColor(img, cv2.COLOR_BGR2HSV)
+    ns["hsv"] += time.perf_counter_ns() - t
+
+    for cor, (claro, escuro) in FAIXAS.items():
+        t0 = time.perf_counter_ns()
+        mascara = cv2.inRange(hsv, claro, escuro)
+        t1 = time.perf_counter_ns()
+        mascara = cv2.morphologyEx(mascara, cv2.MORPH_CLOSE, KERNEL)
+        t2 = time.perf_counter_ns()
+        mascara = cv2.morphologyEx(mascara, cv2.MORPH_OPEN, KERNEL)
+        t3 = time.perf_counter_ns()
+        contornos, _ = cv2.findContours(mascara, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
+        maior = max(contornos, key=cv2.contourArea) if contornos else None
+        caixa = cv2.boundingRect(maior) if maior is not None else None
+        t4 = time.perf_counter_ns()
+        centroide = None
+        if maior is not None:
+            m = cv2.moments(maior)
+            if m["m00"] != 0:
+                centroide = [int(m["m10"] / m["m00"]), int(m["m01"] / m["m00"])]
+        t5 = time.perf_counter_ns()
+
+        ns["segmenta"] += t1 - t0
+        ns["fecha"] += t2 - t1
+        ns["abre"] += t3 - t2
+        ns["contornos"] += t4 - t3
+        ns["centroide"] += t5 - t4
+
+        deteccoes[cor] = {
+            "caixa": list(caixa) if caixa is not None else None,
+            "centroide": centroide,
+            "area_px": int(np.count_nonzero(mascara)),
+        }
+    return ns, deteccoes
+
+
+def _status_kib(campo):
+    """Campo de /proc/self/status em KiB (VmRSS, VmHWM); None fora do Linux."""
+    try:
+        with open("/proc/self/status", encoding="ascii") as f:
+            for linha in f:
+                if linha.startswith(campo + ":"):
+                    return int(linha.split()[1])
+    except OSError:
+        pass
+    return None
+
+
+def pico_rss(funcao):
+    """Roda funcao() e devolve o pico de RSS do processo durante ela, em bytes
+    (None se o kernel não deixa zerar o VmHWM)."""
+    try:
+        with open("/proc/self/clear_refs", "w", encoding="ascii") as f:
+            f.write("5")                # zera o VmHWM (Linux >= 4.0)
+    except OSError:
+        return None
+    funcao()
+    hwm = _status_kib("VmHWM")
+    return hwm * 1024 if hwm is not None else None
+
+
+def kib(v):
+    return "n/d" if v is None else f"{v / 1024:.0f} KiB"
+
+
+def mede_imagem(caminho, repeticoes):
+    img = cv2.imread(caminho)
+    if img is None:
+        raise RuntimeError("nao foi possivel ler " + caminho)
+
+    tempos = {e: [] for e in ETAPAS}
+    for _ in range(repeticoes):
+        ns, deteccoes = processa(img)
+        for e in ETAPAS:
+            tempos[e].append(ns[e])
+
+    # Memória em passadas separadas: o tracemalloc deixa tudo mais lento e a
+    # memória dele entraria no RSS
+    rss = pico_rss(lambda: processa(img))
+    tracemalloc.start()
+    tracemalloc.reset_peak()
+    processa(img)
+    _, pico = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+
+    estagios = {e: int(statistics.median(v)) for e, v in tempos.items()}
+    return {
+        "dimensoes": [img.shape[1], img.shape[0]],
+        "estagios_ns": estagios,
+        "total_ns": sum(estagios.values()),
+        "heap_python_pico_bytes": pico,
+        "rss_pico_bytes": rss,
+        "cores": deteccoes,
+    }
+
+
+def centroide_quadro(img, faixa):
+    """Pipeline inteiro de uma cor; x do centroide do maior contorno ou None."""
+    hsv = cv2.cvtColor(img, cv2.COLOR_BGR2HSV)
+    mascara = cv2.inRange(hsv, *faixa)
+    mascara = cv2.morphologyEx(mascara, cv2.MORPH_CLOSE, KERNEL)
+    mascara = cv2.morphologyEx(mascara, cv2.MORPH_OPEN, KERNEL)
+    contornos, _ = cv2.findContours(mascara, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
+    if not contornos:
+        return None
+    m = cv2.moments(max(contornos, key=cv2.contourArea))
+    return m["m10"] / m["m00"] if m["m00"] else None
+
+
+def sequencia(img, n=QUADROS_SEQUENCIA):
+    """Quadros sintéticos: a foto deslocada aos poucos para a frente e de lado.
+    Retorna [(quadro, deslocamento x aplicado)]."""
+    h, w = img.shape[:2]
+    ruido = np.random.default_rng(0)        # o mesmo em toda execução
+    quadros = []
+    for i in range(n):
+        dx = int(round(0.04 * w * math.sin(2 * math.pi * i / n)))
+        m = np.float32([[1, 0, dx], [0, 1, 2 * i]])
+        q = cv2.warpAffine(img, m, (w, h), borderMode=cv2.BORDER_REPLICATE)
+        # Ruído do sensor: o que faz a segmentação tremer de um quadro para outro
+        q = cv2.add(q, ruido.normal(0, RUIDO_SIGMA, q.shape).astype(np.int16), dtype=cv2.CV_8U)
+        quadros.append((q, dx))
+    return quadros
+
+
+def tremor(xs, dxs):
+    """Soma de |passo do centroide - passo aplicado| entre quadros com centroide."""
+    soma, n = 0.0, 0
+    for i in range(1, len(xs)):
+        if xs[i] is not None and xs[i - 1] is not None:
+            soma += abs((xs[i] - xs[i - 1]) - (dxs[i] - dxs[i - 1]))
+            n += 1
+    return soma, n
+
+
+def mede_rastreio(arquivos, cor, repeticoes):
+    faixa = FAIXAS[cor]
+    total = {"quadros": 0, "completo_ns": 0, "rastreio_ns": 0, "janela": 0, "pixels_pct": 0,
+             "tremor_completo": [0.0, 0], "tremor_rastreio": [0.0, 0]}
+    for caminho in arquivos:
+        img = cv2.imread(caminho)
+        if img is None:
+            raise RuntimeError("nao foi possivel ler " + caminho)
+        quadros = sequencia(img)
+        dxs = [dx for _, dx in quadros]
+
+        tempos_completo, tempos_rastreio = [], []
+        for _ in range(repeticoes):
+            t = time.perf_counter_ns()
+            xs_completo = [centroide_quadro(q, faixa) for q, _ in quadros]
+            tempos_completo.append(time.perf_counter_ns() - t)
+
+            r = RastreadorFaixa(faixa)
+            t = time.perf_counter_ns()
+            estimativas = [r.processa(q) for q, _ in quadros]
+            tempos_rastreio.append(time.perf_counter_ns() - t)
+
+        xs_rastreio = [e.centroide[0] if e.centroide else None for e in estimativas]
+        for nome, xs in (("tremor_completo", xs_completo), ("tremor_rastreio", xs_rastreio)):
+            soma, n = tremor(xs, dxs)
+            total[nome][0] += soma
+            total[nome][1] += n
+        total["quadros"] += len(quadros)
+        total["completo_ns"] += int(statistics.median(tempos_completo))
+        total["rastreio_ns"] += int(statistics.median(tempos_rastreio))
+        total["janela"] += r.buscas_janela
+        total["pixels_pct"] += 100 * r.pixels_processados // r.pixels_quadro * len(quadros)
+
+    n = max(1, total["quadros"])
+    resumo = {
+        "cor": cor,
+        "quadros": total["quadros"],
+        "completo_ns_quadro": total["completo_ns"] // n,
+        "rastreio_ns_quadro": total["rastreio_ns"] // n,
+        "janela_pct": 100 * total["janela"] // n,
+        "pixels_pct": total["pixels_pct"] // n,
+        "tremor_completo_px": total["tremor_completo"][0] / max(1, total["tremor_completo"][1]),
+        "tremor_rastreio_px": total["tremor_rastreio"][0] / max(1, total["tremor_rastreio"][1]),
+    }
+    print(f"\nRastreio [{cor}] em {resumo['quadros']} quadros sinteticos:")
+    print(f"  quadro inteiro {resumo['completo_ns_quadro'] / 1e6:8.3f} ms/quadro"
+          f"  tremor {resumo['tremor_completo_px']:6.2f} px")
+    print(f"  rastreador     {resumo['rastreio_ns_quadro'] / 1e6:8.3f} ms/quadro"
+          f"  tremor {resumo['tremor_rastreio_px']:6.2f} px"
+          f"  | janela {resumo['janela_pct']}% dos quadros, {resumo['pixels_pct']}% dos pixels")
+    return resumo
+
+
+def iou(a, b):
+    ax, ay, aw, ah = a
+    bx, by, bw, bh = b
+    ix = max(0, min(ax + aw, bx + bw) - max(ax, bx))
+    iy = max(0, min(ay + ah, by + bh) - max(ay, by))
+    inter = ix * iy
+    uniao = aw * ah + bw * bh - inter
+    return inter / uniao if uniao else 1.0
+
+
+def compara_deteccao(nome, atual, golden):
+    problemas = []
+    for cor, g in golden.items():
+        a = atual.get(cor)
+        if a is None:
+            problemas.append(f"{nome} [{cor}] cor ausente no resultado")
+            continue
+        if (g["caixa"] is None) != (a["caixa"] is None):
+            problemas.append(f"{nome} [{cor}] deteccao mudou: golden={g['caixa']} atual={a['caixa']}")
+            continue
+        if g["caixa"] is not None and iou(g["caixa"], a["caixa"]) < TOL_IOU_CAIXA:
+            problemas.append(f"{nome} [{cor}] caixa {a['caixa']} != golden {g['caixa']}")
+        if (g["centroide"] is None) != (a["centroide"] is None):
+            problemas.append(f"{nome} [{cor}] centroide mudou: golden={g['centroide']} atual={a['centroide']}")
+        elif g["centroide"] is not None:
+            dx = abs(g["centroide"][0] - a["centroide"][0])
+            dy = abs(g["centroide"][1] - a["centroide"][1])
+            if max(dx, dy) > TOL_CENTROIDE_PX:
+                problemas.append(f"{nome} [{cor}] centroide {a['centroide']} != golden {g['centroide']}")
+    return problemas
+
+
+def compara_tempo(resultados, base, tolerancia):
+    """Regressão de tempo é decidida pela soma de cada etapa sobre todas as
+    imagens; uma imagem sozinha oscila demais. As piores imagens só ajudam a
+    achar a causa."""
+    problemas = []
+    for e in ETAPAS:
+        a = resultados["resumo"]["estagios_ns"][e]
+        b = base.get("resumo", {}).get("estagios_ns", {}).get(e)
+        if b and a > b * (1 + tolerancia):
+            problemas.append(f"TOTAL [{e}] {a / 1e6:.2f} ms vs {b / 1e6:.2f} ms (+{100 * (a / b - 1):.0f}%)")
+
+    if problemas:
+        piores = []
+        for nome, atual in resultados["imagens"].items():
+            anterior = base.get("imagens", {}).get(nome)
+            if anterior and anterior["total_ns"]:
+                piores.append((atual["total_ns"] / anterior["total_ns"], nome))
+        for razao, nome in sorted(piores, reverse=True)[:5]:
+            print(f"  mais lenta: {nome} x{razao:.2f}")
+    return problemas
+
+
+def commit_atual():
+    try:
+        return subprocess.run(["git", "rev-parse", "--short", "HEAD"], cwd=AQUI,
+                              capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-o", "--saida", help="JSON com os resultados desta execução")
+    ap.add_argument("--base", help="resultado anterior para detectar regressão de tempo")
+    ap.add_argument("--tolerancia", type=float, default=0.25, help="piora de tempo aceita (0.25 = 25%%)")
+    ap.add_argument("-n", "--repeticoes", type=int, default=5)
+    ap.add_argument("--pastas", nargs="+", default=PASTAS)
+    ap.add_argument("--atualiza-golden", action="store_true")
+    ap.add_argument("--rastreio", choices=sorted(FAIXAS), help="mede o RastreadorFaixa nesta cor")
+    args = ap.parse_args()
+
+    cv2.setNumThreads(1)        # tempos comparáveis entre máquinas/execuções
+
+    resultados = {
+        "commit": commit_atual(),
+        "opencv": cv2.__version__,
+        "python": platform.python_version(),
+        "maquina": platform.machine(),
+        "repeticoes": args.repeticoes,
+        "imagens": {},
+    }
+    problemas = []
+
+    for pasta in args.pastas:
+        arquivos = sorted(glob.glob(os.path.join(DOCS, pasta, "*.jpg")))
+        caminho_golden = os.path.join(PASTA_GOLDEN, pasta + ".json")
+        golden = {}
+        if not args.atualiza_golden and os.path.exists(caminho_golden):
+            with open(caminho_golden, encoding="utf-8") as f:
+                golden = json.load(f)
+
+        novo_golden = {}
+        for caminho in arquivos:
+            nome = pasta + "/" + os.path.basename(caminho)
+            r = mede_imagem(caminho, args.repeticoes)
+            resultados["imagens"][nome] = r
+            novo_golden[os.path.basename(caminho)] = r["cores"]
+
+            g = golden.get(os.path.basename(caminho))
+            if g is not None:
+                problemas += compara_deteccao(nome, r["cores"], g)
+            elif golden:
+                problemas.append(f"{nome} sem golden")
+            print(f"{nome:45s} {r['total_ns'] / 1e6:8.2f} ms  heap python {kib(r['heap_python_pico_bytes']):>10s}"
+                  f"  rss {kib(r['rss_pico_bytes']):>10s}")
+
+        if args.atualiza_golden:
+            os.makedirs(PASTA_GOLDEN, exist_ok=True)
+            # Uma imagem por linha: diffs legíveis quando a detecção muda
+            linhas = [f" {json.dumps(nome)}: {json.dumps(cores, sort_keys=True)}"
+                      for nome, cores in sorted(novo_golden.items())]
+            with open(caminho_golden, "w", encoding="utf-8", newline="\n") as f:
+                f.write("{\n" + ",\n".join(linhas) + "\n}\n")
+            print("Golden atualizado:", caminho_golden)
+        elif not golden:
+            print("AVISO: sem golden para", pasta, "(rode com --atualiza-golden)")
+
+    imagens = resultados["imagens"].values()
+    resultados["resumo"] = {
+        "imagens": len(resultados["imagens"]),
+        "estagios_ns": {e: sum(r["estagios_ns"][e] for r in imagens) for e in ETAPAS},
+        "total_ns": sum(r["total_ns"] for r in imagens),
+        "heap_python_pico_max_bytes": max((r["heap_python_pico_bytes"] for r in imagens), default=0),
+        "rss_pico_max_bytes": max((r["rss_pico_bytes"] for r in imagens if r["rss_pico_bytes"] is not None),
+                                  default=None),
+    }
+
+    if args.rastreio:
+        arquivos = [a for pasta in args.pastas for a in sorted(glob.glob(os.path.join(DOCS, pasta, "*.jpg")))]
+        resultados["rastreio"] = mede_rastreio(arquivos, args.rastreio, args.repeticoes)
+
+    if args.base:
+        with open(args.base, encoding="utf-8") as f:
+            problemas += compara_tempo(resultados, json.load(f), args.tolerancia)
+
+    resultados["regressoes"] = problemas
+    if args.saida:
+        with open(args.saida, "w", encoding="utf-8", newline="\n") as f:
+            json.dump(resultados, f, indent=1)
+            f.write("\n")
+
+    print("\nPor etapa (soma de todas as imagens):")
+    for e in ETAPAS:
+        print(f"  {e:10s} {resultados['resumo']['estagios_ns'][e] / 1e6:10.2f} ms")
+    print(f"  pico do heap python (tracemalloc, sem os buffers do OpenCV): "
+          f"{kib(resultados['resumo']['heap_python_pico_max_bytes'])}")
+    print(f"  pico de RSS do processo (com interpretador e bibliotecas): "
+          f"{kib(resultados['resumo']['rss_pico_max_bytes'])}")
+
+    if problemas:
+        print(f"\n{len(problemas)} regressao(oes):")
+        for p in problemas:
+            print("  " + p)
+        sys.exit(1)
+    print("\nSem regressoes.")
+
+
+if __name__ == "__main__":
+    main()
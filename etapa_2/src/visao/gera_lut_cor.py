@@ -0,0 +1,235 @@
+"""
+gera_lut_cor.py - Gera a tabela RGB -> cor (LUT) a partir de imagens rotuladas
+
+Substitui as faixas HSV escolhidas à mão no notebook (tomClaro_*/tomEscuro_*)
+por uma tabela aprendida das fotos de calibração. O resultado é um header C
+(inc/lut_cor.h) com um array constante (constexpr em C++) usado tanto pelo
+kernel de visão quanto pelo classificador do TCS34725 no robô: a classificação
+vira uma única consulta à tabela, sem conta de matiz por pixel.
+
+Formato do arquivo de rótulos (JSON):
+  {
+    "base": "../../docs",                       # pasta das imagens (relativa ao JSON)
+    "saturacao_min": 70,                        # filtro dos pixels das regiões coloridas
+    "imagens": [
+      {"arquivo": "fotosPiZero/x.jpg",
+       "regioes": [{"cor": "azul", "ret": [x, y, w, h]},
+                   {"cor": "nenhuma", "ret": [x, y, w, h]}]}
+    ],
+    "amostras_rgb": [{"cor": "amarela", "rgb": [r, g, b]}]   # pontos avulsos
+  }
+
+Dentro de uma região colorida só entram os pixels saturados (a fita); o
+fundo branco da região é descartado. Regiões "nenhuma" entram inteiras.
+Cada amostra é replicada em algumas escalas de brilho, inclusive com o maior
+canal normalizado para 255 (é assim que o robô normaliza as leituras RGBC).
+
+Uso:
+  python3 gera_lut_cor.py rotulos_cores.json -o ../../inc/lut_cor.h
+"""
+import argparse
+import json
+import os
+import sys
+
+import cv2
+import numpy as np
+
+# Mesma numeração do TipoCor do robô (carrinho_seguidor_cor.c); verde só na visão
+CORES = ["nenhuma", "azul", "vermelha", "amarela", "verde"]
+# Célula que nenhuma amostra alcançou: quem consulta decide (o robô cai na
+# regra de razões). Só "nenhuma" por falta de dado chamaria de fundo uma cor
+# que as fotos não cobriram.
+SEM_AMOSTRA = 0x0F
+
+BITS = 5                       # bits por canal: 32x32x32 células
+LADO = 1 << BITS
+ESCALAS_BRILHO = (0.7, 0.85, 1.0, 1.15)
+BRILHO_MIN_NORMALIZA = 96
+
+
+def indice_celula(rgb):
+    q = (rgb.astype(np.int32) >> (8 - BITS))
+    return (q[:, 0] << (2 * BITS)) | (q[:, 1] << BITS) | q[:, 2]
+
+
+def aumenta_brilho(rgb):
+    """Replica as amostras em várias escalas de brilho + versão normalizada."""
+    rgb = rgb.astype(np.float32)
+    saida = [np.clip(rgb * e, 0, 255) for e in ESCALAS_BRILHO]
+    # Pixels escuros viram ruído quando esticados: só normaliza os bem expostos
+    maximo = rgb.max(axis=1, keepdims=True)
+    expostos = maximo[:, 0] >= BRILHO_MIN_NORMALIZA
+    saida.append(rgb[expostos] * (255.0 / maximo[expostos]))
+    return np.vstack(saida).astype(np.uint8)
+
+
+def coleta_amostras(rotulos, pasta_json):
+    base = os.path.join(pasta_json, rotulos.get("base", "."))
+    sat_min = rotulos.get("saturacao_min", 70)
+    amostras = {c: [] for c in range(len(CORES))}
+
+    for item in rotulos.get("imagens", []):
+        caminho = os.path.join(base, item["arquivo"])
+        img = cv2.imread(caminho)
+        if img is None:
+            sys.exit("ERRO: nao foi possivel ler " + caminho)
+        hsv = cv2.cvtColor(img, cv2.COLOR_BGR2HSV)
+        rgb = cv2.cvtColor(img, cv2.COLOR_BGR2RGB)
+
+        for regiao in item["regioes"]:
+            cor = CORES.index(regiao["cor"])
+            x, y, w, h = regiao["ret"]
+            pix = rgb[y:y + h, x:x + w].reshape(-1, 3)
+            if cor != 0:
+                sat = hsv[y:y + h, x:x + w, 1].reshape(-1)
+                pix = pix[sat >= sat_min]
+            amostras[cor].append(pix)
+
+    # Pontos avulsos (ex.: leituras de calibração do TCS34725) valem uma célula
+    # cada, por isso entram separados e com peso mínimo para vencer a votação
+    pontos = {c: [] for c in range(len(CORES))}
+    for a in rotulos.get("amostras_rgb", []):
+        pontos[CORES.index(a["cor"])].append(a["rgb"])
+
+    return ({c: np.vstack(v) for c, v in amostras.items() if v},
+            {c: np.array(v, dtype=np.uint8) for c, v in pontos.items() if v})
+
+
+def vota(amostras, pontos, votos_min, pureza_min):
+    votos = np.zeros((len(CORES), LADO ** 3), dtype=np.int64)
+    for cor, pix in amostras.items():
+        votos[cor] += np.bincount(indice_celula(aumenta_brilho(pix)), minlength=LADO ** 3)
+    for cor, pix in pontos.items():
+        votos[cor] += votos_min * np.bincount(indice_celula(aumenta_brilho(pix)), minlength=LADO ** 3)
+
+    total = votos.sum(axis=0)
+    vencedor = votos.argmax(axis=0)
+    pureza = votos.max(axis=0) / np.maximum(total, 1)
+
+    lut = np.full(LADO ** 3, -1, dtype=np.int8)        # -1 = célula sem amostras
+    lut[total > 0] = 0                                 # ambígua ou rala: nenhuma
+    firme = (total >= votos_min) & (pureza >= pureza_min)
+    lut[firme] = vencedor[firme]
+    return lut
+
+
+def propaga(lut, raio):
+    """Preenche células vazias com o rótulo vizinho (até 'raio' células)."""
+    cubo = lut.reshape(LADO, LADO, LADO).copy()
+    for _ in range(raio):
+        vazio = cubo < 0
+        if not vazio.any():
+            break
+        alcance = np.zeros((len(CORES),) + cubo.shape, dtype=bool)
+        for cor in range(len(CORES)):
+            m = cubo == cor
+            d = m.copy()
+            for eixo in range(3):
+                # sem np.roll para não dar a volta no cubo
+                d[tuple(slice(1, None) if i == eixo else slice(None) for i in range(3))] |= \
+                    m[tuple(slice(None, -1) if i == eixo else slice(None) for i in range(3))]
+                d[tuple(slice(None, -1) if i == eixo else slice(None) for i in range(3))] |= \
+                    m[tuple(slice(1, None) if i == eixo else slice(None) for i in range(3))]
+            alcance[cor] = d & vazio
+        n_cores = alcance[1:].sum(axis=0)
+        # Conflito entre duas cores (ou só "nenhuma" alcançou): fica nenhuma
+        unica = n_cores == 1
+        for cor in range(1, len(CORES)):
+            cubo[alcance[cor] & unica] = cor
+        cubo[vazio & (n_cores != 1) & (alcance.any(axis=0))] = 0
+    cubo[cubo < 0] = SEM_AMOSTRA
+    return cubo.reshape(-1).astype(np.uint8)
+
+
+def empacota(lut):
+    # Dois rótulos de 4 bits por byte: célula par no nibble baixo
+    return (lut[0::2] | (lut[1::2] << 4)).astype(np.uint8)
+
+
+def escreve_header(caminho, dados, origem, resumo):
+    linhas = []
+    for i in range(0, len(dados), 16):
+        linhas.append("    " + ", ".join("0x%02X" % b for b in dados[i:i + 16]) + ",")
+
+    defines = "\n".join("#define LUT_COR_%-8s %d" % (c.upper(), i) for i, c in enumerate(CORES))
+    defines += "\n#define LUT_COR_SEM_AMOSTRA %d   // célula sem amostra por perto" % SEM_AMOSTRA
+    texto = f"""/**
+ * lut_cor.h - Tabela RGB -> cor gerada a partir de imagens rotuladas
+ *
+ * GERADO por etapa_2/src/visao/gera_lut_cor.py a partir de {origem}
+ * NÃO EDITAR À MÃO: ajuste os rótulos e gere de novo.
+ *
+{resumo}
+ *
+ * Cada canal é quantizado em {BITS} bits ({LADO}x{LADO}x{LADO} células) e cada célula
+ * guarda o rótulo em 4 bits (duas células por byte, {len(dados)} bytes em flash).
+ */
+#ifndef LUT_COR_H
+#define LUT_COR_H
+
+#include <stdint.h>
+
+// Mesma numeração do TipoCor do robô; verde só é usado pela visão
+{defines}
+
+#define LUT_COR_BITS {BITS}
+
+#ifdef __cplusplus
+#define LUT_COR_CONST constexpr
+#else
+#define LUT_COR_CONST static const
+#endif
+
+LUT_COR_CONST uint8_t lut_cor[{len(dados)}] = {{
+{chr(10).join(linhas)}
+}};
+
+// Uma consulta por pixel/amostra: sem ramos e sem conta de matiz
+static inline uint8_t lut_cor_classifica(uint8_t r, uint8_t g, uint8_t b) {{
+    uint32_t i = ((uint32_t) (r >> (8 - LUT_COR_BITS)) << (2 * LUT_COR_BITS))
+               | ((uint32_t) (g >> (8 - LUT_COR_BITS)) << LUT_COR_BITS)
+               | (uint32_t) (b >> (8 - LUT_COR_BITS));
+    return (uint8_t) ((lut_cor[i >> 1] >> ((i & 1u) << 2)) & 0x0Fu);
+}}
+
+#endif
+"""
+    with open(caminho, "w", encoding="utf-8", newline="\n") as f:
+        f.write(texto)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("rotulos", help="arquivo JSON com as regiões rotuladas")
+    ap.add_argument("-o", "--saida", required=True, help="header C gerado")
+    ap.add_argument("--votos-min", type=int, default=3, help="amostras mínimas por célula")
+    ap.add_argument("--pureza-min", type=float, default=0.8, help="fração mínima da cor vencedora")
+    ap.add_argument("--raio", type=int, default=2, help="células de preenchimento em volta das amostras")
+    args = ap.parse_args()
+
+    with open(args.rotulos, encoding="utf-8") as f:
+        rotulos = json.load(f)
+
+    amostras, pontos = coleta_amostras(rotulos, os.path.dirname(os.path.abspath(args.rotulos)))
+    lut = propaga(vota(amostras, pontos, args.votos_min, args.pureza_min), args.raio)
+
+    # Acerto sobre as próprias amostras (sem aumento de brilho)
+    for cor, pix in pontos.items():
+        amostras[cor] = np.vstack([amostras[cor], pix]) if cor in amostras else pix
+    resumo = []
+    for cor, pix in sorted(amostras.items()):
+        acerto = float(np.mean(lut[indice_celula(pix)] == cor)) if len(pix) else 0.0
+        celulas = int(np.count_nonzero(lut == cor))
+        resumo.append(" *   %-8s %7d amostras, %5d celulas, acerto %5.1f%%" %
+                      (CORES[cor], len(pix), celulas, 100 * acerto))
+        print(resumo[-1][4:])
+
+    resumo.append(" *   sem amostra       %5d celulas" % int(np.count_nonzero(lut == SEM_AMOSTRA)))
+    print(resumo[-1][4:])
+    escreve_header(args.saida, empacota(lut), os.path.basename(args.rotulos), "\n".join(resumo))
+    print("Gerado:", args.saida)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,180 @@
+"""
+rastreador_faixa.py - Rastreamento da faixa entre quadros (janela prevista + alfa-beta)
+
+processaImagem() (AbordagemClassica_rev3.ipynb) trata cada imagem sozinha:
+HSV, inRange, fechamento, abertura e contornos no quadro inteiro, e sem
+faixa só imprime "Nenhuma faixa foi identificada". Entre dois quadros da
+câmera a faixa anda poucos pixels, então o rastreador:
+
+  - guarda o estado em ponto fixo (inteiros Q8, como seria em C):
+    centroide x (px) e velocidade x (px/quadro), inclinação da faixa
+    (dx/dy, dos momentos centrais mu11/mu02) e quanto ela muda por quadro.
+    Dois filtros alfa-beta, um para x e um para a inclinação: previsão
+    valor + taxa, correção com ALFA/BETA em Q8 e shift. A inclinação tem
+    ganhos menores (mu11/mu02 de um recorte é mais ruidoso que o
+    centroide); numa curva ela muda todo quadro, e sem a taxa ficaria
+    atrasada;
+  - procura só numa janela: a caixa do último contorno deslocada pela
+    velocidade prevista e alargada por MARGEM_PX + |v|. As mesmas etapas
+    do pipeline rodam só no recorte (o HSV também);
+  - sem faixa na janela, segue pela previsão (modo "previsto") com a
+    confiança caindo pela metade; depois de FALHAS_MAX falhas seguidas
+    volta a procurar no quadro inteiro. Sem nada no quadro inteiro a saída
+    é "perdido": cor nenhuma e confiança 0, como o quadro 0xFF13 espera;
+  - a saída é o deslocamento suavizado em Q15 (mesma escala do
+    quadroDirecao() e de quadro_direcao.h) e a confiança 0..255, que sobe
+    a cada acerto e cai a cada falha ou salto grande entre medida e previsão.
+
+Uso (ver a célula de rastreamento do notebook e benchmark_visao.py --rastreio):
+  r = RastreadorFaixa((tomClaro_B, tomEscuro_B))
+  for img in quadros:
+      e = r.processa(img)   # e.deslocamento_q15, e.confianca, e.modo
+"""
+from collections import namedtuple
+
+import cv2
+import numpy as np
+
+KERNEL = np.ones((3, 3), np.uint8)
+
+Q8 = 256
+ALFA_Q8 = 128          # correção da posição (0.5)
+BETA_Q8 = 32           # correção da velocidade (0.125)
+ALFA_INCLINACAO_Q8 = 64   # correção da inclinação (0.25)
+BETA_INCLINACAO_Q8 = 16   # correção da taxa da inclinação (0.0625)
+MARGEM_PX = 16         # folga da janela além da caixa prevista
+FALHAS_MAX = 3         # falhas seguidas na janela: volta ao quadro inteiro
+AREA_MIN_PX = 40       # contorno menor que isso é ruído
+JANELA_MAX_PCT = 70    # janela maior que isso do quadro: procura no quadro todo
+
+Estimativa = namedtuple("Estimativa", "deslocamento_q15 inclinacao_q8 confianca modo caixa centroide")
+
+
+class RastreadorFaixa:
+    def __init__(self, faixa, alfa_q8=ALFA_Q8, beta_q8=BETA_Q8, margem_px=MARGEM_PX, falhas_max=FALHAS_MAX):
+        self.claro, self.escuro = faixa
+        self.alfa_q8 = alfa_q8
+        self.beta_q8 = beta_q8
+        self.margem_px = margem_px
+        self.falhas_max = falhas_max
+        self.reinicia()
+
+    def reinicia(self):
+        self.rastreando = False
+        self.x_q8 = 0
+        self.v_q8 = 0
+        self.inclinacao_q8 = 0
+        self.taxa_inclinacao_q8 = 0  # dx/dy em Q8 por quadro
+        self.caixa = None            # (x, y, w, h) do último contorno aceito
+        self.y = 0
+        self.falhas = 0
+        self.confianca = 0
+        # Contadores: quanto trabalho foi feito e como
+        self.quadros = 0
+        self.buscas_janela = 0
+        self.buscas_quadro = 0
+        self.pixels_processados = 0
+        self.pixels_quadro = 0
+
+    def _mede(self, img, x0, y0, x1, y1):
+        """Pipeline do notebook só no recorte. Retorna (cx_q8, cy, inclinacao_q8,
+        caixa no quadro) do maior contorno, ou None."""
+        hsv = cv2.cvtColor(img[y0:y1, x0:x1], cv2.COLOR_BGR2HSV)
+        mascara = cv2.inRange(hsv, self.claro, self.escuro)
+        mascara = cv2.morphologyEx(mascara, cv2.MORPH_CLOSE, KERNEL)
+        mascara = cv2.morphologyEx(mascara, cv2.MORPH_OPEN, KERNEL)
+        self.pixels_processados += (x1 - x0) * (y1 - y0)
+
+        contornos, _ = cv2.findContours(mascara, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
+        if not contornos:
+            return None
+        maior = max(contornos, key=cv2.contourArea)
+        m = cv2.moments(maior)
+        if m["m00"] < AREA_MIN_PX:
+            return None
+        cx_q8 = int(m["m10"] * Q8 / m["m00"]) + x0 * Q8
+        cy = int(m["m01"] / m["m00"]) + y0
+        # dx/dy da faixa: ~0 com a faixa em pé na imagem
+        inclinacao_q8 = int(m["mu11"] * Q8 / m["mu02"]) if m["mu02"] else 0
+        x, y, w, h = cv2.boundingRect(maior)
+        return cx_q8, cy, inclinacao_q8, (x + x0, y + y0, w, h)
+
+    def _janela(self, largura, altura):
+        """Caixa anterior deslocada pela velocidade e alargada; None se quase o quadro todo."""
+        x, y, w, h = self.caixa
+        dx = self.v_q8 >> 8
+        folga = self.margem_px + abs(dx)
+        x0 = max(0, x + dx - folga)
+        x1 = min(largura, x + w + dx + folga)
+        y0 = max(0, y - self.margem_px)
+        y1 = min(altura, y + h + self.margem_px)
+        if x1 <= x0 or y1 <= y0:
+            return None
+        if (x1 - x0) * (y1 - y0) * 100 > largura * altura * JANELA_MAX_PCT:
+            return None
+        return x0, y0, x1, y1
+
+    def processa(self, img):
+        altura, largura = img.shape[:2]
+        meia_q8 = largura * Q8 // 2
+        self.quadros += 1
+        self.pixels_quadro += largura * altura
+
+        previsto_q8 = self.x_q8 + self.v_q8
+        inclinacao_prevista_q8 = self.inclinacao_q8 + self.taxa_inclinacao_q8
+        janela = self._janela(largura, altura) if self.rastreando and self.falhas < self.falhas_max else None
+        if janela is not None:
+            self.buscas_janela += 1
+            medida = self._mede(img, *janela)
+            modo = "janela"
+        else:
+            self.buscas_quadro += 1
+            medida = self._mede(img, 0, 0, largura, altura)
+            modo = "quadro"
+
+        if medida is None:
+            self.falhas += 1
+            self.confianca >>= 1
+            if not self.rastreando or (janela is None and self.falhas > self.falhas_max):
+                self.rastreando = False
+                self.confianca = 0
+                return Estimativa(0, 0, 0, "perdido", None, None)
+            # Segue pela previsão, sem corrigir as taxas
+            self.x_q8 = min(max(previsto_q8, 0), largura * Q8)
+            self.inclinacao_q8 = inclinacao_prevista_q8
+            modo = "previsto"
+        elif not self.rastreando or self.falhas >= self.falhas_max:
+            # Achada de novo no quadro inteiro: a previsão antiga não vale mais
+            cx_q8, self.y, self.inclinacao_q8, self.caixa = medida
+            self.x_q8, self.v_q8 = cx_q8, 0
+            self.taxa_inclinacao_q8 = 0
+            self.rastreando = True
+            self.falhas = 0
+            self.confianca = 128
+        else:
+            cx_q8, self.y, inclinacao_q8, self.caixa = medida
+            r = cx_q8 - previsto_q8
+            self.x_q8 = previsto_q8 + (self.alfa_q8 * r >> 8)
+            self.v_q8 += self.beta_q8 * r >> 8
+            ri = inclinacao_q8 - inclinacao_prevista_q8
+            self.inclinacao_q8 = inclinacao_prevista_q8 + (ALFA_INCLINACAO_Q8 * ri >> 8)
+            self.taxa_inclinacao_q8 += BETA_INCLINACAO_Q8 * ri >> 8
+            self.falhas = 0
+            # Salto maior que a margem: acerto, mas de pouca confiança
+            if abs(r) > self.margem_px * Q8:
+                self.confianca -= self.confianca >> 2
+            else:
+                self.confianca += (255 - self.confianca) >> 2
+
+        deslocamento = (self.x_q8 - meia_q8) * 32767 // meia_q8
+        deslocamento = max(-32768, min(32767, deslocamento))
+        return Estimativa(deslocamento, self.inclinacao_q8, self.confianca, modo,
+                          self.caixa, (self.x_q8 >> 8, self.y))
+
+    def relatorio(self):
+        """Fração de quadros na janela e de pixels processados contra o quadro inteiro."""
+        if not self.quadros:
+            return "rastreio: nenhum quadro"
+        return (f"rastreio: {self.quadros} quadros | janela {100 * self.buscas_janela // self.quadros}% "
+                f"quadro inteiro {100 * self.buscas_quadro // self.quadros}% | "
+                f"pixels {100 * self.pixels_processados // max(1, self.pixels_quadro)}% do quadro")
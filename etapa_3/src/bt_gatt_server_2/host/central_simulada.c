@@ -0,0 +1,194 @@
+/**
+ * central_simulada.c - Central BLE simulada no host (sem rádio)
+ *
+ * Faz o papel do módulo de visão: gera quadros de direção numa taxa fixa,
+ * codifica, aplica atraso/jitter de rádio, duplica e inverte a ordem de
+ * alguns quadros, e entrega os bytes ao mesmo codec/limitador usado em
+ * server.c. Serve para validar o layout do quadro e o limitador de taxa.
+ *
+ * Compilação (a partir desta pasta):
+ *   gcc -std=c11 -O2 -I.. -o central_simulada central_simulada.c ../quadro_direcao.c
+ *
+ * Uso:
+ *   ./central_simulada [taxa_hz] [quadros] [jitter_max_us] [intervalo_min_us]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "quadro_direcao.h"
+
+#define ATRASO_RADIO_BASE_US 7500    // ~1 intervalo de conexão BLE
+
+typedef struct {
+    uint32_t entrega_us;             // instante de chegada no relógio do robô
+    uint8_t  bytes[QUADRO_DIRECAO_TAMANHO];
+} PacoteRadio;
+
+static int falhas = 0;
+
+static void confere(int condicao, const char *descricao) {
+    if (!condicao) {
+        printf("[FALHA] %s\n", descricao);
+        falhas++;
+    }
+}
+
+// Ida e volta pelo codec com valores de borda
+static void testa_codec(void) {
+    const QuadroDirecao casos[] = {
+        { 0,      QUADRO_COR_NENHUMA, 0,   0,      0          },
+        { 32767,  0x01,               255, 65535,  0xFFFFFFFFu },
+        { -32768, 0x03,               128, 1,      0x80000001u },
+        { -1,     0x02,               1,   0x1234, 0x00ABCDEFu },
+    };
+    uint8_t buf[QUADRO_DIRECAO_TAMANHO];
+    QuadroDirecao q;
+
+    for (size_t i = 0; i < sizeof(casos) / sizeof(casos[0]); i++) {
+        quadro_direcao_codifica(&casos[i], buf);
+        confere(quadro_direcao_decodifica(buf, sizeof(buf), &q), "decodifica quadro valido");
+        confere(q.deslocamento_q15 == casos[i].deslocamento_q15 && q.cor == casos[i].cor &&
+                q.confianca == casos[i].confianca && q.id_quadro == casos[i].id_quadro &&
+                q.captura_us == casos[i].captura_us,
+                "ida e volta preserva os campos");
+    }
+
+    // Layout little-endian fixo (o mesmo que struct.pack('<hBBHI') no Python)
+    const QuadroDirecao ref = { -2, 0x03, 0xC8, 0x0102, 0x03040506u };
+    const uint8_t esperado[QUADRO_DIRECAO_TAMANHO] = { 0xFE, 0xFF, 0x03, 0xC8, 0x02, 0x01, 0x06, 0x05, 0x04, 0x03 };
+    quadro_direcao_codifica(&ref, buf);
+    confere(memcmp(buf, esperado, sizeof(buf)) == 0, "layout de bytes do quadro");
+
+    confere(!quadro_direcao_decodifica(buf, QUADRO_DIRECAO_TAMANHO - 1, &q), "rejeita quadro curto");
+    confere(!quadro_direcao_decodifica(buf, 1, &q), "rejeita comando de 1 byte");
+    buf[2] = QUADRO_COR_MAXIMA + 1;
+    confere(!quadro_direcao_decodifica(buf, sizeof(buf), &q), "rejeita cor desconhecida");
+}
+
+// Visão reiniciada: ids voltam a 0 (salto grande para trás) ou retomam
+// perto do último depois de um silêncio; reordenação curta continua descartada
+static void testa_ressincronia(void) {
+    LimitadorQuadros l;
+    QuadroDirecao q = { 0, 0x01, 200, 0, 0 };
+    uint32_t t = 1000000u;
+
+    limitador_quadros_init(&l, 10000);
+    for (uint16_t id = 500; id <= 510; id++, t += 20000) {
+        q.id_quadro = id;
+        confere(limitador_quadros_aceita(&l, &q, t), "sequencia normal aceita");
+    }
+    q.id_quadro = 508;
+    confere(!limitador_quadros_aceita(&l, &q, t), "reordenacao curta descartada");
+    t += 20000;
+
+    q.id_quadro = 0;
+    confere(limitador_quadros_aceita(&l, &q, t), "reinicio (id 0) ressincroniza");
+    q.id_quadro = 1;
+    t += 20000;
+    confere(limitador_quadros_aceita(&l, &q, t), "segue depois do reinicio");
+
+    q.id_quadro = 1;
+    t += QUADRO_SILENCIO_MAX_US;
+    confere(limitador_quadros_aceita(&l, &q, t), "silencio longo ressincroniza");
+    confere(l.ressincronias == 2 && l.descartados_ordem == 1, "contadores de ressincronia e ordem");
+}
+
+static int compara_entrega(const void *a, const void *b) {
+    const PacoteRadio *pa = a, *pb = b;
+    if (pa->entrega_us < pb->entrega_us) return -1;
+    if (pa->entrega_us > pb->entrega_us) return 1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t taxa_hz       = argc > 1 ? (uint32_t) atoi(argv[1]) : 60;
+    uint32_t quadros       = argc > 2 ? (uint32_t) atoi(argv[2]) : 600;
+    uint32_t jitter_max_us = argc > 3 ? (uint32_t) atoi(argv[3]) : 8000;
+    uint32_t intervalo_us  = argc > 4 ? (uint32_t) atoi(argv[4]) : 10000;
+
+    if (taxa_hz == 0 || quadros == 0) {
+        fprintf(stderr, "uso: %s [taxa_hz] [quadros] [jitter_max_us] [intervalo_min_us]\n", argv[0]);
+        return 2;
+    }
+
+    testa_codec();
+    testa_ressincronia();
+
+    // Cada quadro pode gerar uma cópia duplicada: até 2 pacotes por quadro
+    PacoteRadio *ar = calloc(2 * (size_t) quadros, sizeof(PacoteRadio));
+    if (!ar) return 1;
+
+    srand(1234);
+    uint32_t periodo_us = 1000000 / taxa_hz;
+    uint32_t relogio_visao = 0xFFFF0000u;   // relógios diferentes, com volta
+    uint32_t relogio_robo  = 5000000u;
+    size_t n = 0;
+
+    for (uint32_t i = 0; i < quadros; i++) {
+        // Faixa oscilando de um lado para o outro, perdida de vez em quando
+        QuadroDirecao q;
+        q.deslocamento_q15 = (int16_t) ((int32_t) ((i * 997u) % 65536u) - 32768);
+        q.cor       = (i % 50 < 3) ? QUADRO_COR_NENHUMA : (uint8_t) (1 + (i / 200) % 3);
+        q.confianca = (uint8_t) (q.cor == QUADRO_COR_NENHUMA ? 0 : 100 + (i % 156));
+        q.id_quadro = (uint16_t) (0xFF00u + i);                 // testa a volta do id
+        q.captura_us = relogio_visao + i * periodo_us;
+
+        uint32_t atraso = ATRASO_RADIO_BASE_US + (jitter_max_us ? (uint32_t) rand() % jitter_max_us : 0);
+        ar[n].entrega_us = relogio_robo + i * periodo_us + atraso;
+        quadro_direcao_codifica(&q, ar[n].bytes);
+        n++;
+
+        if (rand() % 40 == 0) {             // retransmissão duplicada
+            ar[n] = ar[n - 1];
+            ar[n].entrega_us += 1500;
+            n++;
+        }
+    }
+    // O jitter já embaralha parte da ordem de chegada
+    qsort(ar, n, sizeof(PacoteRadio), compara_entrega);
+
+    LimitadorQuadros limitador;
+    LatenciaQuadros latencia;
+    limitador_quadros_init(&limitador, intervalo_us);
+    latencia_quadros_init(&latencia);
+
+    uint32_t comandos[4] = {0};           // P, R, E, D
+    for (size_t i = 0; i < n; i++) {
+        QuadroDirecao q;
+        if (!quadro_direcao_decodifica(ar[i].bytes, QUADRO_DIRECAO_TAMANHO, &q)) {
+            limitador.invalidos++;
+            continue;
+        }
+        if (!limitador_quadros_aceita(&limitador, &q, ar[i].entrega_us)) continue;
+
+        comandos[quadro_direcao_comando(&q)]++;      // a regra de server.c e do robô
+        latencia_quadros_registra(&latencia, &q, ar[i].entrega_us, ar[i].entrega_us + 40);
+    }
+    free(ar);
+
+    uint32_t recebidos = limitador.aceitos + limitador.descartados_taxa +
+                         limitador.descartados_ordem + limitador.invalidos;
+    confere(recebidos == n, "todo pacote e contabilizado");
+    confere(limitador.invalidos == 0, "nenhum quadro valido rejeitado pelo codec");
+    confere(limitador.aceitos <= 1 + (uint32_t) ((quadros * (uint64_t) periodo_us + jitter_max_us) / intervalo_us),
+            "limitador respeita o intervalo minimo");
+
+    printf("Quadros: %u gerados, %zu pacotes (%u Hz, jitter %u us, intervalo min %u us)\n",
+           quadros, n, taxa_hz, jitter_max_us, intervalo_us);
+    printf("Limitador: aceitos=%u taxa=%u ordem=%u invalidos=%u ressincronias=%u\n",
+           limitador.aceitos, limitador.descartados_taxa, limitador.descartados_ordem, limitador.invalidos,
+           limitador.ressincronias);
+    printf("Comandos: PARE=%u RETO=%u ESQUERDA=%u DIREITA=%u\n",
+           comandos[0], comandos[1], comandos[2], comandos[3]);
+    printf("Atraso acima do minimo (us): min=%u med=%u max=%u | aplicacao max=%u us\n",
+           latencia.atraso_min_us, latencia_quadros_media_us(&latencia),
+           latencia.atraso_max_us, latencia.aplicacao_max_us);
+
+    if (falhas) {
+        printf("%d verificacao(oes) falharam\n", falhas);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * quadro_direcao.c - Codec, limitador de taxa e latência dos quadros de direção
+ */
+#include "quadro_direcao.h"
+
+// --- CODEC ---
+
+void quadro_direcao_codifica(const QuadroDirecao *q, uint8_t buf[QUADRO_DIRECAO_TAMANHO]) {
+    uint16_t desl = (uint16_t) q->deslocamento_q15;
+
+    buf[0] = desl & 0xFF;
+    buf[1] = desl >> 8;
+    buf[2] = q->cor;
+    buf[3] = q->confianca;
+    buf[4] = q->id_quadro & 0xFF;
+    buf[5] = q->id_quadro >> 8;
+    buf[6] = q->captura_us & 0xFF;
+    buf[7] = (q->captura_us >> 8) & 0xFF;
+    buf[8] = (q->captura_us >> 16) & 0xFF;
+    buf[9] = q->captura_us >> 24;
+}
+
+bool quadro_direcao_decodifica(const uint8_t *buf, uint16_t tamanho, QuadroDirecao *q) {
+    // Layout fixo: qualquer outro tamanho é de outra versão do protocolo
+    if (tamanho != QUADRO_DIRECAO_TAMANHO) return false;
+    if (buf[2] > QUADRO_COR_MAXIMA) return false;
+
+    q->deslocamento_q15 = (int16_t) (buf[0] | (buf[1] << 8));
+    q->cor        = buf[2];
+    q->confianca  = buf[3];
+    q->id_quadro  = (uint16_t) (buf[4] | (buf[5] << 8));
+    q->captura_us = (uint32_t) buf[6]
+                  | ((uint32_t) buf[7] << 8)
+                  | ((uint32_t) buf[8] << 16)
+                  | ((uint32_t) buf[9] << 24);
+    return true;
+}
+
+// --- LIMITADOR DE TAXA ---
+
+void limitador_quadros_init(LimitadorQuadros *l, uint32_t intervalo_min_us) {
+    l->intervalo_min_us = intervalo_min_us;
+    l->ultimo_aceito_us = 0;
+    l->ultimo_id = 0;
+    l->tem_ultimo = false;
+    l->aceitos = 0;
+    l->descartados_taxa = 0;
+    l->descartados_ordem = 0;
+    l->invalidos = 0;
+    l->ressincronias = 0;
+}
+
+bool limitador_quadros_aceita(LimitadorQuadros *l, const QuadroDirecao *q, uint32_t agora_us) {
+    if (l->tem_ultimo) {
+        // Diferença com sinal: ids "atrás" do último (ou iguais) são antigos,
+        // a não ser que o salto ou o silêncio mostrem que a visão reiniciou
+        int16_t avanco = (int16_t) (q->id_quadro - l->ultimo_id);
+        uint32_t silencio = agora_us - l->ultimo_aceito_us;
+        if (avanco <= 0) {
+            if (avanco >= -QUADRO_SALTO_ATRAS_MAX && silencio < QUADRO_SILENCIO_MAX_US) {
+                l->descartados_ordem++;
+                return false;
+            }
+            l->ressincronias++;
+        } else if (silencio < l->intervalo_min_us) {
+            l->descartados_taxa++;
+            return false;
+        }
+    }
+
+    l->ultimo_id = q->id_quadro;
+    l->ultimo_aceito_us = agora_us;
+    l->tem_ultimo = true;
+    l->aceitos++;
+    return true;
+}
+
+// --- DECISÃO ---
+
+QuadroComando quadro_direcao_comando(const QuadroDirecao *q) {
+    if (q->cor == QUADRO_COR_NENHUMA || q->confianca < QUADRO_CONFIANCA_MIN) return QUADRO_CMD_PARE;
+    if (q->deslocamento_q15 > QUADRO_BANDA_MORTA_Q15)  return QUADRO_CMD_DIREITA;
+    if (q->deslocamento_q15 < -QUADRO_BANDA_MORTA_Q15) return QUADRO_CMD_ESQUERDA;
+    return QUADRO_CMD_RETO;
+}
+
+// --- LATÊNCIA CÂMERA -> MOTOR ---
+
+void latencia_quadros_init(LatenciaQuadros *lat) {
+    lat->diferenca_min_us = 0;
+    lat->tem_referencia = false;
+    lat->amostras = 0;
+    lat->atraso_min_us = UINT32_MAX;
+    lat->atraso_max_us = 0;
+    lat->atraso_soma_us = 0;
+    lat->aplicacao_max_us = 0;
+}
+
+void latencia_quadros_registra(LatenciaQuadros *lat, const QuadroDirecao *q,
+                               uint32_t recebido_us, uint32_t aplicado_us) {
+    uint32_t diferenca = aplicado_us - q->captura_us;
+
+    // Nova referência de atraso mínimo: os quadros anteriores passam a ser
+    // medidos contra ela só a partir daqui (o histórico não é recalculado)
+    if (!lat->tem_referencia || (int32_t) (diferenca - lat->diferenca_min_us) < 0) {
+        lat->diferenca_min_us = diferenca;
+        lat->tem_referencia = true;
+    }
+
+    uint32_t atraso = diferenca - lat->diferenca_min_us;
+    if (atraso < lat->atraso_min_us) lat->atraso_min_us = atraso;
+    if (atraso > lat->atraso_max_us) lat->atraso_max_us = atraso;
+    lat->atraso_soma_us += atraso;
+    lat->amostras++;
+
+    uint32_t aplicacao = aplicado_us - recebido_us;
+    if (aplicacao > lat->aplicacao_max_us) lat->aplicacao_max_us = aplicacao;
+}
+
+uint32_t latencia_quadros_media_us(const LatenciaQuadros *lat) {
+    if (lat->amostras == 0) return 0;
+    return (uint32_t) (lat->atraso_soma_us / lat->amostras);
+}
@@ -0,0 +1,108 @@
+/**
+ * quadro_direcao.h - Quadro compacto de direção enviado pelo módulo de visão
+ *
+ * Layout fixo (little-endian, 10 bytes) escrito na característica 0xFF13:
+ *
+ *   byte 0..1 : deslocamento (int16, Q15) - centroide da faixa em relação ao
+ *               centro da imagem, normalizado pela meia largura (-1.0 .. +1.0).
+ *               Negativo = faixa à esquerda, positivo = faixa à direita.
+ *   byte 2    : cor detectada (mesmos códigos da característica 0xFF11)
+ *   byte 3    : confiança (0 = nenhuma, 255 = máxima)
+ *   byte 4..5 : id do quadro (uint16, incrementa a cada imagem, dá a volta)
+ *   byte 6..9 : instante de captura (uint32, us no relógio do módulo de visão)
+ *
+ * O código é C puro (sem dependências do SDK) para ser usado também na
+ * central simulada do host (host/central_simulada.c).
+ */
+#ifndef QUADRO_DIRECAO_H
+#define QUADRO_DIRECAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QUADRO_DIRECAO_TAMANHO 10
+
+// Cor "nenhuma": faixa não encontrada na imagem
+#define QUADRO_COR_NENHUMA 0x00
+#define QUADRO_COR_MAXIMA  0x03
+
+typedef struct {
+    int16_t  deslocamento_q15;
+    uint8_t  cor;
+    uint8_t  confianca;
+    uint16_t id_quadro;
+    uint32_t captura_us;
+} QuadroDirecao;
+
+// --- CODEC ---
+void quadro_direcao_codifica(const QuadroDirecao *q, uint8_t buf[QUADRO_DIRECAO_TAMANHO]);
+bool quadro_direcao_decodifica(const uint8_t *buf, uint16_t tamanho, QuadroDirecao *q);
+
+// --- LIMITADOR DE TAXA ---
+// Aceita no máximo um quadro a cada 'intervalo_min_us' e descarta quadros
+// repetidos ou fora de ordem (comparação de id com aritmética de 16 bits).
+// Se o módulo de visão reinicia, os ids voltam a 0 e ficariam "atrás" do
+// último para sempre; o limitador se ressincroniza no id que chegou quando
+// ele está mais de QUADRO_SALTO_ATRAS_MAX atrás (reordenação do rádio é de
+// poucos quadros) ou quando nada foi aceito por QUADRO_SILENCIO_MAX_US.
+#define QUADRO_SALTO_ATRAS_MAX 64
+#define QUADRO_SILENCIO_MAX_US 500000
+
+typedef struct {
+    uint32_t intervalo_min_us;
+    uint32_t ultimo_aceito_us;
+    uint16_t ultimo_id;
+    bool     tem_ultimo;
+
+    uint32_t aceitos;
+    uint32_t descartados_taxa;
+    uint32_t descartados_ordem;
+    uint32_t invalidos;
+    uint32_t ressincronias;
+} LimitadorQuadros;
+
+void limitador_quadros_init(LimitadorQuadros *l, uint32_t intervalo_min_us);
+bool limitador_quadros_aceita(LimitadorQuadros *l, const QuadroDirecao *q, uint32_t agora_us);
+
+// --- DECISÃO ---
+// Regra única do quadro para o comando: o servidor do etapa_3, o robô do
+// etapa_2 (faixa perdida pelos sensores de chão) e a central simulada
+// chamam quadro_direcao_comando(), para não divergirem.
+#define QUADRO_CONFIANCA_MIN   64              // abaixo disso: faixa perdida
+#define QUADRO_BANDA_MORTA_Q15 (32768 / 10)    // |desvio| < 10% da meia largura: reto
+
+typedef enum {
+    QUADRO_CMD_PARE = 0,          // faixa perdida ou confiança baixa
+    QUADRO_CMD_RETO,
+    QUADRO_CMD_ESQUERDA,
+    QUADRO_CMD_DIREITA
+} QuadroComando;
+
+QuadroComando quadro_direcao_comando(const QuadroDirecao *q);
+
+// --- LATÊNCIA CÂMERA -> MOTOR ---
+// Os relógios da câmera e do robô não são sincronizados. A menor diferença
+// (aplicacao - captura) observada é usada como referência de atraso mínimo;
+// as estatísticas medem o atraso acima desse mínimo (fila, rádio, jitter).
+// O trecho recepção -> motor é medido localmente e reportado à parte.
+// 'aplicado' no robô (etapa_2) é o primeiro tique da rampa com as rodas no
+// sentido do comando (motor_no_sentido); no servidor do etapa_3, que não tem
+// motores, é só o comando nas variáveis de estado.
+typedef struct {
+    uint32_t diferenca_min_us;   // (aplicacao - captura) mínima, módulo 2^32
+    bool     tem_referencia;
+
+    uint32_t amostras;
+    uint32_t atraso_min_us;
+    uint32_t atraso_max_us;
+    uint64_t atraso_soma_us;
+
+    uint32_t aplicacao_max_us;   // recepção -> motor, medido no robô
+} LatenciaQuadros;
+
+void latencia_quadros_init(LatenciaQuadros *lat);
+void latencia_quadros_registra(LatenciaQuadros *lat, const QuadroDirecao *q,
+                               uint32_t recebido_us, uint32_t aplicado_us);
+uint32_t latencia_quadros_media_us(const LatenciaQuadros *lat);
+
+#endif
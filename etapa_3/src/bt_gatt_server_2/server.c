@@ -6,9 +6,12 @@
 #include "btstack.h"
 #include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "pico/rand.h"
 
 // Header gerado pelo CMake
 #include "temp_sensor.h"
+#include "quadro_direcao.h"
 
 // --- DADOS DO ANÚNCIO ---
 static uint8_t adv_data[] = {
@@ -31,6 +34,10 @@ volatile int ESQUERDA = 0;
 volatile int RETO     = 0;
 volatile int PARE     = 1;
 
+// Marcas da partida (us desde o reset); saem quando o terminal abre
+static uint32_t boot_cyw43_us = 0;
+static uint32_t boot_anuncio_us = 0;
+
 // Códigos do Protocolo
 #define COR_VERMELHO 0x01
 #define COR_VERDE    0x02
@@ -41,30 +48,43 @@ volatile int PARE     = 1;
 #define CMD_ESQUERDA 0x02
 #define CMD_DIREITA  0x03
 
+// Quadros de direção do módulo de visão (característica 0xFF13)
+#define QUADRO_INTERVALO_MIN_US 10000              // no máximo 100 quadros/s
+
+// Direção contínua para o controlador dos motores (Q15, negativo = esquerda)
+volatile int16_t DIRECAO_Q15 = 0;
+
 static hci_con_handle_t con_handle = HCI_CON_HANDLE_INVALID;
 
-// --- LÓGICA DE CONTROLE ---
+static LimitadorQuadros limitador;
+static LatenciaQuadros latencia;
 
-void processar_comando(uint8_t comando) {
-    printf("\n=== [CLIENTE -> SERVIDOR] DADO RECEBIDO ===\n");
-    printf("Valor Hex: 0x%02X\n", comando);
+// --- LÓGICA DE CONTROLE ---
 
+// Atualiza as variáveis de estado sem log (usado também pelos quadros de visão)
+static const char* aplicar_comando(uint8_t comando) {
     // Reset das variáveis
     DIREITA = 0; ESQUERDA = 0; RETO = 0; PARE = 0;
 
-    const char* status_str = "DESCONHECIDO";
-
     switch (comando) {
         case CMD_RETO:
-            RETO = 1; status_str = "SEGUIR RETO"; break;
+            RETO = 1; return "SEGUIR RETO";
         case CMD_ESQUERDA:
-            ESQUERDA = 1; status_str = "VIRAR ESQUERDA"; break;
+            ESQUERDA = 1; return "VIRAR ESQUERDA";
         case CMD_DIREITA:
-            DIREITA = 1; status_str = "VIRAR DIREITA"; break;
+            DIREITA = 1; return "VIRAR DIREITA";
         case CMD_PARE:
         default:
-            PARE = 1; status_str = "PARAR"; break;
+            PARE = 1; return "PARAR";
     }
+}
+
+void processar_comando(uint8_t comando) {
+    printf("\n=== [CLIENTE -> SERVIDOR] DADO RECEBIDO ===\n");
+    printf("Valor Hex: 0x%02X\n", comando);
+
+    DIRECAO_Q15 = 0;
+    const char* status_str = aplicar_comando(comando);
 
     printf("Acao Interpretada: %s\n", status_str);
     printf("--- ESTADO DAS VARIAVEIS ---\n");
@@ -74,6 +94,32 @@ void processar_comando(uint8_t comando) {
     printf("  [PARE]:     %d\n", PARE);
     printf("==========================================\n");
 }
+
+// Controlador de direção: converte o desvio da faixa em comando de motor.
+// Chamado a cada quadro aceito; não imprime nada para não atrasar o rádio.
+void controlador_direcao(const QuadroDirecao *q) {
+    static const uint8_t comandos[] = {
+        [QUADRO_CMD_PARE] = CMD_PARE, [QUADRO_CMD_RETO] = CMD_RETO,
+        [QUADRO_CMD_ESQUERDA] = CMD_ESQUERDA, [QUADRO_CMD_DIREITA] = CMD_DIREITA,
+    };
+    QuadroComando c = quadro_direcao_comando(q);
+    DIRECAO_Q15 = c == QUADRO_CMD_PARE ? 0 : q->deslocamento_q15;
+    aplicar_comando(comandos[c]);
+}
+
+void processar_quadro_direcao(const uint8_t *buffer, uint16_t buffer_size) {
+    uint32_t recebido_us = time_us_32();
+    QuadroDirecao q;
+
+    if (!quadro_direcao_decodifica(buffer, buffer_size, &q)) {
+        limitador.invalidos++;
+        return;
+    }
+    if (!limitador_quadros_aceita(&limitador, &q, recebido_us)) return;
+
+    controlador_direcao(&q);
+    latencia_quadros_registra(&latencia, &q, recebido_us, time_us_32());
+}
 /*
 void atualizar_cor_alvo(int codigo) {
     VERMELHO = 0; VERDE = 0; AZUL = 0;
@@ -132,6 +178,11 @@ int att_write_callback(hci_con_handle_t connection_handle, uint16_t att_handle,
             processar_comando(buffer[0]);
         }
     }
+    else if (att_handle == ATT_CHARACTERISTIC_0000FF13_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        processar_quadro_direcao(buffer, buffer_size);
+    }
+    // 0xFF14 (zerar o perfil do etapa_2): este servidor não tem perfil, a
+    // escrita é aceita e ignorada
     return 0;
 }
 
@@ -145,6 +196,12 @@ uint16_t att_read_callback(hci_con_handle_t connection_handle, uint16_t att_hand
         }
         return 1;
     }
+    if (att_handle == ATT_CHARACTERISTIC_0000FF14_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE) {
+        // Perfil do etapa_2 (perfil.h): só o cabeçalho, versão 2 e nenhuma
+        // zona, para o cliente ver uma tabela vazia em vez de um valor inválido
+        static const uint8_t perfil_vazio[4] = { 2, 0, 0, 0 };
+        return att_read_callback_handle_blob(perfil_vazio, sizeof(perfil_vazio), offset, buffer, buffer_size);
+    }
     return 0;
 }
 
@@ -218,6 +275,7 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
             gap_advertisements_set_params(adv_int_min, adv_int_max, adv_type, 0, null_addr, 0x07, 0x00);
             gap_advertisements_set_data(adv_data_len, (uint8_t*) adv_data);
             gap_advertisements_enable(1);
+            if (!boot_anuncio_us) boot_anuncio_us = time_us_32();
             printf("--> Anuncio ATIVADO. Aguardando conexao...\n");
             break;
 
@@ -235,7 +293,9 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
             break;
 
         case HCI_EVENT_DISCONNECTION_COMPLETE:
-            PARE = 1;
+            aplicar_comando(CMD_PARE);
+            DIRECAO_Q15 = 0;
+            limitador.tem_ultimo = false;        // Nova conexão pode reiniciar os ids
             con_handle = HCI_CON_HANDLE_INVALID; // Marca como inválido para parar de enviar
             printf("!!! DISPOSITIVO DESCONECTADO !!! Reiniciando anuncio...\n");
             gap_advertisements_enable(1);
@@ -265,6 +325,18 @@ static void heartbeat_handler(struct btstack_timer_source *ts) {
     // Envia a notificação real para o App
     atualizar_cor_alvo(cor_aleatoria);
 
+    // Estatísticas dos quadros de direção recebidos da visão. Sem motores
+    // nesta placa: o atraso vai até o comando nas variáveis (o do motor é
+    // medido no robô, etapa_2)
+    if (latencia.amostras > 0) {
+        printf("[VISAO] aceitos=%lu taxa=%lu ordem=%lu invalidos=%lu ressinc=%lu | atraso ate o comando us: min=%lu med=%lu max=%lu | aplicacao max=%lu us\n",
+               (unsigned long) limitador.aceitos, (unsigned long) limitador.descartados_taxa,
+               (unsigned long) limitador.descartados_ordem, (unsigned long) limitador.invalidos,
+               (unsigned long) limitador.ressincronias,
+               (unsigned long) latencia.atraso_min_us, (unsigned long) latencia_quadros_media_us(&latencia),
+               (unsigned long) latencia.atraso_max_us, (unsigned long) latencia.aplicacao_max_us);
+    }
+
     // Pisca o LED apenas para indicar atividade
     static int led = 0;
     cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, led);
@@ -275,14 +347,34 @@ static void heartbeat_handler(struct btstack_timer_source *ts) {
     btstack_run_loop_add_timer(ts);
 }
 
+// --- TERMINAL ---
+// A partida não espera pelo monitor serial: enquanto o USB não está aberto o
+// printf se perde, então quando o host abre a porta o cabeçalho e as marcas
+// da partida são repetidos
+static btstack_timer_source_t terminal;
+static void terminal_handler(struct btstack_timer_source *ts) {
+    static bool aberto = false;
+    bool conectado = stdio_usb_connected();
+
+    if (conectado && !aberto) {
+        printf("\n\n--- MONITOR DO BITDOGLAB ---\n");
+        printf("[BOOT] cyw43 em %lu ms, anuncio em %lu ms, terminal em %lu ms\n",
+               (unsigned long) (boot_cyw43_us / 1000u), (unsigned long) (boot_anuncio_us / 1000u),
+               (unsigned long) (time_us_32() / 1000u));
+    }
+    aberto = conectado;
+
+    btstack_run_loop_set_timer(ts, 100);
+    btstack_run_loop_add_timer(ts);
+}
+
 // --- MAIN ---
 int main() {
     stdio_init_all();
-    sleep_ms(5000); // Tempo para abrir o monitor serial
 
-    // Inicializa a semente de números aleatórios com o tempo atual do processador
-    // Isso garante que a sequência mude a cada reinicialização
-    srand(time_us_32());
+    // Semente do pico_rand (ROSC, id da placa, contadores): sem a espera pelo
+    // terminal, time_us_32() aqui é quase o mesmo a cada reinicialização
+    srand(get_rand_32());
 
     printf("\n\n--- INICIANDO MONITOR DO BITDOGLAB ---\n");
 
@@ -290,12 +382,16 @@ int main() {
         printf("ERRO: Falha ao iniciar CYW43\n");
         return -1;
     }
+    boot_cyw43_us = time_us_32();
 
     l2cap_init();
     sm_init();
 
     att_server_init(profile_data, att_read_callback, att_write_callback);
 
+    limitador_quadros_init(&limitador, QUADRO_INTERVALO_MIN_US);
+    latencia_quadros_init(&latencia);
+
     static btstack_packet_callback_registration_t hci_callback_registration;
     hci_callback_registration.callback = &packet_handler;
     hci_add_event_handler(&hci_callback_registration);
@@ -307,6 +403,10 @@ int main() {
     btstack_run_loop_set_timer(&heartbeat, 2000);
     btstack_run_loop_add_timer(&heartbeat);
 
+    terminal.process = &terminal_handler;
+    btstack_run_loop_set_timer(&terminal, 100);
+    btstack_run_loop_add_timer(&terminal);
+
     hci_power_control(HCI_POWER_ON);
 
     printf("Aguardando conexao Bluetooth...\n");